@@ -0,0 +1,9 @@
+package com.inflearn.practicevulkan
+
+import androidx.test.ext.junitgtest.GtestRunner
+import androidx.test.ext.junitgtest.TargetLibrary
+import org.junit.runner.RunWith
+
+@RunWith(GtestRunner::class)
+@TargetLibrary(libraryName = "rendererbenchmark")
+class RendererBenchmark
@@ -1,8 +1,12 @@
 #ifndef ANDROIDGLINVESTIGATIONS_ANDROIDOUT_H
 #define ANDROIDGLINVESTIGATIONS_ANDROIDOUT_H
 
-#include <android/log.h>
 #include <sstream>
+#ifdef __ANDROID__
+#include <android/log.h>
+#else
+#include <cstdio>
+#endif
 
 /*!
  * Use this to log strings out to logcat. Note that you should use std::endl to commit the line
@@ -26,7 +30,12 @@ public:
 
 protected:
     virtual int sync() override {
+#ifdef __ANDROID__
         __android_log_print(ANDROID_LOG_DEBUG, logTag_, "%s", str().c_str());
+#else
+        // logcat이 없는 호스트(Linux CI 등)에서는 표준 에러로 출력한다.
+        std::fprintf(stderr, "%s: %s", logTag_, str().c_str());
+#endif
         str("");
         return 0;
     }
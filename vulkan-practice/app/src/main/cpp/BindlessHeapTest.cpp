@@ -0,0 +1,48 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include "VkBindlessHeap.h"
+
+using namespace std;
+
+TEST(BindlessHeap, indexAllocator) {
+    VkIndexAllocator indexAllocator{3};
+
+    EXPECT_EQ(indexAllocator.allocate(), 0);
+    EXPECT_EQ(indexAllocator.allocate(), 1);
+    EXPECT_EQ(indexAllocator.allocate(), 2);
+    EXPECT_EQ(indexAllocator.size(), 3);
+
+    // 가득 차면 유효하지 않은 인덱스를 반환한다.
+    EXPECT_EQ(indexAllocator.allocate(), kInvalidBindlessIndex);
+
+    // 해제된 인덱스는 마지막에 해제된 것부터 다시 사용한다.
+    indexAllocator.free(0);
+    indexAllocator.free(2);
+    EXPECT_EQ(indexAllocator.size(), 1);
+    EXPECT_EQ(indexAllocator.allocate(), 2);
+    EXPECT_EQ(indexAllocator.allocate(), 0);
+    EXPECT_EQ(indexAllocator.allocate(), kInvalidBindlessIndex);
+    EXPECT_EQ(indexAllocator.capacity(), 3);
+}
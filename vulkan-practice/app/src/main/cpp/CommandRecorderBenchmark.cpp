@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "VkRenderer.h"
+#include "AndroidOut.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+// GPU보다 CPU의 기록 시간이 프레임 시간을 결정하도록 작은 이미지에 작은 인스턴스를 그린다.
+constexpr VkExtent2D kImageExtent{256, 256};
+constexpr uint32_t kDrawCount = 20000;   // 인스턴스마다 그리기를 하나씩 기록한다.
+constexpr uint32_t kWarmUpFrameCount = 10;
+constexpr uint32_t kFrameCount = 100;
+
+double measure(uint32_t threadCount) {
+    VkRenderer renderer(kImageExtent, {
+            .maxFramesInFlight = 3,
+            .jobThreadCount = threadCount,
+            .maxInstancesPerDraw = 1
+    });
+
+    vector<MeshInstance> instances;
+    for (uint32_t i = 0; i != kDrawCount; ++i) {
+        instances.push_back({
+                .offset{(i % 100) * 0.02f - 0.99f, (i / 100 % 100) * 0.02f - 0.99f, 0.0f},
+                .scale = 0.01f
+        });
+    }
+    renderer.setInstances(instances);
+
+    for (auto i = 0; i != kWarmUpFrameCount; ++i) {
+        renderer.render();
+    }
+
+    auto begin = steady_clock::now();
+    for (auto i = 0; i != kFrameCount; ++i) {
+        renderer.render();
+    }
+    renderer.waitIdle();
+
+    duration<double, milli> elapsed = steady_clock::now() - begin;
+    return elapsed.count() / kFrameCount;
+}
+
+} // namespace
+
+TEST(CommandRecorderBenchmark, threadScaling) {
+    aout << "Command Recorder Benchmark (" << kDrawCount << " draws) ↓" << endl;
+    aout << fixed << setprecision(3);
+
+    auto hardwareThreadCount = max(thread::hardware_concurrency(), 1u);
+    for (auto threadCount : array<uint32_t, 4>{1, 2, 4, 8}) {
+        if (threadCount > hardwareThreadCount) {
+            break;
+        }
+
+        auto frameTime = measure(threadCount);
+        aout << " - Record Threads " << threadCount << ": " << frameTime << " ms/frame" << endl;
+        EXPECT_GT(frameTime, 0.0);
+    }
+}
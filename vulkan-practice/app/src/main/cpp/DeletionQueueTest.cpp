@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "VkDeletionQueue.h"
+
+using namespace std;
+
+TEST(DeletionQueue, collect) {
+    VkDeletionQueue deletionQueue{VK_NULL_HANDLE, nullptr, nullptr};
+    vector<int> deleted;
+
+    // graphics 큐의 값 2, transfer 큐의 값 1까지 사용한 리소스.
+    deletionQueue.push({2, 0, 1}, [&deleted] { deleted.push_back(0); });
+    deletionQueue.push({1, 0, 0}, [&deleted] { deleted.push_back(1); });
+    deletionQueue.push({3, 0, 0}, [&deleted] { deleted.push_back(2); });
+    EXPECT_EQ(deletionQueue.size(), 3);
+
+    // transfer 큐가 아직 끝나지 않았으면 graphics 큐가 끝났어도 파괴하지 않는다.
+    EXPECT_EQ(deletionQueue.collect({2, 0, 0}), 1);
+    EXPECT_EQ(deleted, vector<int>({1}));
+
+    // 모든 큐가 값을 지나면 놓은 순서대로 파괴한다.
+    EXPECT_EQ(deletionQueue.collect({3, 0, 1}), 2);
+    EXPECT_EQ(deleted, vector<int>({1, 0, 2}));
+    EXPECT_EQ(deletionQueue.size(), 0);
+}
+
+TEST(DeletionQueue, deleterCanPush) {
+    VkDeletionQueue deletionQueue{VK_NULL_HANDLE, nullptr, nullptr};
+    int count{0};
+
+    // deleter가 호출될 때 다른 항목을 놓을 수 있다. flush는 남은 항목이 없을 때까지 반복한다.
+    deletionQueue.push({1, 0, 0}, [&] {
+        ++count;
+        deletionQueue.push({2, 0, 0}, [&count] { ++count; });
+    });
+
+    EXPECT_EQ(deletionQueue.collect({1, 0, 0}), 1);
+    EXPECT_EQ(deletionQueue.size(), 1);
+
+    deletionQueue.flush();
+    EXPECT_EQ(count, 2);
+    EXPECT_EQ(deletionQueue.size(), 0);
+}
@@ -0,0 +1,54 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "VkDeviceQueues.h"
+
+using namespace std;
+
+TEST(DeviceQueues, chooseQueueFamilies) {
+    // 데스크톱 GPU에서 흔한 구성. graphics, compute 전용, transfer 전용 queueFamily가 있다.
+    const vector<VkQueueFamilyProperties> desktop{
+            {.queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT},
+            {.queueFlags = VK_QUEUE_TRANSFER_BIT},
+            {.queueFlags = VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT}
+    };
+
+    auto indices = vkChooseQueueFamilies(desktop);
+    EXPECT_EQ(indices.graphics, 0);
+    EXPECT_EQ(indices.compute, 2);
+    EXPECT_EQ(indices.transfer, 1);
+    EXPECT_EQ(vkQueueCreateInfos(indices).size(), 3);
+
+    // 전용 queueFamily가 없으면 graphics 큐를 함께 사용하고 큐는 하나만 만든다.
+    const vector<VkQueueFamilyProperties> mobile{
+            {.queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT}
+    };
+
+    indices = vkChooseQueueFamilies(mobile);
+    EXPECT_EQ(indices.graphics, 0);
+    EXPECT_EQ(indices.compute, 0);
+    EXPECT_EQ(indices.transfer, 0);
+    EXPECT_EQ(vkQueueCreateInfos(indices).size(), 1);
+}
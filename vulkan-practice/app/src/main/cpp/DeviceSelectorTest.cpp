@@ -0,0 +1,102 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "VkDeviceSelector.h"
+
+using namespace std;
+
+namespace {
+VkDeviceCandidate makeCandidate(const char *name, VkPhysicalDeviceType deviceType, VkDeviceSize memorySize) {
+    return {
+            .name = name,
+            .deviceType = deviceType,
+            .apiVersion = VK_MAKE_API_VERSION(0, 1, 3, 0),
+            .deviceLocalMemorySize = memorySize,
+            .graphicsQueue = true,
+            .asyncComputeQueue = false,
+            .dedicatedTransferQueue = false,
+            .timestampQueries = true,
+            .swapchain = true,
+            .bindless = true
+    };
+}
+}
+
+TEST(DeviceSelector, score) {
+    auto discrete = makeCandidate("Discrete", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 8ull << 30);
+    auto integrated = makeCandidate("Integrated", VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU, 32ull << 30);
+    auto cpu = makeCandidate("llvmpipe", VK_PHYSICAL_DEVICE_TYPE_CPU, 64ull << 30);
+
+    // 메모리가 많아도 장치의 종류가 우선한다.
+    EXPECT_GT(vkScoreDevice(discrete, true).score, vkScoreDevice(integrated, true).score);
+    EXPECT_GT(vkScoreDevice(integrated, true).score, vkScoreDevice(cpu, true).score);
+
+    // 같은 종류에서는 기능이 많은 장치가 우선한다.
+    auto withTransferQueue = discrete;
+    withTransferQueue.dedicatedTransferQueue = true;
+    EXPECT_GT(vkScoreDevice(withTransferQueue, true).score, vkScoreDevice(discrete, true).score);
+
+    auto noGraphics = discrete;
+    noGraphics.graphicsQueue = false;
+    EXPECT_FALSE(vkScoreDevice(noGraphics, true).suitable);
+
+    auto vulkan11 = discrete;
+    vulkan11.apiVersion = VK_MAKE_API_VERSION(0, 1, 1, 0);
+    EXPECT_FALSE(vkScoreDevice(vulkan11, true).suitable);
+
+    auto noBindless = discrete;
+    noBindless.bindless = false;
+    EXPECT_FALSE(vkScoreDevice(noBindless, false).suitable);
+
+    // 스왑체인은 화면에 출력할 때만 필요하다.
+    auto noSwapchain = discrete;
+    noSwapchain.swapchain = false;
+    EXPECT_FALSE(vkScoreDevice(noSwapchain, true).suitable);
+    EXPECT_TRUE(vkScoreDevice(noSwapchain, false).suitable);
+}
+
+TEST(DeviceSelector, select) {
+    const vector<VkDeviceCandidate> candidates{
+            makeCandidate("llvmpipe (LLVM 15.0.7, 256 bits)", VK_PHYSICAL_DEVICE_TYPE_CPU, 16ull << 30),
+            makeCandidate("Intel(R) UHD Graphics 630", VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU, 16ull << 30),
+            makeCandidate("NVIDIA GeForce RTX 3080", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 10ull << 30)
+    };
+
+    EXPECT_EQ(vkSelectDevice(candidates, false, ""), 2);
+    EXPECT_EQ(vkSelectDevice(candidates, false, "0"), 0);
+    EXPECT_EQ(vkSelectDevice(candidates, false, "intel"), 1);
+    EXPECT_EQ(vkSelectDevice(candidates, false, "CPU"), 0);
+
+    // 맞는 장치가 없으면 점수로 선택한다.
+    EXPECT_EQ(vkSelectDevice(candidates, false, "radeon"), 2);
+    EXPECT_EQ(vkSelectDevice(candidates, false, "7"), 2);
+
+    // 사용할 수 없는 장치는 지정해도 선택하지 않는다.
+    auto unsuitable = candidates;
+    unsuitable[0].graphicsQueue = false;
+    EXPECT_EQ(vkSelectDevice(unsuitable, false, "0"), 2);
+
+    EXPECT_EQ(vkSelectDevice({}, false, ""), nullopt);
+}
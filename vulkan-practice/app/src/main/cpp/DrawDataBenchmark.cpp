@@ -0,0 +1,98 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <iomanip>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "VkRenderer.h"
+#include "AndroidOut.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+// GPU보다 CPU의 기록 시간이 프레임 시간을 결정하도록 작은 이미지에 작은 인스턴스를 그린다.
+constexpr VkExtent2D kImageExtent{256, 256};
+constexpr uint32_t kDrawCount = 20000;   // 인스턴스마다 그리기를 하나씩 기록한다.
+constexpr uint32_t kWarmUpFrameCount = 10;
+constexpr uint32_t kFrameCount = 100;
+
+struct Result {
+    double frameTime;       // ms/frame
+    VkFrameAllocatorStats frameAllocatorStats;
+};
+
+Result measure(VkDrawDataPath drawDataPath) {
+    // 한 스레드에서 기록해서 그리기마다의 비용만 비교한다.
+    // dynamic uniform buffer는 그리기마다 최소 정렬(보통 64~256 바이트)을 사용하므로 넉넉하게 잡는다.
+    VkRenderer renderer(kImageExtent, {
+            .maxFramesInFlight = 3,
+            .jobThreadCount = 1,
+            .maxInstancesPerDraw = 1,
+            .frameAllocatorSize = 16 * 1024 * 1024,
+            .drawDataPath = drawDataPath
+    });
+
+    vector<MeshInstance> instances;
+    for (uint32_t i = 0; i != kDrawCount; ++i) {
+        instances.push_back({
+                .offset{(i % 100) * 0.02f - 0.99f, (i / 100 % 100) * 0.02f - 0.99f, 0.0f},
+                .scale = 0.01f
+        });
+    }
+    renderer.setInstances(instances);
+
+    for (auto i = 0; i != kWarmUpFrameCount; ++i) {
+        renderer.render();
+    }
+
+    auto begin = steady_clock::now();
+    for (auto i = 0; i != kFrameCount; ++i) {
+        renderer.render();
+    }
+    renderer.waitIdle();
+
+    duration<double, milli> elapsed = steady_clock::now() - begin;
+    return {elapsed.count() / kFrameCount, renderer.frameAllocatorStats()};
+}
+
+} // namespace
+
+TEST(DrawDataBenchmark, pushConstantsVsUniformBuffer) {
+    aout << "Draw Data Benchmark (" << kDrawCount << " draws) ↓" << endl;
+    aout << fixed << setprecision(3);
+
+    auto pushConstants = measure(VK_DRAW_DATA_PATH_PUSH_CONSTANTS);
+    aout << " - Push Constants: " << pushConstants.frameTime << " ms/frame" << endl;
+
+    auto uniformBuffer = measure(VK_DRAW_DATA_PATH_UNIFORM_BUFFER);
+    aout << " - Dynamic Uniform Buffer: " << uniformBuffer.frameTime << " ms/frame, "
+         << (uniformBuffer.frameAllocatorStats.highWaterMark >> 10) << " KiB/frame" << endl;
+
+    EXPECT_GT(pushConstants.frameTime, 0.0);
+    EXPECT_GT(uniformBuffer.frameTime, 0.0);
+    // 모든 그리기의 데이터가 프레임 할당기에 들어가야 같은 일을 비교한 것이다.
+    EXPECT_EQ(uniformBuffer.frameAllocatorStats.overflowCount, 0);
+}
@@ -0,0 +1,186 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "VkFramePacer.h"
+
+using namespace std;
+
+namespace {
+// 잠들면 바로 그 시간으로 넘어가는 시계.
+class FakeFrameClock : public VkFrameClock {
+public:
+    uint64_t now() override { return time; }
+
+    void sleepUntil(uint64_t wakeTime) override {
+        time = max(time, wakeTime);
+        ++sleepCount;
+    }
+
+    uint64_t time{1'000'000'000};
+    uint32_t sleepCount{0};
+};
+
+// FIFO처럼 present가 다음 수직 동기화까지 기다리는 디스플레이.
+struct FakeDisplay {
+    void present(FakeFrameClock *clock) const {
+        clock->time = (clock->time / refreshInterval + 1) * refreshInterval;
+    }
+
+    uint64_t refreshInterval;
+};
+
+// 한 프레임을 진행하고 present가 끝난 시간을 반환한다.
+uint64_t runFrame(VkFramePacer *pacer, FakeFrameClock *clock, const FakeDisplay &display, uint64_t workTime) {
+    pacer->beginFrame();
+    clock->time += workTime;
+    display.present(clock);
+    pacer->endFrame();
+    return clock->time;
+}
+}
+
+TEST(FramePacer, measuresDisplayRefresh) {
+    FakeFrameClock clock;
+    FakeDisplay display{.refreshInterval = 11'111'111}; // 90Hz
+    VkFramePacer pacer(&clock);
+
+    EXPECT_EQ(pacer.refreshInterval(), VkFramePacer::kDefaultRefreshInterval);
+    for (auto i = 0; i != VkFramePacer::kCalibrationFrameCount + 1; ++i) {
+        runFrame(&pacer, &clock, display, 3'000'000);
+    }
+
+    // 측정하는 동안에는 재우지 않는다.
+    EXPECT_TRUE(pacer.calibrated());
+    EXPECT_EQ(pacer.refreshInterval(), display.refreshInterval);
+    EXPECT_EQ(pacer.frameInterval(), display.refreshInterval);
+    EXPECT_EQ(clock.sleepCount, 0);
+}
+
+TEST(FramePacer, halfRateTarget) {
+    FakeFrameClock clock;
+    FakeDisplay display{.refreshInterval = 16'666'667};
+    VkFramePacer pacer(&clock, 33'333'333); // 30fps
+
+    for (auto i = 0; i != VkFramePacer::kCalibrationFrameCount + 1; ++i) {
+        runFrame(&pacer, &clock, display, 3'000'000);
+    }
+    ASSERT_EQ(pacer.frameInterval(), 2 * display.refreshInterval);
+
+    // 디스플레이 주기 두 번에 한 프레임씩 출력되고 그 사이에는 CPU가 잠든다.
+    vector<uint64_t> presentTimes;
+    for (auto i = 0; i != 10; ++i) {
+        presentTimes.push_back(runFrame(&pacer, &clock, display, 3'000'000));
+    }
+    for (size_t i = 2; i != presentTimes.size(); ++i) {
+        EXPECT_EQ(presentTimes[i] - presentTimes[i - 1], 2 * display.refreshInterval);
+    }
+    EXPECT_GE(clock.sleepCount, 9);
+
+    // 잠든 프레임의 간격은 디스플레이 주기로 측정하지 않는다.
+    EXPECT_EQ(pacer.refreshInterval(), display.refreshInterval);
+}
+
+TEST(FramePacer, noCatchUpAfterStall) {
+    FakeFrameClock clock;
+    FakeDisplay display{.refreshInterval = 16'666'667};
+    VkFramePacer pacer(&clock, 33'333'333);
+
+    for (auto i = 0; i != VkFramePacer::kCalibrationFrameCount + 5; ++i) {
+        runFrame(&pacer, &clock, display, 3'000'000);
+    }
+
+    // 한 프레임이 오래 걸린 뒤에도 밀린 프레임을 몰아서 그리지 않는다.
+    runFrame(&pacer, &clock, display, 200'000'000);
+    auto previous = runFrame(&pacer, &clock, display, 3'000'000);
+    for (auto i = 0; i != 5; ++i) {
+        auto current = runFrame(&pacer, &clock, display, 3'000'000);
+        EXPECT_EQ(current - previous, pacer.frameInterval());
+        previous = current;
+    }
+}
+
+TEST(FramePacer, resetRecalibrates) {
+    FakeFrameClock clock;
+    VkFramePacer pacer(&clock);
+
+    for (auto i = 0; i != VkFramePacer::kCalibrationFrameCount + 1; ++i) {
+        runFrame(&pacer, &clock, {.refreshInterval = 16'666'667}, 3'000'000);
+    }
+    ASSERT_EQ(pacer.refreshInterval(), 16'666'667);
+
+    // 다시 시작하면서 디스플레이 주사율이 바뀌어도 새로 측정한다.
+    pacer.reset();
+    clock.time += 5'000'000'000;
+    EXPECT_FALSE(pacer.calibrated());
+    for (auto i = 0; i != VkFramePacer::kCalibrationFrameCount + 1; ++i) {
+        runFrame(&pacer, &clock, {.refreshInterval = 8'333'333}, 3'000'000);
+    }
+    EXPECT_EQ(pacer.refreshInterval(), 8'333'333);
+}
+
+TEST(FramePacer, followsRefreshRateChange) {
+    FakeFrameClock clock;
+    VkFramePacer pacer(&clock);
+
+    for (auto i = 0; i != VkFramePacer::kCalibrationFrameCount + 1; ++i) {
+        runFrame(&pacer, &clock, {.refreshInterval = 11'111'111}, 3'000'000);
+    }
+    ASSERT_EQ(pacer.refreshInterval(), 11'111'111);
+
+    // 잠드는 프레임에서도 측정하므로 디스플레이가 90Hz에서 60Hz로 바뀌면 따라간다.
+    for (auto i = 0; i != 2 * VkFramePacer::kCalibrationFrameCount; ++i) {
+        runFrame(&pacer, &clock, {.refreshInterval = 16'666'667}, 3'000'000);
+    }
+    EXPECT_GT(clock.sleepCount, 0);
+    EXPECT_EQ(pacer.refreshInterval(), 16'666'667);
+}
+
+TEST(FramePacer, usesDisplayRefreshDuration) {
+    FakeFrameClock clock;
+    VkFramePacer pacer(&clock);
+
+    // 디스플레이가 주기를 알려주면 측정하지 않고 바로 사용한다.
+    pacer.setRefreshDuration(8'333'333);
+    EXPECT_TRUE(pacer.calibrated());
+    EXPECT_EQ(pacer.refreshInterval(), 8'333'333);
+
+    // MAILBOX처럼 present가 기다리지 않아도 CPU 루프 시간이 아니라 디스플레이 주기에 맞춰 시작한다.
+    vector<uint64_t> frameStartTimes;
+    for (auto i = 0; i != 10; ++i) {
+        pacer.beginFrame();
+        frameStartTimes.push_back(clock.time);
+        clock.time += 1'000'000;
+        pacer.endFrame();
+    }
+    for (size_t i = 1; i != frameStartTimes.size(); ++i) {
+        EXPECT_EQ(frameStartTimes[i] - frameStartTimes[i - 1], 8'333'333);
+    }
+
+    // 알려주지 않게 되면 present 간격으로 추정한 값으로 돌아간다. 아직 충분히 측정하지 않았으면 기본값이다.
+    pacer.setRefreshDuration(0);
+    EXPECT_FALSE(pacer.calibrated());
+    EXPECT_EQ(pacer.refreshInterval(), VkFramePacer::kDefaultRefreshInterval);
+}
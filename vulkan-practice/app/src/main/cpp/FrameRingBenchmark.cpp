@@ -0,0 +1,277 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <array>
+#include <iomanip>
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "VkDeviceQueues.h"
+#include "VkFrameRing.h"
+#include "VkRenderer.h"
+#include "VkUtil.h"
+#include "AndroidOut.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+constexpr VkExtent2D kImageExtent{1920, 1080};
+constexpr uint32_t kWarmUpFrameCount = 30;
+constexpr uint32_t kFrameCount = 300;
+constexpr uint32_t kClearCount = 8;              // 프레임마다 GPU가 처리할 작업량
+constexpr microseconds kCpuWorkDuration{2000};   // 프레임마다 CPU가 기록에 사용하는 시간
+
+class FrameRingBenchmark : public testing::Test {
+protected:
+    void SetUp() override {
+        // 화면 출력 없이 측정하기 위해 surface 관련 extension 없이 VkInstance를 생성한다.
+        VkApplicationInfo applicationInfo{
+                .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+                .pApplicationName = "Frame Ring Benchmark",
+                .apiVersion = VK_MAKE_API_VERSION(0, 1, 2, 0)
+        };
+
+        VkInstanceCreateInfo instanceCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+                .pApplicationInfo = &applicationInfo
+        };
+        VK_CHECK_ERROR(vkCreateInstance(&instanceCreateInfo, nullptr, &mInstance));
+
+        uint32_t physicalDeviceCount = 1;
+        auto result = vkEnumeratePhysicalDevices(mInstance, &physicalDeviceCount, &mPhysicalDevice);
+        ASSERT_TRUE(result == VK_SUCCESS || result == VK_INCOMPLETE);
+        ASSERT_EQ(physicalDeviceCount, 1);
+
+        uint32_t queueFamilyPropertiesCount;
+        vkGetPhysicalDeviceQueueFamilyProperties(mPhysicalDevice, &queueFamilyPropertiesCount, nullptr);
+
+        vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyPropertiesCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(mPhysicalDevice,
+                                                 &queueFamilyPropertiesCount,
+                                                 queueFamilyProperties.data());
+
+        for (mQueueFamilyIndex = 0;
+             mQueueFamilyIndex != queueFamilyPropertiesCount; ++mQueueFamilyIndex) {
+            if (queueFamilyProperties[mQueueFamilyIndex].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+                break;
+            }
+        }
+        ASSERT_NE(mQueueFamilyIndex, queueFamilyPropertiesCount);
+
+        const float queuePriority{1.0};
+        VkDeviceQueueCreateInfo deviceQueueCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                .queueFamilyIndex = mQueueFamilyIndex,
+                .queueCount = 1,
+                .pQueuePriorities = &queuePriority
+        };
+
+        // VkFrameRing은 timeline semaphore로 프레임 슬롯의 제출을 기다린다.
+        VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+                .timelineSemaphore = VK_TRUE
+        };
+
+        VkDeviceCreateInfo deviceCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+                .pNext = &timelineSemaphoreFeatures,
+                .queueCreateInfoCount = 1,
+                .pQueueCreateInfos = &deviceQueueCreateInfo
+        };
+        VK_CHECK_ERROR(vkCreateDevice(mPhysicalDevice, &deviceCreateInfo, nullptr, &mDevice));
+        // 모든 작업을 graphics 큐 하나에 제출한다.
+        mDeviceQueues = make_unique<VkDeviceQueues>(mDevice, VkQueueFamilyIndices{
+                mQueueFamilyIndex,
+                mQueueFamilyIndex,
+                mQueueFamilyIndex
+        });
+
+        // 스왑체인 이미지 대신 GPU 작업의 대상이 되는 이미지.
+        VkImageCreateInfo imageCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                .imageType = VK_IMAGE_TYPE_2D,
+                .format = VK_FORMAT_R8G8B8A8_UNORM,
+                .extent = {kImageExtent.width, kImageExtent.height, 1},
+                .mipLevels = 1,
+                .arrayLayers = 1,
+                .samples = VK_SAMPLE_COUNT_1_BIT,
+                .tiling = VK_IMAGE_TILING_OPTIMAL,
+                .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+        };
+        VK_CHECK_ERROR(vkCreateImage(mDevice, &imageCreateInfo, nullptr, &mImage));
+
+        VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties;
+        vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice, &physicalDeviceMemoryProperties);
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetImageMemoryRequirements(mDevice, mImage, &memoryRequirements);
+
+        uint32_t memoryTypeIndex;
+        VK_CHECK_ERROR(vkGetMemoryTypeIndex(physicalDeviceMemoryProperties,
+                                            memoryRequirements,
+                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                            &memoryTypeIndex));
+
+        VkMemoryAllocateInfo memoryAllocateInfo{
+                .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                .allocationSize = memoryRequirements.size,
+                .memoryTypeIndex = memoryTypeIndex
+        };
+        VK_CHECK_ERROR(vkAllocateMemory(mDevice, &memoryAllocateInfo, nullptr, &mImageMemory));
+        VK_CHECK_ERROR(vkBindImageMemory(mDevice, mImage, mImageMemory, 0));
+    }
+
+    void TearDown() override {
+        if (mDevice) {
+            mDeviceQueues.reset();
+            vkFreeMemory(mDevice, mImageMemory, nullptr);
+            vkDestroyImage(mDevice, mImage, nullptr);
+            vkDestroyDevice(mDevice, nullptr);
+        }
+        vkDestroyInstance(mInstance, nullptr);
+    }
+
+    void recordFrame(VkCommandBuffer commandBuffer) {
+        VkCommandBufferBeginInfo commandBufferBeginInfo{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+        };
+        VK_CHECK_ERROR(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+
+        VkImageSubresourceRange subresourceRange{
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .levelCount = 1,
+                .layerCount = 1
+        };
+
+        VkImageMemoryBarrier imageMemoryBarrier{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = mImage,
+                .subresourceRange = subresourceRange
+        };
+
+        VkClearColorValue clearColorValue{.float32{0.6431, 0.7765, 0.2235, 1.0}};
+        for (auto i = 0; i != kClearCount; ++i) {
+            vkCmdPipelineBarrier(commandBuffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 0,
+                                 0, nullptr,
+                                 0, nullptr,
+                                 1, &imageMemoryBarrier);
+            vkCmdClearColorImage(commandBuffer,
+                                 mImage,
+                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                 &clearColorValue,
+                                 1, &subresourceRange);
+            imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        }
+
+        VK_CHECK_ERROR(vkEndCommandBuffer(commandBuffer));
+
+        // 실제 렌더러에서 명령을 기록하는데 걸리는 시간을 흉내낸다.
+        for (auto end = steady_clock::now() + kCpuWorkDuration; steady_clock::now() < end;);
+    }
+
+    // 프레임 당 평균 시간을 밀리초 단위로 반환한다.
+    double measure(uint32_t framesInFlight) {
+        VkFrameRing frameRing(mDevice, mDeviceQueues.get(), mQueueFamilyIndex, framesInFlight);
+
+        steady_clock::time_point begin;
+        for (auto i = 0; i != kWarmUpFrameCount + kFrameCount; ++i) {
+            if (i == kWarmUpFrameCount) {
+                begin = steady_clock::now();
+            }
+
+            auto &frame = frameRing.beginFrame();
+            recordFrame(frame.commandBuffer);
+
+            VkSubmitInfo submitInfo{
+                    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                    .commandBufferCount = 1,
+                    .pCommandBuffers = &frame.commandBuffer
+            };
+            frame.ticket = mDeviceQueues->submit(VK_QUEUE_TYPE_GRAPHICS, submitInfo);
+
+            frameRing.endFrame();
+        }
+        frameRing.waitIdle();
+
+        duration<double, milli> elapsed = steady_clock::now() - begin;
+        return elapsed.count() / kFrameCount;
+    }
+
+    VkInstance mInstance{VK_NULL_HANDLE};
+    VkPhysicalDevice mPhysicalDevice{VK_NULL_HANDLE};
+    uint32_t mQueueFamilyIndex{0};
+    VkDevice mDevice{VK_NULL_HANDLE};
+    unique_ptr<VkDeviceQueues> mDeviceQueues;
+    VkImage mImage{VK_NULL_HANDLE};
+    VkDeviceMemory mImageMemory{VK_NULL_HANDLE};
+};
+
+} // namespace
+
+TEST_F(FrameRingBenchmark, framesInFlight) {
+    aout << "Frame Ring Benchmark ↓" << endl;
+    for (auto framesInFlight : array<uint32_t, 3>{1, 2, 3}) {
+        auto frameTime = measure(framesInFlight);
+        aout << " - Frames In Flight " << framesInFlight << ": "
+             << fixed << setprecision(3) << frameTime << " ms/frame" << endl;
+        EXPECT_GT(frameTime, 0.0);
+    }
+}
+
+TEST(RendererBenchmark, headlessRender) {
+    aout << "Headless Renderer Benchmark ↓" << endl;
+    for (auto framesInFlight : array<uint32_t, 3>{1, 2, 3}) {
+        VkRenderer renderer(kImageExtent, {.maxFramesInFlight = framesInFlight});
+
+        for (auto i = 0; i != kWarmUpFrameCount; ++i) {
+            renderer.render();
+        }
+
+        auto begin = steady_clock::now();
+        for (auto i = 0; i != kFrameCount; ++i) {
+            renderer.render();
+        }
+        renderer.waitIdle(); // 제출된 모든 프레임이 끝날 때까지 기다린다.
+
+        duration<double, milli> elapsed = steady_clock::now() - begin;
+        auto frameTime = elapsed.count() / kFrameCount;
+        aout << " - Frames In Flight " << framesInFlight << ": "
+             << fixed << setprecision(3) << frameTime << " ms/frame" << endl;
+        EXPECT_GT(frameTime, 0.0);
+    }
+}
@@ -0,0 +1,441 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "VkRenderer.h"
+#include "VkTrace.h"
+
+using namespace std;
+
+namespace {
+
+constexpr VkExtent2D kExtent{64, 64};
+
+struct Pixel {
+    uint8_t r, g, b, a;
+};
+
+Pixel pixelAt(const vector<uint8_t> &pixels, uint32_t x, uint32_t y) {
+    auto offset = (y * kExtent.width + x) * 4;
+    return {pixels[offset], pixels[offset + 1], pixels[offset + 2], pixels[offset + 3]};
+}
+
+} // namespace
+
+TEST(HeadlessRenderer, clearAndTriangle) {
+    VkRenderer renderer(kExtent);
+    ASSERT_TRUE(renderer.isHeadless());
+
+    renderer.render();
+
+    vector<uint8_t> pixels;
+    renderer.readPixels(&pixels);
+    ASSERT_EQ(pixels.size(), kExtent.width * kExtent.height * 4);
+
+    // 모서리는 삼각형 밖이므로 clear 색상이어야 한다.
+    auto corner = pixelAt(pixels, 0, 0);
+    EXPECT_NEAR(corner.r, 164, 1);
+    EXPECT_NEAR(corner.g, 198, 1);
+    EXPECT_NEAR(corner.b, 57, 1);
+    EXPECT_EQ(corner.a, 255);
+
+    // 중앙은 삼각형 안이므로 세 정점의 색이 보간된 색이어야 한다.
+    auto center = pixelAt(pixels, kExtent.width / 2, kExtent.height / 2);
+    EXPECT_GT(center.r, 0);
+    EXPECT_GT(center.g, 0);
+    EXPECT_GT(center.b, 0);
+    EXPECT_FALSE(center.r == corner.r && center.g == corner.g && center.b == corner.b);
+}
+
+TEST(HeadlessRenderer, framesInFlight) {
+    for (uint32_t framesInFlight = 1; framesInFlight <= 3; ++framesInFlight) {
+        VkRenderer renderer(kExtent, {.maxFramesInFlight = framesInFlight});
+
+        // 프레임 슬롯을 여러 바퀴 돌아도 마지막 프레임을 읽을 수 있어야 한다.
+        for (auto i = 0; i != framesInFlight * 4 + 1; ++i) {
+            renderer.render();
+        }
+
+        vector<uint8_t> pixels;
+        renderer.readPixels(&pixels);
+        EXPECT_EQ(pixelAt(pixels, 0, 0).a, 255);
+    }
+}
+
+TEST(HeadlessRenderer, subAllocatedResources) {
+    VkRenderer renderer(kExtent, {.maxFramesInFlight = 3});
+
+    // 오프스크린 이미지 3개, 정점/인덱스 버퍼, 스테이징 버퍼, 프레임 할당기의 버퍼, 기본 텍스처가
+    // 리소스마다 vkAllocateMemory를 호출하지 않고 메모리 타입마다 하나의 블록을 나눠서 사용해야 한다.
+    auto stats = renderer.memoryAllocatorStats();
+    EXPECT_EQ(stats.allocationCount, 8);
+    EXPECT_LE(stats.blockCount, 3);
+
+    // readPixels의 임시 버퍼는 해제되어야 한다.
+    renderer.render();
+    vector<uint8_t> pixels;
+    renderer.readPixels(&pixels);
+    EXPECT_EQ(renderer.memoryAllocatorStats().allocationCount, 8);
+}
+
+TEST(HeadlessRenderer, bindlessTexture) {
+    VkRenderer renderer(kExtent);
+    renderer.render();
+
+    vector<uint8_t> untextured;
+    renderer.readPixels(&untextured);
+
+    // 빨간색만 남기는 텍스처를 등록하고 그 인덱스로 그린다. 기본 텍스처와 다른 인덱스를 얻어야 한다.
+    vector<uint8_t> texels(4 * 4 * 4, 0);
+    for (size_t i = 0; i != texels.size(); i += 4) {
+        texels[i] = 255;
+        texels[i + 3] = 255;
+    }
+    auto materialIndex = renderer.createTexture(4, 4, texels.data());
+    ASSERT_NE(materialIndex, kInvalidBindlessIndex);
+    EXPECT_NE(materialIndex, renderer.defaultMaterialIndex());
+    EXPECT_EQ(renderer.bindlessHeap()->sampledImageCount(), 2);
+
+    renderer.setMaterialIndex(materialIndex);
+    renderer.render();
+
+    vector<uint8_t> textured;
+    renderer.readPixels(&textured);
+
+    // 삼각형 안에서는 정점 색상에 텍스처가 곱해져서 빨간색만 남는다.
+    auto center = pixelAt(textured, kExtent.width / 2, kExtent.height / 2);
+    auto untexturedCenter = pixelAt(untextured, kExtent.width / 2, kExtent.height / 2);
+    EXPECT_NEAR(center.r, untexturedCenter.r, 1);
+    EXPECT_EQ(center.g, 0);
+    EXPECT_EQ(center.b, 0);
+    EXPECT_GT(untexturedCenter.g, 0);
+
+    // 삼각형 밖은 clear 색상 그대로다.
+    auto corner = pixelAt(textured, 0, 0);
+    EXPECT_NEAR(corner.r, 164, 1);
+    EXPECT_NEAR(corner.g, 198, 1);
+    EXPECT_NEAR(corner.b, 57, 1);
+}
+
+TEST(HeadlessRenderer, frameAllocator) {
+    VkRenderer renderer(kExtent, {.frameAllocatorSize = 64 * 1024});
+
+    // 첫 번째 프레임의 기록이 끝나기 전에는 통계가 비어있다.
+    auto stats = renderer.frameAllocatorStats();
+    EXPECT_GE(stats.frameSize, 64 * 1024);
+    EXPECT_EQ(stats.highWaterMark, 0);
+
+    for (auto i = 0; i != 4; ++i) {
+        renderer.render();
+    }
+
+    stats = renderer.frameAllocatorStats();
+    EXPECT_GT(stats.lastFrameSize, 0);
+    EXPECT_EQ(stats.highWaterMark, stats.lastFrameSize);
+    EXPECT_LE(stats.highWaterMark, stats.frameSize);
+    EXPECT_EQ(stats.overflowCount, 0);
+}
+
+TEST(HeadlessRenderer, instancedMesh) {
+    VkRenderer renderer(kExtent);
+
+    // 절반 크기의 삼각형을 왼쪽과 오른쪽에 하나씩 그린다.
+    renderer.setInstances({
+            MeshInstance{.offset{-0.5, 0.0, 0.0}, .scale = 0.5},
+            MeshInstance{.offset{0.5, 0.0, 0.0}, .scale = 0.5}
+    });
+    renderer.render();
+
+    vector<uint8_t> pixels;
+    renderer.readPixels(&pixels);
+
+    // 중앙은 두 삼각형 사이이므로 clear 색상이어야 한다.
+    auto center = pixelAt(pixels, kExtent.width / 2, kExtent.height / 2);
+    EXPECT_NEAR(center.r, 164, 1);
+    EXPECT_NEAR(center.g, 198, 1);
+    EXPECT_NEAR(center.b, 57, 1);
+
+    // 각 인스턴스의 중심은 삼각형 안이다.
+    for (auto x : {kExtent.width / 4, kExtent.width * 3 / 4}) {
+        auto pixel = pixelAt(pixels, x, kExtent.height / 2 + 2);
+        EXPECT_FALSE(pixel.r == center.r && pixel.g == center.g && pixel.b == center.b);
+    }
+}
+
+TEST(HeadlessRenderer, parallelRecording) {
+    // 인스턴스마다 그리기를 기록해서 여러 스레드에 나눠지도록 한다.
+    vector<MeshInstance> instances;
+    for (auto i = 0; i != 100; ++i) {
+        instances.push_back({.offset{(i % 10) * 0.2f - 0.9f, (i / 10) * 0.2f - 0.9f, 0.0f}, .scale = 0.1f});
+    }
+
+    vector<uint8_t> expected;
+    {
+        VkRenderer renderer(kExtent, {.jobThreadCount = 1, .maxInstancesPerDraw = 1});
+        renderer.setInstances(instances);
+        renderer.render();
+        renderer.readPixels(&expected);
+    }
+
+    // secondary command buffer는 범위 순서대로 실행되므로 한 스레드에서 기록한 결과와 같아야 한다.
+    VkRenderer renderer(kExtent, {.jobThreadCount = 4, .maxInstancesPerDraw = 1});
+    renderer.setInstances(instances);
+    for (auto i = 0; i != 3; ++i) {
+        renderer.render();
+    }
+
+    vector<uint8_t> pixels;
+    renderer.readPixels(&pixels);
+    EXPECT_EQ(pixels, expected);
+}
+
+TEST(HeadlessRenderer, drawDataPath) {
+    vector<MeshInstance> instances;
+    for (auto i = 0; i != 16; ++i) {
+        instances.push_back({.offset{(i % 4) * 0.5f - 0.75f, (i / 4) * 0.5f - 0.75f, 0.0f}, .scale = 0.2f});
+    }
+
+    // 그리기마다 데이터를 push constant로 넘기든 dynamic uniform buffer로 넘기든 결과는 같아야 한다.
+    vector<vector<uint8_t>> results;
+    for (auto drawDataPath : {VK_DRAW_DATA_PATH_PUSH_CONSTANTS, VK_DRAW_DATA_PATH_UNIFORM_BUFFER}) {
+        VkRenderer renderer(kExtent, {.maxInstancesPerDraw = 1, .drawDataPath = drawDataPath});
+        renderer.setInstances(instances);
+        renderer.render();
+
+        vector<uint8_t> pixels;
+        renderer.readPixels(&pixels);
+        results.push_back(std::move(pixels));
+
+        EXPECT_EQ(renderer.frameAllocatorStats().overflowCount, 0);
+    }
+    EXPECT_EQ(results[0], results[1]);
+}
+
+TEST(HeadlessRenderer, pipelineState) {
+    VkRenderer renderer(kExtent);
+    renderer.render();
+
+    vector<uint8_t> opaque;
+    renderer.readPixels(&opaque);
+
+    // 처음 사용하는 상태는 기다리지 않고 기본 상태의 파이프라인으로 그린다.
+    renderer.setPipelineState({.blendMode = VK_BLEND_MODE_ADDITIVE});
+    renderer.render();
+
+    auto stats = renderer.pipelineManagerStats();
+    EXPECT_EQ(stats.missCount, 1);
+    EXPECT_GE(stats.fallbackCount, 1);
+
+    // 만들어진 후에는 요청한 상태로 그린다. 삼각형에 clear 색상이 더해져서 밝아진다.
+    renderer.waitPipelines();
+    renderer.render();
+
+    vector<uint8_t> additive;
+    renderer.readPixels(&additive);
+
+    auto center = pixelAt(additive, kExtent.width / 2, kExtent.height / 2);
+    auto opaqueCenter = pixelAt(opaque, kExtent.width / 2, kExtent.height / 2);
+    EXPECT_GE(center.r, opaqueCenter.r);
+    EXPECT_GT(center.g, opaqueCenter.g);
+    EXPECT_EQ(pixelAt(additive, 0, 0).g, pixelAt(opaque, 0, 0).g);
+
+    stats = renderer.pipelineManagerStats();
+    EXPECT_EQ(stats.pipelineCount, 2);
+    EXPECT_EQ(stats.pendingCount, 0);
+    EXPECT_GE(stats.hitCount, 1);
+}
+
+TEST(HeadlessRenderer, fallbackTopology) {
+    VkRenderer renderer(kExtent);
+
+    // 기본 상태의 파이프라인과 topology의 종류가 다르면 대신 그리지 않고 건너뛴다.
+    renderer.setPipelineState({.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST});
+    renderer.render();
+
+    vector<uint8_t> pixels;
+    renderer.readPixels(&pixels);
+
+    auto center = pixelAt(pixels, kExtent.width / 2, kExtent.height / 2);
+    auto corner = pixelAt(pixels, 0, 0);
+    EXPECT_TRUE(center.r == corner.r && center.g == corner.g && center.b == corner.b);
+
+    auto stats = renderer.pipelineManagerStats();
+    EXPECT_EQ(stats.missCount, 1);
+    EXPECT_EQ(stats.fallbackCount, 0);
+    EXPECT_GE(stats.skipCount, 1);
+
+    // 만들어진 후에는 요청한 파이프라인으로 그린다.
+    renderer.waitPipelines();
+    renderer.render();
+
+    stats = renderer.pipelineManagerStats();
+    EXPECT_EQ(stats.pipelineCount, 2);
+    EXPECT_GE(stats.hitCount, 1);
+}
+
+TEST(HeadlessRenderer, dynamicRendering) {
+    vector<MeshInstance> instances;
+    for (auto i = 0; i != 128; ++i) {
+        instances.push_back({.offset{(i % 16) * 0.125f - 0.94f, (i / 16) * 0.25f - 0.875f, 0.0f}, .scale = 0.1f});
+    }
+
+    // VkRenderPass로 그리든 dynamic rendering으로 그리든 결과는 같아야 한다.
+    // secondary command buffer로 나눠서 기록하는 경로도 함께 확인한다.
+    vector<vector<uint8_t>> results;
+    for (auto dynamicRendering : {false, true}) {
+        VkRenderer renderer(kExtent, {.jobThreadCount = 2,
+                                      .maxInstancesPerDraw = 1,
+                                      .dynamicRendering = dynamicRendering});
+        if (dynamicRendering && !renderer.pipelineFeatures().dynamicRendering) {
+            GTEST_SKIP() << "VK_KHR_dynamic_rendering is not supported.";
+        }
+        EXPECT_EQ(renderer.pipelineFeatures().dynamicRendering, dynamicRendering);
+
+        renderer.setInstances(instances);
+        renderer.render();
+
+        vector<uint8_t> pixels;
+        renderer.readPixels(&pixels);
+        results.push_back(std::move(pixels));
+    }
+    EXPECT_EQ(results[0], results[1]);
+}
+
+TEST(HeadlessRenderer, extendedDynamicState) {
+    VkRenderer renderer(kExtent);
+    if (!renderer.pipelineFeatures().extendedDynamicState) {
+        GTEST_SKIP() << "VK_EXT_extended_dynamic_state is not supported.";
+    }
+
+    // 동적 상태만 바꾸면 새 파이프라인을 만들지 않고 바로 그 상태로 그린다.
+    renderer.setPipelineState({.cullMode = VK_CULL_MODE_FRONT_AND_BACK});
+    renderer.render();
+
+    vector<uint8_t> pixels;
+    renderer.readPixels(&pixels);
+
+    auto center = pixelAt(pixels, kExtent.width / 2, kExtent.height / 2);
+    auto corner = pixelAt(pixels, 0, 0);
+    EXPECT_TRUE(center.r == corner.r && center.g == corner.g && center.b == corner.b);
+
+    auto stats = renderer.pipelineManagerStats();
+    EXPECT_EQ(stats.missCount, 0);
+    EXPECT_EQ(stats.fallbackCount, 0);
+    EXPECT_EQ(stats.pipelineCount, 1);
+}
+
+TEST(HeadlessRenderer, startupTimeline) {
+    VkRenderer renderer(kExtent, {.jobThreadCount = 2});
+
+    // 셰이더 두 개와 파이프라인 하나가 만들어지고, 파이프라인은 두 셰이더가 끝난 후에 시작한다.
+    const auto &timeline = renderer.startupTimeline();
+    ASSERT_EQ(timeline.size(), 3);
+
+    uint64_t shadersEndTime{0};
+    for (const auto &step : timeline) {
+        EXPECT_LT(step.threadIndex, 2);
+        EXPECT_LE(step.beginTime, step.endTime);
+        if (!step.pipeline) {
+            shadersEndTime = max(shadersEndTime, step.endTime);
+        }
+    }
+
+    auto pipelineStep = find_if(timeline.begin(), timeline.end(), [](const VkBuildStep &step) {
+        return step.pipeline;
+    });
+    ASSERT_NE(pipelineStep, timeline.end());
+    EXPECT_GE(pipelineStep->beginTime, shadersEndTime);
+}
+
+TEST(HeadlessRenderer, gpuProfiler) {
+    VkRenderer renderer(kExtent, {.maxFramesInFlight = 2});
+    if (!renderer.gpuProfilingEnabled()) {
+        GTEST_SKIP() << "Timestamp queries are not supported.";
+    }
+
+    constexpr uint32_t kFrameCount = 8;
+    for (auto i = 0; i != kFrameCount; ++i) {
+        renderer.render();
+    }
+
+    // 결과는 슬롯을 다시 사용할 때 읽으므로 마지막 2 프레임은 아직 반영되지 않는다.
+    auto timings = renderer.gpuTimings();
+    ASSERT_EQ(timings.size(), 2);
+    for (const auto &timing : timings) {
+        EXPECT_TRUE(timing.name == "Frame" || timing.name == "RenderPass");
+        EXPECT_EQ(timing.sampleCount, kFrameCount - 2);
+        EXPECT_GE(timing.minTime, 0.0);
+        EXPECT_LE(timing.p50Time, timing.maxTime);
+    }
+
+    auto path = testing::TempDir() + "gpu_trace.json";
+    ASSERT_TRUE(renderer.writeTrace(path));
+
+    ifstream file(path);
+    string trace(istreambuf_iterator<char>(file), {});
+    EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0);
+    EXPECT_NE(trace.find("\"name\":\"RenderPass\""), string::npos);
+}
+
+#ifdef VK_CPU_TRACE
+TEST(HeadlessRenderer, cpuTrace) {
+    VkRenderer renderer(kExtent, {.maxFramesInFlight = 2});
+
+    // 다른 스레드에서 기록한 구간도 함께 모인다.
+    thread worker([] {
+        VK_TRACE_THREAD_NAME("Worker");
+        VK_TRACE_SCOPE("WorkerScope");
+    });
+    worker.join();
+
+    for (auto i = 0; i != 4; ++i) {
+        renderer.render();
+    }
+
+    vector<VkTraceEvent> events;
+    vector<VkTraceThread> threads;
+    vkTraceCollect(&events, &threads);
+
+    auto count = [&events](const string &name) {
+        return count_if(events.begin(), events.end(), [&name](const auto &event) { return event.name == name; });
+    };
+    EXPECT_GE(count("Render"), 4);
+    EXPECT_GE(count("WaitFrame"), 4);
+    EXPECT_GE(count("Record"), 4);
+    EXPECT_GE(count("Submit"), 4);
+    EXPECT_GE(count("WorkerScope"), 1);
+    EXPECT_TRUE(any_of(threads.begin(), threads.end(), [](const auto &thread) { return thread.name == "Worker"; }));
+
+    // CPU 구간은 모두 CPU 프로세스에 기록된다.
+    for (const auto &event : events) {
+        EXPECT_EQ(event.pid, kVkTraceCpuPid);
+    }
+}
+#endif
@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "VkJobSystem.h"
+#include "AndroidOut.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+constexpr uint32_t kBatchSize = 2048; // 한 번에 진행중인 작업이 kJobRingBlockSize를 넘어서 링 버퍼가 늘어나지 않도록 나눈다.
+constexpr uint32_t kBatchCount = 100;
+
+// 0번 스레드가 빈 작업을 만들어 넣고 기다린다. 작업 하나당 평균 시간을 나노초 단위로 반환한다.
+// 작업 스레드가 있으면 대부분의 작업은 다른 스레드가 훔쳐가서 실행한다.
+double measure(VkJobSystem *jobSystem, const VkJobFunction &function) {
+    auto begin = steady_clock::now();
+    for (uint32_t batch = 0; batch != kBatchCount; ++batch) {
+        auto root = jobSystem->create({});
+        for (uint32_t i = 0; i != kBatchSize; ++i) {
+            jobSystem->run(jobSystem->create(function, root));
+        }
+        jobSystem->run(root);
+        jobSystem->wait(root);
+    }
+
+    duration<double, nano> elapsed = steady_clock::now() - begin;
+    return elapsed.count() / (kBatchCount * kBatchSize);
+}
+
+} // namespace
+
+TEST(JobSystemBenchmark, spawnAndSteal) {
+    aout << "Job System Benchmark ↓" << endl;
+    aout << fixed << setprecision(1);
+
+    auto hardwareThreadCount = max(thread::hardware_concurrency(), 1u);
+    for (auto threadCount : array<uint32_t, 4>{1, 2, 4, 8}) {
+        if (threadCount > hardwareThreadCount) {
+            break;
+        }
+
+        VkJobSystem jobSystem(threadCount);
+
+        // 빈 작업은 만들고, 넣고, 꺼내는(훔치는) 비용만 측정된다.
+        auto emptyTime = measure(&jobSystem, [] {});
+
+        // 약 1us의 일을 하는 작업은 스레드 수에 따라 처리량이 늘어나야 한다.
+        auto workTime = measure(&jobSystem, [] {
+            for (auto end = steady_clock::now() + microseconds(1); steady_clock::now() < end;);
+        });
+
+        aout << " - Threads " << threadCount << ": "
+             << emptyTime << " ns/empty job, " << workTime << " ns/1us job" << endl;
+        EXPECT_GT(emptyTime, 0.0);
+        EXPECT_GT(workTime, 0.0);
+    }
+}
@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <numeric>
+#include <set>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "VkJobSystem.h"
+
+using namespace std;
+
+TEST(JobSystem, parentWaitsForChildren) {
+    VkJobSystem jobSystem(4);
+    atomic<uint32_t> count{0};
+
+    auto root = jobSystem.create({});
+    for (auto i = 0; i != 1000; ++i) {
+        jobSystem.run(jobSystem.create([&count] { ++count; }, root));
+    }
+    jobSystem.run(root);
+    jobSystem.wait(root);
+
+    EXPECT_TRUE(jobSystem.isComplete(root));
+    EXPECT_EQ(count, 1000);
+}
+
+TEST(JobSystem, moreJobsThanRing) {
+    VkJobSystem jobSystem(4);
+    atomic<uint32_t> count{0};
+
+    // 실행하기 전에 링 버퍼보다 많은 작업을 만들어도 진행중인 작업의 자리를 다시 사용하지 않는다.
+    constexpr auto jobCount = VkJobSystem::kJobRingBlockSize * 2 + 1;
+    auto root = jobSystem.create({});
+    vector<VkJob *> jobs;
+    for (auto i = 0; i != jobCount; ++i) {
+        jobs.push_back(jobSystem.create([&count] { ++count; }, root));
+    }
+    EXPECT_EQ(set<VkJob *>(jobs.begin(), jobs.end()).size(), jobCount);
+
+    for (auto job : jobs) {
+        jobSystem.run(job);
+    }
+    jobSystem.run(root);
+    jobSystem.wait(root);
+    EXPECT_EQ(count, jobCount);
+
+    // 끝난 작업의 자리는 다시 사용한다.
+    count = 0;
+    for (auto i = 0; i != 10; ++i) {
+        jobSystem.parallelFor(jobCount, 1, [&count](uint32_t begin, uint32_t end) { count += end - begin; });
+    }
+    EXPECT_EQ(count, jobCount * 10);
+}
+
+TEST(JobSystem, nestedJobs) {
+    VkJobSystem jobSystem(4);
+    vector<uint64_t> sums(64);
+
+    // 작업 안에서 자식 작업을 만들고 기다려도 다른 작업을 실행하며 기다리므로 멈추지 않는다.
+    jobSystem.parallelFor(64, 1, [&](uint32_t begin, uint32_t end) {
+        for (auto i = begin; i != end; ++i) {
+            vector<uint64_t> values(100);
+            jobSystem.parallelFor(100, 10, [&values, i](uint32_t valueBegin, uint32_t valueEnd) {
+                for (auto j = valueBegin; j != valueEnd; ++j) {
+                    values[j] = i * j;
+                }
+            });
+            sums[i] = accumulate(values.begin(), values.end(), uint64_t{0});
+        }
+    });
+
+    for (uint64_t i = 0; i != sums.size(); ++i) {
+        EXPECT_EQ(sums[i], i * 4950);
+    }
+}
+
+TEST(JobSystem, singleThread) {
+    // 작업 스레드가 없으면 wait()를 호출한 스레드가 모든 작업을 실행한다.
+    VkJobSystem jobSystem(1);
+    EXPECT_EQ(jobSystem.threadCount(), 1);
+
+    set<uint32_t> threadIndices;
+    jobSystem.parallelFor(100, 7, [&](uint32_t, uint32_t) {
+        threadIndices.insert(jobSystem.threadIndex());
+    });
+    EXPECT_EQ(threadIndices, set<uint32_t>({0}));
+}
@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "VkRenderer.h"
+#include "MeshTestUtil.h"
+#include "AndroidOut.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+constexpr VkExtent2D kImageExtent{1920, 1080};
+constexpr uint32_t kGridSize = 256;      // 256 x 256 x 2 = 131,072개의 삼각형
+constexpr uint32_t kInstanceCount = 16;  // 프레임마다 약 2백만개의 삼각형
+constexpr uint32_t kWarmUpFrameCount = 10;
+constexpr uint32_t kFrameCount = 100;
+
+double measure(VkRenderer *renderer, const MeshData &meshData) {
+    renderer->setMesh(meshData);
+
+    for (auto i = 0; i != kWarmUpFrameCount; ++i) {
+        renderer->render();
+    }
+
+    auto begin = steady_clock::now();
+    for (auto i = 0; i != kFrameCount; ++i) {
+        renderer->render();
+    }
+    renderer->waitIdle();
+
+    duration<double, milli> elapsed = steady_clock::now() - begin;
+    return elapsed.count() / kFrameCount;
+}
+
+} // namespace
+
+TEST(MeshBenchmark, indexedAndOptimized) {
+    // ================================================================================
+    // 1. 같은 격자를 세 가지 방법으로 준비
+    // ================================================================================
+    MeshData nonIndexed{.vertices = makeShuffledGrid(kGridSize)};
+
+    MeshData indexed;
+    vkDeduplicateVertices(nonIndexed.vertices, &indexed);
+
+    auto optimized = indexed;
+    vkOptimizeVertexCache(static_cast<uint32_t>(optimized.vertices.size()), &optimized.indices);
+    vkOptimizeVertexFetch(&optimized);
+
+    // ================================================================================
+    // 2. 인스턴스로 화면을 덮도록 배치
+    // ================================================================================
+    VkRenderer renderer(kImageExtent);
+
+    vector<MeshInstance> instances;
+    for (uint32_t i = 0; i != kInstanceCount; ++i) {
+        instances.push_back({
+                .offset{(i % 4) * 0.5f - 0.75f, (i / 4) * 0.5f - 0.75f, 0.0f},
+                .scale = 0.25f
+        });
+    }
+    renderer.setInstances(instances);
+
+    // ================================================================================
+    // 3. 측정
+    // ================================================================================
+    aout << "Mesh Benchmark ↓" << endl;
+    aout << fixed << setprecision(3);
+
+    const array<pair<const char *, const MeshData *>, 3> variants{
+            pair{"Non-Indexed", &nonIndexed},
+            pair{"Indexed", &indexed},
+            pair{"Optimized", &optimized}
+    };
+
+    for (const auto &[name, meshData]: variants) {
+        auto frameTime = measure(&renderer, *meshData);
+        auto acmr = meshData->indices.empty() ? 3.0f : vkCalculateAcmr(meshData->indices);
+        aout << " - " << name << ": " << frameTime << " ms/frame (ACMR " << acmr << ")" << endl;
+        EXPECT_GT(frameTime, 0.0);
+    }
+}
@@ -0,0 +1,101 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "VkMesh.h"
+#include "MeshTestUtil.h"
+
+using namespace std;
+
+TEST(Mesh, deduplicateVertices) {
+    auto vertices = makeShuffledGrid(8);
+
+    MeshData meshData;
+    vkDeduplicateVertices(vertices, &meshData);
+
+    // 9 x 9개의 격자점만 남아야 하고 인덱스는 원래 정점을 가리켜야 한다.
+    EXPECT_EQ(meshData.vertices.size(), 9 * 9);
+    ASSERT_EQ(meshData.indices.size(), vertices.size());
+    for (size_t i = 0; i != vertices.size(); ++i) {
+        const auto &vertex = meshData.vertices[meshData.indices[i]];
+        EXPECT_EQ(vertex.position.x, vertices[i].position.x);
+        EXPECT_EQ(vertex.position.y, vertices[i].position.y);
+    }
+}
+
+TEST(Mesh, acmrWithoutTriangles) {
+    // 삼각형 수가 0이면 0으로 나누지 않고 0을 반환해야 한다.
+    EXPECT_EQ(vkCalculateAcmr({}), 0.0f);
+    EXPECT_EQ(vkCalculateAcmr({0}), 0.0f);
+    EXPECT_EQ(vkCalculateAcmr({0, 1}), 0.0f);
+    EXPECT_EQ(vkCalculateAcmr({0, 1, 2}), 3.0f);
+}
+
+TEST(Mesh, optimizeVertexCache) {
+    MeshData meshData;
+    vkDeduplicateVertices(makeShuffledGrid(64), &meshData);
+
+    auto triangles = meshData.indices;
+    auto shuffledAcmr = vkCalculateAcmr(meshData.indices);
+
+    vkOptimizeVertexCache(static_cast<uint32_t>(meshData.vertices.size()), &meshData.indices);
+    auto optimizedAcmr = vkCalculateAcmr(meshData.indices);
+
+    // 순서가 섞인 격자는 삼각형마다 거의 모든 정점을 다시 처리하지만 최적화 후에는 1 이하가 되어야 한다.
+    EXPECT_GT(shuffledAcmr, 2.0f);
+    EXPECT_LT(optimizedAcmr, 1.0f);
+
+    // 삼각형의 순서만 바뀌고 삼각형 자체는 그대로여야 한다.
+    auto sortedTriangles = [](const vector<uint32_t> &indices) {
+        vector<array<uint32_t, 3>> result;
+        for (size_t i = 0; i != indices.size(); i += 3) {
+            result.push_back({indices[i], indices[i + 1], indices[i + 2]});
+        }
+        sort(result.begin(), result.end());
+        return result;
+    };
+    EXPECT_EQ(sortedTriangles(triangles), sortedTriangles(meshData.indices));
+}
+
+TEST(Mesh, optimizeVertexFetch) {
+    MeshData meshData{
+            .vertices{
+                    Vertex{.position{0.0f, 0.0f, 0.0f}},
+                    Vertex{.position{1.0f, 0.0f, 0.0f}},
+                    Vertex{.position{2.0f, 0.0f, 0.0f}},
+                    Vertex{.position{3.0f, 0.0f, 0.0f}} // 사용되지 않는 정점
+            },
+            .indices{2, 0, 1}
+    };
+
+    vkOptimizeVertexFetch(&meshData);
+
+    ASSERT_EQ(meshData.vertices.size(), 3);
+    EXPECT_EQ(meshData.indices, (vector<uint32_t>{0, 1, 2}));
+    EXPECT_EQ(meshData.vertices[0].position.x, 2.0f);
+    EXPECT_EQ(meshData.vertices[1].position.x, 0.0f);
+    EXPECT_EQ(meshData.vertices[2].position.x, 1.0f);
+}
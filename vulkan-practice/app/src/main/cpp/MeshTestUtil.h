@@ -0,0 +1,63 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_MESHTESTUTIL_H
+#define PRACTICE_VULKAN_MESHTESTUTIL_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "VkMesh.h"
+
+// MeshTest와 MeshBenchmark가 함께 사용하는 메시 생성 함수.
+// n x n개의 사각형으로 이루어진 격자를 인덱스 없는 삼각형 목록으로 만든다.
+// 에셋을 그대로 읽은 것처럼 삼각형의 순서는 섞는다.
+inline std::vector<Vertex> makeShuffledGrid(uint32_t n) {
+    auto vertexAt = [n](uint32_t x, uint32_t y) {
+        auto u = static_cast<float>(x) / n;
+        auto v = static_cast<float>(y) / n;
+        return Vertex{
+                .position{u * 2.0f - 1.0f, v * 2.0f - 1.0f, 0.0f},
+                .color{u, v, 1.0f}
+        };
+    };
+
+    std::vector<std::array<Vertex, 3>> triangles;
+    for (uint32_t y = 0; y != n; ++y) {
+        for (uint32_t x = 0; x != n; ++x) {
+            triangles.push_back({vertexAt(x, y), vertexAt(x + 1, y), vertexAt(x, y + 1)});
+            triangles.push_back({vertexAt(x + 1, y), vertexAt(x + 1, y + 1), vertexAt(x, y + 1)});
+        }
+    }
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(7));
+
+    std::vector<Vertex> vertices;
+    for (const auto &triangle: triangles) {
+        vertices.insert(vertices.end(), triangle.begin(), triangle.end());
+    }
+    return vertices;
+}
+
+#endif //PRACTICE_VULKAN_MESHTESTUTIL_H
@@ -0,0 +1,58 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "VkRenderer.h"
+#include "AndroidOut.h"
+
+using namespace std;
+using namespace std::chrono;
+
+TEST(PipelineCacheBenchmark, coldAndWarm) {
+    auto pipelineCachePath = testing::TempDir() + "pipeline_cache_benchmark.bin";
+    remove(pipelineCachePath.c_str());
+
+    duration<double, milli> coldTime;
+    {
+        // 캐시 파일이 없으므로 드라이버가 파이프라인을 처음부터 컴파일한다.
+        VkRenderer renderer(VkExtent2D{64, 64}, {.pipelineCachePath = pipelineCachePath});
+        coldTime = renderer.pipelineCreationTime();
+    } // 소멸되면서 캐시가 파일에 저장된다.
+
+    duration<double, milli> warmTime;
+    {
+        VkRenderer renderer(VkExtent2D{64, 64}, {.pipelineCachePath = pipelineCachePath});
+        warmTime = renderer.pipelineCreationTime();
+    }
+
+    aout << "Pipeline Cache Benchmark ↓" << endl;
+    aout << fixed << setprecision(3);
+    aout << " - Cold: " << coldTime.count() << " ms" << endl;
+    aout << " - Warm: " << warmTime.count() << " ms" << endl;
+
+    remove(pipelineCachePath.c_str());
+}
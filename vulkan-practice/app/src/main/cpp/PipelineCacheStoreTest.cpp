@@ -0,0 +1,224 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "VkPipelineCacheStore.h"
+
+using namespace std;
+
+namespace {
+
+VkPhysicalDeviceProperties makePhysicalDeviceProperties() {
+    VkPhysicalDeviceProperties physicalDeviceProperties{
+            .vendorID = 0x13b5,
+            .deviceID = 0x92020010
+    };
+    for (auto i = 0; i != VK_UUID_SIZE; ++i) {
+        physicalDeviceProperties.pipelineCacheUUID[i] = static_cast<uint8_t>(i);
+    }
+    return physicalDeviceProperties;
+}
+
+vector<uint8_t> makeCacheData(const VkPhysicalDeviceProperties &physicalDeviceProperties) {
+    VkPipelineCacheHeaderVersionOne header{
+            .headerSize = sizeof(VkPipelineCacheHeaderVersionOne),
+            .headerVersion = VK_PIPELINE_CACHE_HEADER_VERSION_ONE,
+            .vendorID = physicalDeviceProperties.vendorID,
+            .deviceID = physicalDeviceProperties.deviceID
+    };
+    memcpy(header.pipelineCacheUUID, physicalDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE);
+
+    vector<uint8_t> data(sizeof(header) + 64); // 헤더 뒤에는 드라이버 고유의 데이터가 온다.
+    memcpy(data.data(), &header, sizeof(header));
+    return data;
+}
+
+vector<uint8_t> readFile(const string &path) {
+    ifstream file(path, ios::binary);
+    return {istreambuf_iterator<char>(file), istreambuf_iterator<char>()};
+}
+
+// 워커 캐시를 합치는 테스트는 실제 장치가 필요하다. 렌더러 없이 큐 하나만 있는 장치를 만든다.
+class PipelineCacheStoreDevice : public testing::Test {
+protected:
+    void SetUp() override {
+        VkApplicationInfo applicationInfo{
+                .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+                .apiVersion = VK_MAKE_API_VERSION(0, 1, 1, 0)
+        };
+
+        VkInstanceCreateInfo instanceCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+                .pApplicationInfo = &applicationInfo
+        };
+
+        if (vkCreateInstance(&instanceCreateInfo, nullptr, &mInstance) != VK_SUCCESS) {
+            GTEST_SKIP() << "Vulkan is not available.";
+        }
+
+        uint32_t physicalDeviceCount{1};
+        VkPhysicalDevice physicalDevice;
+        vkEnumeratePhysicalDevices(mInstance, &physicalDeviceCount, &physicalDevice);
+        if (physicalDeviceCount == 0) {
+            GTEST_SKIP() << "No physical device.";
+        }
+        vkGetPhysicalDeviceProperties(physicalDevice, &mPhysicalDeviceProperties);
+
+        auto queuePriority = 1.0f;
+        VkDeviceQueueCreateInfo deviceQueueCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                .queueFamilyIndex = 0,
+                .queueCount = 1,
+                .pQueuePriorities = &queuePriority
+        };
+
+        VkDeviceCreateInfo deviceCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+                .queueCreateInfoCount = 1,
+                .pQueueCreateInfos = &deviceQueueCreateInfo
+        };
+
+        ASSERT_EQ(vkCreateDevice(physicalDevice, &deviceCreateInfo, nullptr, &mDevice), VK_SUCCESS);
+
+        mPath = testing::TempDir() + "pipeline_cache_store_test.bin";
+        remove(mPath.c_str());
+    }
+
+    void TearDown() override {
+        if (!mPath.empty()) {
+            remove(mPath.c_str());
+        }
+        vkDestroyDevice(mDevice, nullptr);
+        vkDestroyInstance(mInstance, nullptr);
+    }
+
+    VkInstance mInstance{VK_NULL_HANDLE};
+    VkPhysicalDeviceProperties mPhysicalDeviceProperties{};
+    VkDevice mDevice{VK_NULL_HANDLE};
+    string mPath;
+};
+
+} // namespace
+
+TEST(PipelineCacheStore, validHeader) {
+    auto physicalDeviceProperties = makePhysicalDeviceProperties();
+    EXPECT_TRUE(VkPipelineCacheStore::validate(makeCacheData(physicalDeviceProperties),
+                                               physicalDeviceProperties));
+}
+
+TEST(PipelineCacheStore, truncatedData) {
+    auto physicalDeviceProperties = makePhysicalDeviceProperties();
+    auto data = makeCacheData(physicalDeviceProperties);
+    data.resize(sizeof(VkPipelineCacheHeaderVersionOne) - 1);
+    EXPECT_FALSE(VkPipelineCacheStore::validate(data, physicalDeviceProperties));
+    EXPECT_FALSE(VkPipelineCacheStore::validate({}, physicalDeviceProperties));
+}
+
+TEST(PipelineCacheStore, mismatchedDevice) {
+    auto physicalDeviceProperties = makePhysicalDeviceProperties();
+    auto data = makeCacheData(physicalDeviceProperties);
+
+    auto otherVendor = physicalDeviceProperties;
+    otherVendor.vendorID += 1;
+    EXPECT_FALSE(VkPipelineCacheStore::validate(data, otherVendor));
+
+    auto otherDevice = physicalDeviceProperties;
+    otherDevice.deviceID += 1;
+    EXPECT_FALSE(VkPipelineCacheStore::validate(data, otherDevice));
+
+    // 드라이버가 업데이트되면 UUID가 바뀐다.
+    auto otherDriver = physicalDeviceProperties;
+    otherDriver.pipelineCacheUUID[0] ^= 0xff;
+    EXPECT_FALSE(VkPipelineCacheStore::validate(data, otherDriver));
+}
+
+TEST(PipelineCacheStore, invalidHeaderFields) {
+    auto physicalDeviceProperties = makePhysicalDeviceProperties();
+    auto data = makeCacheData(physicalDeviceProperties);
+
+    auto badVersion = data;
+    reinterpret_cast<VkPipelineCacheHeaderVersionOne *>(badVersion.data())->headerVersion =
+            static_cast<VkPipelineCacheHeaderVersion>(2);
+    EXPECT_FALSE(VkPipelineCacheStore::validate(badVersion, physicalDeviceProperties));
+
+    auto badSize = data;
+    reinterpret_cast<VkPipelineCacheHeaderVersionOne *>(badSize.data())->headerSize =
+            static_cast<uint32_t>(data.size() + 1);
+    EXPECT_FALSE(VkPipelineCacheStore::validate(badSize, physicalDeviceProperties));
+}
+
+TEST_F(PipelineCacheStoreDevice, mergeWorkerCachesAndReload) {
+    {
+        VkPipelineCacheStore pipelineCacheStore(mDevice, mPhysicalDeviceProperties, mPath);
+        EXPECT_FALSE(pipelineCacheStore.isWarm());
+
+        for (auto i = 0; i != 4; ++i) {
+            EXPECT_NE(pipelineCacheStore.createWorkerCache(), VK_NULL_HANDLE);
+        }
+        pipelineCacheStore.save();
+    }
+
+    // 저장된 파일은 이 장치의 헤더를 가지고 있어야 하고 다음 실행에서 불러올 수 있어야 한다.
+    auto data = readFile(mPath);
+    EXPECT_TRUE(VkPipelineCacheStore::validate(data, mPhysicalDeviceProperties));
+
+    VkPipelineCacheStore pipelineCacheStore(mDevice, mPhysicalDeviceProperties, mPath);
+    EXPECT_TRUE(pipelineCacheStore.isWarm());
+}
+
+TEST_F(PipelineCacheStoreDevice, saveWhileWorkerCachesAlive) {
+    VkPipelineCacheStore pipelineCacheStore(mDevice, mPhysicalDeviceProperties, mPath);
+    auto workerCache = pipelineCacheStore.createWorkerCache();
+
+    // save는 워커 캐시를 파괴하지 않으므로 여러 번 합쳐도 워커 캐시를 계속 사용할 수 있다.
+    pipelineCacheStore.save();
+    pipelineCacheStore.save();
+
+    size_t dataSize;
+    EXPECT_EQ(vkGetPipelineCacheData(mDevice, workerCache, &dataSize, nullptr), VK_SUCCESS);
+    EXPECT_TRUE(VkPipelineCacheStore::validate(readFile(mPath), mPhysicalDeviceProperties));
+
+    // 워커 캐시는 메인 캐시의 내용으로 시작하므로 같은 장치의 헤더를 가진다.
+    vector<uint8_t> workerData(dataSize);
+    EXPECT_EQ(vkGetPipelineCacheData(mDevice, workerCache, &dataSize, workerData.data()), VK_SUCCESS);
+    workerData.resize(dataSize);
+    EXPECT_TRUE(VkPipelineCacheStore::validate(workerData, mPhysicalDeviceProperties));
+}
+
+TEST_F(PipelineCacheStoreDevice, staleFileStartsCold) {
+    auto otherDriver = mPhysicalDeviceProperties;
+    otherDriver.pipelineCacheUUID[0] ^= 0xff;
+
+    auto data = makeCacheData(otherDriver);
+    ofstream(mPath, ios::binary).write(reinterpret_cast<const char *>(data.data()),
+                                       static_cast<streamsize>(data.size()));
+
+    VkPipelineCacheStore pipelineCacheStore(mDevice, mPhysicalDeviceProperties, mPath);
+    EXPECT_FALSE(pipelineCacheStore.isWarm());
+}
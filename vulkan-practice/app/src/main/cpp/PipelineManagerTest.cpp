@@ -0,0 +1,266 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <unordered_set>
+#include <gtest/gtest.h>
+
+#include "VkPipelineManager.h"
+
+using namespace std;
+
+namespace {
+
+// 장치 없이 테스트하므로 파이프라인은 값만 구분되는 가짜 핸들이다.
+VkPipeline makePipeline(uint64_t value) {
+    return (VkPipeline) value;
+}
+
+VkPipelineKey makeKey(VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST) {
+    VkPipelineKey key{
+            .vertexShader = VK_NULL_HANDLE,
+            .fragmentShader = VK_NULL_HANDLE,
+            .renderPass = VK_NULL_HANDLE,
+            .subpass = 0,
+            .colorFormat = VK_FORMAT_R8G8B8A8_UNORM,
+            .vertexLayout = 0,
+            .state = {}
+    };
+    key.state.topology = topology;
+    return key;
+}
+
+// 만든 순서대로 1부터 번호를 붙인 가짜 파이프라인을 반환한다.
+VkPipelineKeyCreateFunction countingCreateFunction(atomic<uint64_t> *createCount) {
+    return [createCount](const VkPipelineKey &, VkPipelineCache, VkPipeline *pipeline) {
+        *pipeline = makePipeline(0x1000 + ++*createCount);
+        return VK_SUCCESS;
+    };
+}
+
+const auto kFallbackPipeline = makePipeline(0x100);
+
+// 삼각형 종류의 fallback을 가진 매니저를 만든다.
+void setTriangleFallback(VkPipelineManager *pipelineManager) {
+    auto fallbackKey = makeKey();
+    fallbackKey.state.blendMode = VK_BLEND_MODE_ADDITIVE;
+    pipelineManager->insert(fallbackKey, kFallbackPipeline);
+    pipelineManager->setFallback(fallbackKey);
+}
+
+} // namespace
+
+TEST(PipelineManager, keyHash) {
+    VkPipelineKey key{
+            .vertexShader = VK_NULL_HANDLE,
+            .fragmentShader = VK_NULL_HANDLE,
+            .renderPass = VK_NULL_HANDLE,
+            .subpass = 0,
+            .colorFormat = VK_FORMAT_R8G8B8A8_UNORM,
+            .vertexLayout = 0,
+            .state = {}
+    };
+    VkPipelineKeyHash hash;
+
+    // 같은 상태이면 따로 만들어도 같은 키다.
+    auto sameKey = key;
+    EXPECT_EQ(key, sameKey);
+    EXPECT_EQ(hash(key), hash(sameKey));
+
+    // 상태가 하나라도 다르면 다른 키가 되고, 해시도 서로 달라야 샤드와 버킷이 고르게 나뉜다.
+    vector<VkPipelineKey> keys{key};
+    keys.push_back(key);
+    keys.back().state.blendMode = VK_BLEND_MODE_ALPHA;
+    keys.push_back(key);
+    keys.back().state.blendMode = VK_BLEND_MODE_ADDITIVE;
+    keys.push_back(key);
+    keys.back().state.cullMode = VK_CULL_MODE_BACK_BIT;
+    keys.push_back(key);
+    keys.back().state.depthTest = true;
+    keys.push_back(key);
+    keys.back().state.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+    keys.push_back(key);
+    keys.back().vertexLayout = 1;
+    keys.push_back(key);
+    keys.back().colorFormat = VK_FORMAT_B8G8R8A8_UNORM;
+
+    unordered_set<size_t> hashes;
+    for (auto i = 0; i != keys.size(); ++i) {
+        for (auto j = i + 1; j != keys.size(); ++j) {
+            EXPECT_FALSE(keys[i] == keys[j]);
+        }
+        hashes.insert(hash(keys[i]));
+    }
+    EXPECT_EQ(hashes.size(), keys.size());
+}
+
+TEST(PipelineManager, missReturnsFallback) {
+    atomic<uint64_t> createCount{0};
+    VkPipelineManager pipelineManager(VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, {},
+                                      countingCreateFunction(&createCount));
+    setTriangleFallback(&pipelineManager);
+
+    // 처음 요청하면 만드는 동안 fallback으로 그린다.
+    auto key = makeKey();
+    EXPECT_EQ(pipelineManager.request(key), kFallbackPipeline);
+
+    // 만들어진 후에는 그 파이프라인을 반환한다.
+    pipelineManager.waitIdle();
+    auto pipeline = pipelineManager.request(key);
+    EXPECT_NE(pipeline, kFallbackPipeline);
+    EXPECT_NE(pipeline, VK_NULL_HANDLE);
+    EXPECT_EQ(createCount, 1);
+
+    auto stats = pipelineManager.stats();
+    EXPECT_EQ(stats.missCount, 1);
+    EXPECT_EQ(stats.fallbackCount, 1);
+    EXPECT_EQ(stats.hitCount, 1);
+    EXPECT_EQ(stats.pipelineCount, 2); // fallback을 포함한다.
+    EXPECT_EQ(stats.pendingCount, 0);
+}
+
+TEST(PipelineManager, failedKeyKeepsFallback) {
+    atomic<uint64_t> createCount{0};
+    VkPipelineManager pipelineManager(VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, {},
+                                      [&createCount](const VkPipelineKey &, VkPipelineCache, VkPipeline *) {
+                                          ++createCount;
+                                          return VK_ERROR_INITIALIZATION_FAILED;
+                                      });
+    setTriangleFallback(&pipelineManager);
+
+    auto key = makeKey();
+    EXPECT_EQ(pipelineManager.request(key), kFallbackPipeline);
+    pipelineManager.waitIdle();
+
+    // 실패한 키는 다시 만들지 않고 계속 fallback을 반환한다.
+    for (auto i = 0; i != 3; ++i) {
+        EXPECT_EQ(pipelineManager.request(key), kFallbackPipeline);
+    }
+    pipelineManager.waitIdle();
+    EXPECT_EQ(createCount, 1);
+
+    auto stats = pipelineManager.stats();
+    EXPECT_EQ(stats.failureCount, 1);
+    EXPECT_EQ(stats.missCount, 1);
+    EXPECT_EQ(stats.fallbackCount, 4);
+    EXPECT_EQ(stats.pipelineCount, 1); // fallback만 있다.
+}
+
+TEST(PipelineManager, noFallbackOfSameTopologyClass) {
+    atomic<uint64_t> createCount{0};
+    VkPipelineManager pipelineManager(VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, {},
+                                      countingCreateFunction(&createCount));
+    setTriangleFallback(&pipelineManager);
+
+    // 삼각형 fallback으로 선을 그리면 안 되므로 그리지 않는다.
+    EXPECT_EQ(pipelineManager.request(makeKey(VK_PRIMITIVE_TOPOLOGY_LINE_LIST)), VK_NULL_HANDLE);
+    EXPECT_EQ(pipelineManager.stats().skipCount, 1);
+
+    // 같은 종류인 triangle strip에는 fallback을 사용한다.
+    EXPECT_EQ(pipelineManager.request(makeKey(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP)), kFallbackPipeline);
+    pipelineManager.waitIdle();
+
+    auto stats = pipelineManager.stats();
+    EXPECT_EQ(stats.skipCount, 1);
+    EXPECT_EQ(stats.fallbackCount, 1);
+}
+
+TEST(PipelineManager, normalizeDynamicState) {
+    auto key = makeKey(VK_PRIMITIVE_TOPOLOGY_LINE_LIST);
+    auto dynamicKey = makeKey(VK_PRIMITIVE_TOPOLOGY_LINE_STRIP);
+    dynamicKey.state.cullMode = VK_CULL_MODE_BACK_BIT;
+    dynamicKey.state.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    dynamicKey.state.depthCompareOp = VK_COMPARE_OP_GREATER;
+    dynamicKey.state.depthTest = true;
+    dynamicKey.state.depthWrite = true;
+
+    // extended dynamic state를 사용하면 동적 상태만 다른 키는 같은 파이프라인을 사용한다.
+    {
+        atomic<uint64_t> createCount{0};
+        VkPipelineManager pipelineManager(VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE,
+                                          {.dynamicRendering = false, .extendedDynamicState = true},
+                                          countingCreateFunction(&createCount));
+        pipelineManager.request(key);
+        pipelineManager.waitIdle();
+
+        EXPECT_EQ(pipelineManager.request(dynamicKey), pipelineManager.request(key));
+        EXPECT_EQ(createCount, 1);
+        EXPECT_EQ(pipelineManager.stats().missCount, 1);
+
+        // 블렌딩은 동적 상태가 아니므로 다른 파이프라인이다.
+        auto blendKey = key;
+        blendKey.state.blendMode = VK_BLEND_MODE_ALPHA;
+        pipelineManager.request(blendKey);
+        pipelineManager.waitIdle();
+        EXPECT_EQ(pipelineManager.stats().missCount, 2);
+    }
+
+    // 사용하지 않으면 모두 다른 파이프라인이다.
+    {
+        atomic<uint64_t> createCount{0};
+        VkPipelineManager pipelineManager(VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE,
+                                          {.dynamicRendering = false, .extendedDynamicState = false},
+                                          countingCreateFunction(&createCount));
+        pipelineManager.request(key);
+        pipelineManager.request(dynamicKey);
+        pipelineManager.waitIdle();
+
+        EXPECT_NE(pipelineManager.request(dynamicKey), pipelineManager.request(key));
+        EXPECT_EQ(createCount, 2);
+    }
+}
+
+TEST(PipelineManager, waitIdle) {
+    promise<void> release;
+    auto released = release.get_future().share();
+    VkPipelineManager pipelineManager(VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, {},
+                                      [released](const VkPipelineKey &, VkPipelineCache, VkPipeline *pipeline) {
+                                          released.wait();
+                                          *pipeline = makePipeline(0x1000);
+                                          return VK_SUCCESS;
+                                      });
+
+    auto key = makeKey();
+    for (auto blendMode : {VK_BLEND_MODE_OPAQUE, VK_BLEND_MODE_ALPHA, VK_BLEND_MODE_ADDITIVE}) {
+        key.state.blendMode = blendMode;
+        pipelineManager.request(key);
+    }
+    EXPECT_EQ(pipelineManager.stats().pendingCount, 3);
+
+    // 만들기가 끝나지 않았으면 기다린다.
+    atomic<bool> idle{false};
+    thread waiter([&] {
+        pipelineManager.waitIdle();
+        idle = true;
+    });
+    this_thread::sleep_for(chrono::milliseconds(20));
+    EXPECT_FALSE(idle);
+
+    release.set_value();
+    waiter.join();
+    EXPECT_TRUE(idle);
+    EXPECT_EQ(pipelineManager.stats().pendingCount, 0);
+    EXPECT_EQ(pipelineManager.stats().pipelineCount, 3);
+}
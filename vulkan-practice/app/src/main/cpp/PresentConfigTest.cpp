@@ -0,0 +1,78 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "VkPresentConfig.h"
+
+using namespace std;
+
+TEST(PresentConfig, presentModeFallback) {
+    const vector<VkPresentModeKHR> fifoOnly{VK_PRESENT_MODE_FIFO_KHR};
+    const vector<VkPresentModeKHR> fifoAndMailbox{VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+    const vector<VkPresentModeKHR> fifoAndImmediate{VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR};
+
+    EXPECT_EQ(vkChoosePresentMode(VK_PRESENT_MODE_MAILBOX_KHR, fifoAndMailbox), VK_PRESENT_MODE_MAILBOX_KHR);
+    EXPECT_EQ(vkChoosePresentMode(VK_PRESENT_MODE_MAILBOX_KHR, fifoOnly), VK_PRESENT_MODE_FIFO_KHR);
+    // 티어링이 생기지 않도록 MAILBOX는 IMMEDIATE로 대체하지 않는다.
+    EXPECT_EQ(vkChoosePresentMode(VK_PRESENT_MODE_MAILBOX_KHR, fifoAndImmediate), VK_PRESENT_MODE_FIFO_KHR);
+    EXPECT_EQ(vkChoosePresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR, fifoAndMailbox), VK_PRESENT_MODE_MAILBOX_KHR);
+    EXPECT_EQ(vkChoosePresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR, fifoAndImmediate), VK_PRESENT_MODE_IMMEDIATE_KHR);
+    EXPECT_EQ(vkChoosePresentMode(VK_PRESENT_MODE_FIFO_RELAXED_KHR, fifoOnly), VK_PRESENT_MODE_FIFO_KHR);
+}
+
+TEST(PresentConfig, imageCount) {
+    VkSurfaceCapabilitiesKHR surfaceCapabilities{
+            .minImageCount = 2,
+            .maxImageCount = 3
+    };
+
+    EXPECT_EQ(vkChooseSwapchainImageCount({}, VK_PRESENT_MODE_FIFO_KHR, surfaceCapabilities), 2);
+    EXPECT_EQ(vkChooseSwapchainImageCount({}, VK_PRESENT_MODE_MAILBOX_KHR, surfaceCapabilities), 3);
+    // surface가 허용하는 범위로 제한한다.
+    EXPECT_EQ(vkChooseSwapchainImageCount({.imageCount = 1}, VK_PRESENT_MODE_FIFO_KHR, surfaceCapabilities), 2);
+    EXPECT_EQ(vkChooseSwapchainImageCount({.imageCount = 8}, VK_PRESENT_MODE_FIFO_KHR, surfaceCapabilities), 3);
+
+    // maxImageCount가 0이면 제한이 없다.
+    surfaceCapabilities.maxImageCount = 0;
+    EXPECT_EQ(vkChooseSwapchainImageCount({.imageCount = 8}, VK_PRESENT_MODE_FIFO_KHR, surfaceCapabilities), 8);
+}
+
+TEST(PresentConfig, swapchainExtent) {
+    VkSurfaceCapabilitiesKHR surfaceCapabilities{
+            .currentExtent = {1080, 2400},
+            .minImageExtent = {1, 1},
+            .maxImageExtent = {4096, 4096}
+    };
+
+    // surface가 크기를 정하면 창의 크기와 상관없이 그 크기를 사용한다.
+    EXPECT_EQ(vkChooseSwapchainExtent(surfaceCapabilities, {720, 1280}).width, 1080);
+    EXPECT_EQ(vkChooseSwapchainExtent(surfaceCapabilities, {720, 1280}).height, 2400);
+
+    // 0xFFFFFFFF이면 창의 크기를 허용 범위로 제한해서 사용한다.
+    surfaceCapabilities.currentExtent = {UINT32_MAX, UINT32_MAX};
+    EXPECT_EQ(vkChooseSwapchainExtent(surfaceCapabilities, {720, 1280}).width, 720);
+    EXPECT_EQ(vkChooseSwapchainExtent(surfaceCapabilities, {720, 1280}).height, 1280);
+    EXPECT_EQ(vkChooseSwapchainExtent(surfaceCapabilities, {8192, 0}).width, 4096);
+    EXPECT_EQ(vkChooseSwapchainExtent(surfaceCapabilities, {8192, 0}).height, 1);
+}
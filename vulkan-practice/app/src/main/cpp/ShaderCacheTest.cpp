@@ -0,0 +1,136 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "VkShaderCache.h"
+
+using namespace std;
+
+namespace {
+
+constexpr string_view kVertexShaderCode{
+        "#version 310 es\n"
+        "void main() {\n"
+        "    gl_Position = vec4(0.0);\n"
+        "}\n"
+};
+
+class ShaderCacheTest : public testing::Test {
+protected:
+    void SetUp() override {
+        mDirectory = testing::TempDir() + "shader_cache_test_" + to_string(getpid());
+    }
+
+    void TearDown() override {
+        auto path = mDirectory + "/" + filename();
+        remove(path.c_str());
+        rmdir(mDirectory.c_str());
+    }
+
+    static string filename() {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.spv", static_cast<unsigned long long>(
+                VkShaderCache::makeKey(kVertexShaderCode, VK_SHADER_TYPE_VERTEX, {})));
+        return name;
+    }
+
+    string mDirectory;
+};
+
+} // namespace
+
+TEST_F(ShaderCacheTest, memoryHit) {
+    VkShaderCache shaderCache;
+
+    vector<uint32_t> first, second;
+    ASSERT_EQ(shaderCache.compile(kVertexShaderCode, VK_SHADER_TYPE_VERTEX, {}, &first), VK_SUCCESS);
+    ASSERT_EQ(shaderCache.compile(kVertexShaderCode, VK_SHADER_TYPE_VERTEX, {}, &second), VK_SUCCESS);
+    EXPECT_EQ(first, second);
+
+    auto stats = shaderCache.stats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.memoryHits, 1);
+    EXPECT_EQ(stats.diskHits, 0);
+    EXPECT_GT(stats.compileTime.count(), 0);
+}
+
+TEST_F(ShaderCacheTest, diskHit) {
+    vector<uint32_t> compiled;
+    {
+        VkShaderCache shaderCache(mDirectory);
+        ASSERT_EQ(shaderCache.compile(kVertexShaderCode, VK_SHADER_TYPE_VERTEX, {}, &compiled),
+                  VK_SUCCESS);
+        EXPECT_EQ(shaderCache.stats().misses, 1);
+    }
+
+    // 새로 시작한 것처럼 메모리 캐시가 비어있어도 디스크에서 가져와야 한다.
+    VkShaderCache shaderCache(mDirectory);
+    vector<uint32_t> cached;
+    ASSERT_EQ(shaderCache.compile(kVertexShaderCode, VK_SHADER_TYPE_VERTEX, {}, &cached), VK_SUCCESS);
+    EXPECT_EQ(compiled, cached);
+
+    auto stats = shaderCache.stats();
+    EXPECT_EQ(stats.misses, 0);
+    EXPECT_EQ(stats.diskHits, 1);
+    EXPECT_EQ(stats.compileTime.count(), 0);
+}
+
+TEST_F(ShaderCacheTest, corruptedFile) {
+    {
+        VkShaderCache shaderCache(mDirectory);
+        vector<uint32_t> compiled;
+        ASSERT_EQ(shaderCache.compile(kVertexShaderCode, VK_SHADER_TYPE_VERTEX, {}, &compiled),
+                  VK_SUCCESS);
+    }
+
+    // 파일이 잘린 경우 사용하지 않고 다시 컴파일해야 한다.
+    auto path = mDirectory + "/" + filename();
+    ASSERT_EQ(truncate(path.c_str(), 20), 0);
+
+    VkShaderCache shaderCache(mDirectory);
+    vector<uint32_t> recompiled;
+    ASSERT_EQ(shaderCache.compile(kVertexShaderCode, VK_SHADER_TYPE_VERTEX, {}, &recompiled),
+              VK_SUCCESS);
+    EXPECT_FALSE(recompiled.empty());
+    EXPECT_EQ(shaderCache.stats().misses, 1);
+    EXPECT_EQ(shaderCache.stats().diskHits, 0);
+}
+
+TEST(ShaderCacheKey, distinguishesInputs) {
+    auto key = VkShaderCache::makeKey(kVertexShaderCode, VK_SHADER_TYPE_VERTEX, {});
+    EXPECT_EQ(key, VkShaderCache::makeKey(kVertexShaderCode, VK_SHADER_TYPE_VERTEX, {}));
+
+    EXPECT_NE(key, VkShaderCache::makeKey(kVertexShaderCode, VK_SHADER_TYPE_FRAGMENT, {}));
+    EXPECT_NE(key, VkShaderCache::makeKey(kVertexShaderCode, VK_SHADER_TYPE_VERTEX,
+                                          {.optimize = true}));
+    EXPECT_NE(key, VkShaderCache::makeKey(kVertexShaderCode, VK_SHADER_TYPE_VERTEX,
+                                          {.macroDefinitions = {{"FOO", "1"}}}));
+    EXPECT_NE(key, VkShaderCache::makeKey("#version 310 es\nvoid main() {}\n",
+                                          VK_SHADER_TYPE_VERTEX, {}));
+}
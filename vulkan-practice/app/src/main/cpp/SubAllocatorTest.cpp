@@ -0,0 +1,143 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include "VkSubAllocator.h"
+
+using namespace std;
+
+TEST(LinearSubAllocator, alignmentAndReset) {
+    VkLinearSubAllocator subAllocator(1024);
+
+    VkDeviceSize first, second;
+    ASSERT_TRUE(subAllocator.allocate(100, 16, &first));
+    ASSERT_TRUE(subAllocator.allocate(100, 256, &second));
+    EXPECT_EQ(first, 0);
+    EXPECT_EQ(second, 256);
+    EXPECT_EQ(subAllocator.usedSize(), 356);
+
+    VkDeviceSize third;
+    EXPECT_FALSE(subAllocator.allocate(1024, 1, &third));
+
+    // 모두 해제되어야 처음부터 다시 사용할 수 있다.
+    subAllocator.free(first);
+    EXPECT_EQ(subAllocator.largestFreeRange(), 1024 - 356);
+    subAllocator.free(second);
+    EXPECT_TRUE(subAllocator.empty());
+    EXPECT_EQ(subAllocator.largestFreeRange(), 1024);
+}
+
+TEST(BuddySubAllocator, splitAndMerge) {
+    VkBuddySubAllocator subAllocator(4096);
+
+    VkDeviceSize first, second, third;
+    ASSERT_TRUE(subAllocator.allocate(100, 4, &first));   // 256 블록
+    ASSERT_TRUE(subAllocator.allocate(300, 4, &second));  // 512 블록
+    ASSERT_TRUE(subAllocator.allocate(1024, 1024, &third));
+    EXPECT_EQ(first % 256, 0);
+    EXPECT_EQ(second % 512, 0);
+    EXPECT_EQ(third % 1024, 0);
+    EXPECT_EQ(subAllocator.usedSize(), 256 + 512 + 1024);
+
+    subAllocator.free(first);
+    subAllocator.free(second);
+    subAllocator.free(third);
+
+    // 모든 buddy가 합쳐져서 전체 크기의 블록이 다시 만들어져야 한다.
+    EXPECT_TRUE(subAllocator.empty());
+    EXPECT_EQ(subAllocator.largestFreeRange(), 4096);
+
+    VkDeviceSize whole;
+    EXPECT_TRUE(subAllocator.allocate(4096, 1, &whole));
+    EXPECT_EQ(whole, 0);
+}
+
+TEST(BuddySubAllocator, roundsDownToPowerOfTwo) {
+    VkBuddySubAllocator subAllocator(3000);
+    EXPECT_EQ(subAllocator.size(), 2048);
+
+    VkDeviceSize offset;
+    EXPECT_FALSE(subAllocator.allocate(2049, 1, &offset));
+}
+
+TEST(FreeListSubAllocator, alignmentPadding) {
+    VkFreeListSubAllocator subAllocator(1024);
+
+    VkDeviceSize first, second;
+    ASSERT_TRUE(subAllocator.allocate(10, 1, &first));
+    ASSERT_TRUE(subAllocator.allocate(10, 64, &second));
+    EXPECT_EQ(first, 0);
+    EXPECT_EQ(second, 64);
+    EXPECT_EQ(subAllocator.usedSize(), 74); // 정렬 여백도 사용중으로 센다.
+
+    subAllocator.free(second);
+    EXPECT_EQ(subAllocator.usedSize(), 10);
+    EXPECT_EQ(subAllocator.largestFreeRange(), 1014);
+}
+
+TEST(FreeListSubAllocator, bestFitAndCoalesce) {
+    VkFreeListSubAllocator subAllocator(1000);
+
+    VkDeviceSize a, b, c, d;
+    ASSERT_TRUE(subAllocator.allocate(100, 1, &a));
+    ASSERT_TRUE(subAllocator.allocate(300, 1, &b));
+    ASSERT_TRUE(subAllocator.allocate(100, 1, &c));
+    ASSERT_TRUE(subAllocator.allocate(500, 1, &d));
+    EXPECT_EQ(subAllocator.largestFreeRange(), 0);
+
+    // 100과 300 크기의 구멍을 만든다.
+    subAllocator.free(a);
+    subAllocator.free(b);
+    EXPECT_EQ(subAllocator.largestFreeRange(), 400); // 이웃한 빈 공간은 합쳐진다.
+
+    subAllocator.free(d);
+    VkDeviceSize e;
+    ASSERT_TRUE(subAllocator.allocate(450, 1, &e));
+    EXPECT_EQ(e, 500); // 400짜리 공간에는 들어가지 않는다.
+
+    VkDeviceSize f;
+    ASSERT_TRUE(subAllocator.allocate(350, 1, &f));
+    EXPECT_EQ(f, 0);
+
+    subAllocator.free(c);
+    subAllocator.free(e);
+    subAllocator.free(f);
+    EXPECT_TRUE(subAllocator.empty());
+    EXPECT_EQ(subAllocator.largestFreeRange(), 1000);
+}
+
+TEST(FreeListSubAllocator, picksSmallestFittingRange) {
+    VkFreeListSubAllocator subAllocator(1000);
+
+    VkDeviceSize a, b, c, d;
+    ASSERT_TRUE(subAllocator.allocate(300, 1, &a));
+    ASSERT_TRUE(subAllocator.allocate(100, 1, &b));
+    ASSERT_TRUE(subAllocator.allocate(100, 1, &c));
+    ASSERT_TRUE(subAllocator.allocate(500, 1, &d));
+    subAllocator.free(a); // [0, 300) 빈 공간
+    subAllocator.free(c); // [400, 500) 빈 공간
+
+    VkDeviceSize e;
+    ASSERT_TRUE(subAllocator.allocate(80, 1, &e));
+    EXPECT_EQ(e, 400);
+}
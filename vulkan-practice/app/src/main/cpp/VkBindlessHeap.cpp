@@ -0,0 +1,308 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+#include "VkBindlessHeap.h"
+#include "VkUtil.h"
+
+using namespace std;
+
+uint32_t VkIndexAllocator::allocate() {
+    if (!mFreeIndices.empty()) {
+        auto index = mFreeIndices.back();
+        mFreeIndices.pop_back();
+        return index;
+    }
+
+    if (mNextIndex == mCapacity) {
+        return kInvalidBindlessIndex;
+    }
+    return mNextIndex++;
+}
+
+void VkIndexAllocator::free(uint32_t index) {
+    assert(index < mNextIndex);
+    assert(find(mFreeIndices.begin(), mFreeIndices.end(), index) == mFreeIndices.end());
+
+    mFreeIndices.push_back(index);
+}
+
+VkBindlessHeap::VkBindlessHeap(VkDevice device, VkPhysicalDevice physicalDevice, VkDeletionQueue *deletionQueue)
+        : mDevice(device),
+          mDeletionQueue(deletionQueue),
+          mSampledImageIndices(0),
+          mStorageBufferIndices(0) {
+    // ================================================================================
+    // 1. 배열의 크기 결정
+    // ================================================================================
+    // UPDATE_AFTER_BIND로 사용할 수 있는 descriptor의 수는 일반 한도와 따로 정해져 있다.
+    VkPhysicalDeviceDescriptorIndexingProperties descriptorIndexingProperties{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES
+    };
+
+    VkPhysicalDeviceProperties2 physicalDeviceProperties{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &descriptorIndexingProperties
+    };
+    vkGetPhysicalDeviceProperties2(physicalDevice, &physicalDeviceProperties);
+
+    auto sampledImageCount = min({kMaxSampledImages,
+                                  descriptorIndexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+                                  descriptorIndexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages});
+    auto storageBufferCount = min({kMaxStorageBuffers,
+                                   descriptorIndexingProperties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+                                   descriptorIndexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers});
+    mSampledImageIndices = VkIndexAllocator(sampledImageCount);
+    mStorageBufferIndices = VkIndexAllocator(storageBufferCount);
+
+    // ================================================================================
+    // 2. 모든 텍스처가 함께 사용하는 VkSampler 생성
+    // ================================================================================
+    VkSamplerCreateInfo samplerCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+            .magFilter = VK_FILTER_LINEAR,
+            .minFilter = VK_FILTER_LINEAR,
+            .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+            .addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+            .addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+            .addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+            .maxLod = VK_LOD_CLAMP_NONE
+    };
+
+    VK_CHECK_ERROR(vkCreateSampler(mDevice, &samplerCreateInfo, nullptr, &mSampler));
+
+    // ================================================================================
+    // 3. VkDescriptorSetLayout 생성
+    // ================================================================================
+    array<VkDescriptorSetLayoutBinding, 3> descriptorSetLayoutBindings{
+            VkDescriptorSetLayoutBinding{
+                    .binding = kSampledImageBinding,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                    .descriptorCount = sampledImageCount,
+                    .stageFlags = VK_SHADER_STAGE_ALL
+            },
+            VkDescriptorSetLayoutBinding{
+                    .binding = kStorageBufferBinding,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = storageBufferCount,
+                    .stageFlags = VK_SHADER_STAGE_ALL
+            },
+            VkDescriptorSetLayoutBinding{
+                    .binding = kSamplerBinding,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_ALL,
+                    .pImmutableSamplers = &mSampler
+            }
+    };
+
+    // 배열의 모든 원소를 채우지 않아도 되고(PARTIALLY_BOUND), 바인드된 후에도 갱신할 수 있다(UPDATE_AFTER_BIND).
+    constexpr VkDescriptorBindingFlags kArrayBindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                                            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+    array<VkDescriptorBindingFlags, 3> descriptorBindingFlags{
+            kArrayBindingFlags,
+            kArrayBindingFlags,
+            0
+    };
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo descriptorSetLayoutBindingFlagsCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+            .bindingCount = static_cast<uint32_t>(descriptorBindingFlags.size()),
+            .pBindingFlags = descriptorBindingFlags.data()
+    };
+
+    VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext = &descriptorSetLayoutBindingFlagsCreateInfo,
+            .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+            .bindingCount = static_cast<uint32_t>(descriptorSetLayoutBindings.size()),
+            .pBindings = descriptorSetLayoutBindings.data()
+    };
+
+    VK_CHECK_ERROR(vkCreateDescriptorSetLayout(mDevice,
+                                               &descriptorSetLayoutCreateInfo,
+                                               nullptr,
+                                               &mDescriptorSetLayout));
+
+    // ================================================================================
+    // 4. VkDescriptorPool 생성, VkDescriptorSet 할당
+    // ================================================================================
+    array<VkDescriptorPoolSize, 3> descriptorPoolSizes{
+            VkDescriptorPoolSize{
+                    .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                    .descriptorCount = sampledImageCount
+            },
+            VkDescriptorPoolSize{
+                    .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = storageBufferCount
+            },
+            VkDescriptorPoolSize{
+                    .type = VK_DESCRIPTOR_TYPE_SAMPLER,
+                    .descriptorCount = 1
+            }
+    };
+
+    VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+            .maxSets = 1,
+            .poolSizeCount = static_cast<uint32_t>(descriptorPoolSizes.size()),
+            .pPoolSizes = descriptorPoolSizes.data()
+    };
+
+    VK_CHECK_ERROR(vkCreateDescriptorPool(mDevice, &descriptorPoolCreateInfo, nullptr, &mDescriptorPool));
+
+    VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool = mDescriptorPool,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &mDescriptorSetLayout
+    };
+
+    VK_CHECK_ERROR(vkAllocateDescriptorSets(mDevice, &descriptorSetAllocateInfo, &mDescriptorSet));
+}
+
+VkBindlessHeap::~VkBindlessHeap() {
+    // VkDescriptorPool을 파괴하면 할당된 VkDescriptorSet도 함께 해제된다.
+    vkDestroyDescriptorPool(mDevice, mDescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(mDevice, mDescriptorSetLayout, nullptr);
+    vkDestroySampler(mDevice, mSampler, nullptr);
+}
+
+uint32_t VkBindlessHeap::addSampledImage(VkImageView imageView, VkImageLayout imageLayout) {
+    lock_guard<mutex> lock(mMutex);
+
+    auto index = mSampledImageIndices.allocate();
+    if (index == kInvalidBindlessIndex) {
+        return index;
+    }
+
+    VkDescriptorImageInfo descriptorImageInfo{
+            .imageView = imageView,
+            .imageLayout = imageLayout
+    };
+
+    VkWriteDescriptorSet writeDescriptorSet{
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = mDescriptorSet,
+            .dstBinding = kSampledImageBinding,
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .pImageInfo = &descriptorImageInfo
+    };
+
+    vkUpdateDescriptorSets(mDevice, 1, &writeDescriptorSet, 0, nullptr);
+    return index;
+}
+
+uint32_t VkBindlessHeap::addStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+    lock_guard<mutex> lock(mMutex);
+
+    auto index = mStorageBufferIndices.allocate();
+    if (index == kInvalidBindlessIndex) {
+        return index;
+    }
+
+    VkDescriptorBufferInfo descriptorBufferInfo{
+            .buffer = buffer,
+            .offset = offset,
+            .range = range
+    };
+
+    VkWriteDescriptorSet writeDescriptorSet{
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = mDescriptorSet,
+            .dstBinding = kStorageBufferBinding,
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo = &descriptorBufferInfo
+    };
+
+    vkUpdateDescriptorSets(mDevice, 1, &writeDescriptorSet, 0, nullptr);
+    return index;
+}
+
+void VkBindlessHeap::removeSampledImage(uint32_t index) {
+    // 진행중인 프레임의 셰이더가 아직 이 인덱스를 읽을 수 있으므로 그 프레임이 끝난 후에 다시 사용한다.
+    mDeletionQueue->push([this, index] {
+        lock_guard<mutex> lock(mMutex);
+        mSampledImageIndices.free(index);
+    });
+}
+
+void VkBindlessHeap::removeStorageBuffer(uint32_t index) {
+    mDeletionQueue->push([this, index] {
+        lock_guard<mutex> lock(mMutex);
+        mStorageBufferIndices.free(index);
+    });
+}
+
+void VkBindlessHeap::bind(VkCommandBuffer commandBuffer,
+                          VkPipelineLayout pipelineLayout,
+                          VkPipelineBindPoint bindPoint) const {
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, 0, 1, &mDescriptorSet, 0, nullptr);
+}
+
+uint32_t VkBindlessHeap::sampledImageCount() const {
+    lock_guard<mutex> lock(mMutex);
+    return mSampledImageIndices.size();
+}
+
+uint32_t VkBindlessHeap::storageBufferCount() const {
+    lock_guard<mutex> lock(mMutex);
+    return mStorageBufferIndices.size();
+}
+
+bool vkSupportsBindless(VkPhysicalDevice physicalDevice) {
+    VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES
+    };
+
+    VkPhysicalDeviceFeatures2 physicalDeviceFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &descriptorIndexingFeatures
+    };
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &physicalDeviceFeatures);
+
+    return descriptorIndexingFeatures.runtimeDescriptorArray &&
+           descriptorIndexingFeatures.descriptorBindingPartiallyBound &&
+           descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing &&
+           descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+           descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind;
+}
+
+VkPhysicalDeviceDescriptorIndexingFeatures vkBindlessFeatures(void *next) {
+    return {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+            .pNext = next,
+            .shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+            .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+            .descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE,
+            .descriptorBindingPartiallyBound = VK_TRUE,
+            .runtimeDescriptorArray = VK_TRUE
+    };
+}
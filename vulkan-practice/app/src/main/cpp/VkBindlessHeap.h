@@ -0,0 +1,117 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKBINDLESSHEAP_H
+#define PRACTICE_VULKAN_VKBINDLESSHEAP_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "VkDeletionQueue.h"
+
+// 사용할 수 있는 인덱스가 없을 때 반환된다.
+constexpr uint32_t kInvalidBindlessIndex = UINT32_MAX;
+
+// 0부터 capacity - 1까지의 인덱스를 나눠준다. 해제된 인덱스를 먼저 다시 사용해서 배열의 앞쪽을 채운다.
+class VkIndexAllocator {
+public:
+    explicit VkIndexAllocator(uint32_t capacity) : mCapacity(capacity) {}
+
+    // 남은 인덱스가 없으면 kInvalidBindlessIndex를 반환한다.
+    uint32_t allocate();
+
+    void free(uint32_t index);
+
+    uint32_t capacity() const { return mCapacity; }
+
+    // 할당되어 있는 인덱스의 수.
+    uint32_t size() const { return mNextIndex - static_cast<uint32_t>(mFreeIndices.size()); }
+
+private:
+    uint32_t mCapacity;
+    uint32_t mNextIndex{0};             // 한 번도 할당되지 않은 첫 번째 인덱스
+    std::vector<uint32_t> mFreeIndices; // 해제되어 다시 사용할 수 있는 인덱스
+};
+
+// VK_EXT_descriptor_indexing(Vulkan 1.2)을 사용하는 bindless 리소스 모델.
+// 모든 텍스처와 스토리지 버퍼를 하나의 VkDescriptorSet의 큰 배열에 넣어두고, 셰이더는 인덱스로 접근한다.
+// VkDescriptorSet은 command buffer마다 한 번만 바인드하고 그리기마다 바꾸지 않는다.
+// UPDATE_AFTER_BIND로 만들었기 때문에 바인드된 후에도 사용하지 않는 배열 원소는 갱신할 수 있다.
+//
+//   set 0, binding 0: sampled image 배열
+//   set 0, binding 1: storage buffer 배열
+//   set 0, binding 2: 모든 텍스처가 함께 사용하는 sampler (immutable)
+class VkBindlessHeap {
+public:
+    static constexpr uint32_t kSampledImageBinding = 0;
+    static constexpr uint32_t kStorageBufferBinding = 1;
+    static constexpr uint32_t kSamplerBinding = 2;
+
+    // 장치가 지원하는 것보다 크면 장치의 최대값으로 줄인다.
+    static constexpr uint32_t kMaxSampledImages = 4096;
+    static constexpr uint32_t kMaxStorageBuffers = 4096;
+
+    // 장치에 필요한 기능이 활성화되어 있어야 한다. vkBindlessFeatures를 참고한다.
+    VkBindlessHeap(VkDevice device, VkPhysicalDevice physicalDevice, VkDeletionQueue *deletionQueue);
+    ~VkBindlessHeap();
+
+    VkBindlessHeap(const VkBindlessHeap &) = delete;
+    VkBindlessHeap &operator=(const VkBindlessHeap &) = delete;
+
+    // 배열에 추가하고 셰이더에서 사용할 인덱스를 반환한다. 배열이 가득 차면 kInvalidBindlessIndex를 반환한다.
+    uint32_t addSampledImage(VkImageView imageView, VkImageLayout imageLayout);
+    uint32_t addStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+
+    // 제출된 작업이 모두 끝난 후에 인덱스를 다시 사용할 수 있게 된다. 리소스는 호출하는 쪽에서 파괴한다.
+    void removeSampledImage(uint32_t index);
+    void removeStorageBuffer(uint32_t index);
+
+    // command buffer에 한 번 바인드하면 이 파이프라인 레이아웃을 사용하는 모든 그리기에서 사용할 수 있다.
+    void bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, VkPipelineBindPoint bindPoint) const;
+
+    VkDescriptorSetLayout layout() const { return mDescriptorSetLayout; }
+
+    uint32_t sampledImageCount() const;
+
+    uint32_t storageBufferCount() const;
+
+private:
+    VkDevice mDevice;
+    VkDeletionQueue *mDeletionQueue;
+    VkSampler mSampler;
+    VkDescriptorSetLayout mDescriptorSetLayout;
+    VkDescriptorPool mDescriptorPool;
+    VkDescriptorSet mDescriptorSet;
+    mutable std::mutex mMutex; // 인덱스 할당과 vkUpdateDescriptorSets는 외부 동기화가 필요하다.
+    VkIndexAllocator mSampledImageIndices;
+    VkIndexAllocator mStorageBufferIndices;
+};
+
+// 장치가 bindless에 필요한 descriptor indexing 기능을 지원하는지 확인한다.
+bool vkSupportsBindless(VkPhysicalDevice physicalDevice);
+
+// vkCreateDevice에 넘길 pNext 체인에 연결할 기능. 반환된 구조체의 pNext에 next를 연결한다.
+VkPhysicalDeviceDescriptorIndexingFeatures vkBindlessFeatures(void *next);
+
+#endif //PRACTICE_VULKAN_VKBINDLESSHEAP_H
@@ -0,0 +1,157 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cassert>
+
+#include "VkCommandRecorder.h"
+#include "VkTrace.h"
+#include "VkUtil.h"
+
+using namespace std;
+
+VkCommandRecorder::VkCommandRecorder(VkDevice device,
+                                     VkJobSystem *jobSystem,
+                                     uint32_t queueFamilyIndex,
+                                     uint32_t frameCount)
+        : mDevice(device),
+          mJobSystem(jobSystem),
+          mThreadPools(frameCount) {
+    assert(frameCount > 0);
+
+    // ================================================================================
+    // 1. 프레임 슬롯과 스레드마다 VkCommandPool 생성
+    // ================================================================================
+    // VkCommandPool 전체를 초기화하므로 command buffer를 개별적으로 초기화하는 플래그는 필요 없다.
+    VkCommandPoolCreateInfo commandPoolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = queueFamilyIndex
+    };
+
+    for (auto &threadPools : mThreadPools) {
+        threadPools.resize(mJobSystem->threadCount());
+        for (auto &threadPool : threadPools) {
+            VK_CHECK_ERROR(vkCreateCommandPool(mDevice, &commandPoolCreateInfo, nullptr, &threadPool.commandPool));
+            threadPool.usedCount = 0;
+        }
+    }
+}
+
+VkCommandRecorder::~VkCommandRecorder() {
+    // VkCommandPool을 파괴하면 할당된 command buffer도 함께 해제된다.
+    for (auto &threadPools : mThreadPools) {
+        for (auto &threadPool : threadPools) {
+            vkDestroyCommandPool(mDevice, threadPool.commandPool, nullptr);
+        }
+    }
+}
+
+void VkCommandRecorder::beginFrame(uint32_t frameIndex) {
+    assert(frameIndex < mThreadPools.size());
+
+    mFrameIndex = frameIndex;
+
+    // command buffer는 해제하지 않고 초기 상태로 돌아가므로 이번 프레임에서 다시 사용한다.
+    for (auto &threadPool : mThreadPools[mFrameIndex]) {
+        VK_CHECK_ERROR(vkResetCommandPool(mDevice, threadPool.commandPool, 0));
+        threadPool.usedCount = 0;
+    }
+}
+
+const vector<VkCommandBuffer> &VkCommandRecorder::record(const VkCommandBufferInheritanceInfo &inheritanceInfo,
+                                                         uint32_t count,
+                                                         const VkRecordFunction &recordFunction) {
+    VK_TRACE_SCOPE("RecordParallel");
+
+    // 스레드마다 같은 개수를 기록하도록 나눈다. 한 스레드가 여러 범위를 실행할 수도 있다.
+    auto rangeCount = mJobSystem->threadCount();
+    mRecorded.assign(rangeCount, VK_NULL_HANDLE);
+
+    // 기다리는 동안 호출한 스레드도 범위를 기록한다.
+    auto root = mJobSystem->create({});
+    for (uint32_t i = 0; i != rangeCount; ++i) {
+        auto begin = static_cast<uint32_t>(static_cast<uint64_t>(count) * i / rangeCount);
+        auto end = static_cast<uint32_t>(static_cast<uint64_t>(count) * (i + 1) / rangeCount);
+        if (begin == end) {
+            continue;
+        }
+
+        mJobSystem->run(mJobSystem->create([this, &inheritanceInfo, &recordFunction, i, begin, end] {
+            mRecorded[i] = recordRange(inheritanceInfo, begin, end, recordFunction);
+        }, root));
+    }
+    mJobSystem->run(root);
+    mJobSystem->wait(root);
+
+    mCommandBuffers.clear();
+    for (auto commandBuffer : mRecorded) {
+        if (commandBuffer != VK_NULL_HANDLE) {
+            mCommandBuffers.push_back(commandBuffer);
+        }
+    }
+
+    return mCommandBuffers;
+}
+
+VkCommandBuffer VkCommandRecorder::recordRange(const VkCommandBufferInheritanceInfo &inheritanceInfo,
+                                               uint32_t begin,
+                                               uint32_t end,
+                                               const VkRecordFunction &recordFunction) {
+    VK_TRACE_SCOPE("RecordSecondary");
+
+    // ================================================================================
+    // 1. 이 스레드의 VkCommandPool에서 secondary command buffer 얻기
+    // ================================================================================
+    auto &threadPool = mThreadPools[mFrameIndex][mJobSystem->threadIndex()];
+    if (threadPool.usedCount == threadPool.commandBuffers.size()) {
+        VkCommandBufferAllocateInfo commandBufferAllocateInfo{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .commandPool = threadPool.commandPool,
+                .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+                .commandBufferCount = 1
+        };
+
+        VkCommandBuffer commandBuffer;
+        VK_CHECK_ERROR(vkAllocateCommandBuffers(mDevice, &commandBufferAllocateInfo, &commandBuffer));
+        threadPool.commandBuffers.push_back(commandBuffer);
+    }
+    auto commandBuffer = threadPool.commandBuffers[threadPool.usedCount++];
+
+    // ================================================================================
+    // 2. secondary command buffer 기록
+    // ================================================================================
+    // VkRenderPass 안에서 실행되는 command buffer는 VkRenderPass를 이어서 사용한다고 알려야 한다.
+    // dynamic rendering 안에서 실행되면 renderPass 대신 pNext에 VkCommandBufferInheritanceRenderingInfo가 있다.
+    VkCommandBufferBeginInfo commandBufferBeginInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                     (inheritanceInfo.renderPass != VK_NULL_HANDLE || inheritanceInfo.pNext != nullptr ?
+                      VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT : 0u),
+            .pInheritanceInfo = &inheritanceInfo
+    };
+
+    VK_CHECK_ERROR(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+    recordFunction(commandBuffer, begin, end);
+    VK_CHECK_ERROR(vkEndCommandBuffer(commandBuffer));
+
+    return commandBuffer;
+}
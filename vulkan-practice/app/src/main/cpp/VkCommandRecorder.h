@@ -0,0 +1,81 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKCOMMANDRECORDER_H
+#define PRACTICE_VULKAN_VKCOMMANDRECORDER_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "VkJobSystem.h"
+
+// [begin, end) 범위의 그리기를 secondary command buffer에 기록한다. 여러 스레드에서 동시에 호출된다.
+typedef std::function<void(VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end)> VkRecordFunction;
+
+// VkJobSystem의 작업으로 secondary command buffer를 나눠서 기록한다.
+// VkCommandPool은 외부 동기화가 필요하므로 프레임 슬롯과 작업 시스템의 스레드마다 따로 두고,
+// 슬롯을 다시 사용할 때 command buffer를 하나씩 초기화하지 않고 VkCommandPool 전체를 한 번에 초기화한다.
+class VkCommandRecorder {
+public:
+    VkCommandRecorder(VkDevice device, VkJobSystem *jobSystem, uint32_t queueFamilyIndex, uint32_t frameCount);
+    ~VkCommandRecorder();
+
+    VkCommandRecorder(const VkCommandRecorder &) = delete;
+    VkCommandRecorder &operator=(const VkCommandRecorder &) = delete;
+
+    // frameIndex 슬롯의 VkCommandPool을 모두 초기화한다. 슬롯을 마지막으로 사용한 제출이 끝난 후에 호출해야 한다.
+    void beginFrame(uint32_t frameIndex);
+
+    // [0, count)를 스레드 수만큼 나눠서 범위마다 하나의 secondary command buffer에 기록하고 모두 끝날 때까지 기다린다.
+    // 반환된 command buffer는 범위 순서대로 정렬되어 있으므로 그대로 vkCmdExecuteCommands에 넘긴다.
+    // 작업 시스템을 만든 스레드에서 호출해야 한다. 한 프레임에서 여러 번 호출할 수 있고, 반환된 배열은 다음 호출 전까지 유효하다.
+    const std::vector<VkCommandBuffer> &record(const VkCommandBufferInheritanceInfo &inheritanceInfo,
+                                               uint32_t count,
+                                               const VkRecordFunction &recordFunction);
+
+    uint32_t threadCount() const { return mJobSystem->threadCount(); }
+
+private:
+    // 한 프레임 슬롯에서 한 스레드가 사용하는 객체들.
+    struct ThreadPool {
+        VkCommandPool commandPool;
+        std::vector<VkCommandBuffer> commandBuffers; // 한 번 할당한 command buffer는 초기화 후 다시 사용한다.
+        uint32_t usedCount;
+    };
+
+    // 범위를 실행하는 스레드의 VkCommandPool에서 command buffer를 얻어 기록한다.
+    VkCommandBuffer recordRange(const VkCommandBufferInheritanceInfo &inheritanceInfo,
+                                uint32_t begin,
+                                uint32_t end,
+                                const VkRecordFunction &recordFunction);
+
+    VkDevice mDevice;
+    VkJobSystem *mJobSystem;
+    std::vector<std::vector<ThreadPool>> mThreadPools; // [프레임 슬롯][스레드]
+    uint32_t mFrameIndex{0};
+    std::vector<VkCommandBuffer> mRecorded;       // 범위마다 기록한 command buffer. 범위가 비어있으면 VK_NULL_HANDLE
+    std::vector<VkCommandBuffer> mCommandBuffers; // record()가 반환하는 command buffer
+};
+
+#endif //PRACTICE_VULKAN_VKCOMMANDRECORDER_H
@@ -0,0 +1,136 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cassert>
+
+#include "VkDeletionQueue.h"
+
+using namespace std;
+
+VkDeletionQueue::VkDeletionQueue(VkDevice device, VkDeviceQueues *deviceQueues, VkMemoryAllocator *memoryAllocator)
+        : mDevice(device),
+          mDeviceQueues(deviceQueues),
+          mMemoryAllocator(memoryAllocator) {
+}
+
+VkDeletionQueue::~VkDeletionQueue() {
+    // 파괴하기 전에 flush를 호출해서 GPU의 실행이 끝난 것을 확인해야 한다.
+    assert(mEntries.empty());
+}
+
+void VkDeletionQueue::push(const VkQueueTimelineValues &lastUse, Deleter deleter) {
+    lock_guard<mutex> lock(mMutex);
+
+    mEntries.push_back({lastUse, std::move(deleter)});
+}
+
+void VkDeletionQueue::push(Deleter deleter) {
+    assert(mDeviceQueues);
+    push(mDeviceQueues->lastValues(), std::move(deleter));
+}
+
+void VkDeletionQueue::destroyBuffer(VkBuffer buffer, const VkAllocation &allocation) {
+    assert(mMemoryAllocator);
+    push([memoryAllocator = mMemoryAllocator, buffer, allocation = allocation]() mutable {
+        memoryAllocator->destroyBuffer(buffer, &allocation);
+    });
+}
+
+void VkDeletionQueue::destroyImage(VkImage image, const VkAllocation &allocation) {
+    assert(mMemoryAllocator);
+    push([memoryAllocator = mMemoryAllocator, image, allocation = allocation]() mutable {
+        memoryAllocator->destroyImage(image, &allocation);
+    });
+}
+
+void VkDeletionQueue::destroyImageView(VkImageView imageView) {
+    push([device = mDevice, imageView] { vkDestroyImageView(device, imageView, nullptr); });
+}
+
+void VkDeletionQueue::destroyFramebuffer(VkFramebuffer framebuffer) {
+    push([device = mDevice, framebuffer] { vkDestroyFramebuffer(device, framebuffer, nullptr); });
+}
+
+void VkDeletionQueue::destroySemaphore(VkSemaphore semaphore) {
+    push([device = mDevice, semaphore] { vkDestroySemaphore(device, semaphore, nullptr); });
+}
+
+void VkDeletionQueue::destroyPipeline(VkPipeline pipeline) {
+    push([device = mDevice, pipeline] { vkDestroyPipeline(device, pipeline, nullptr); });
+}
+
+void VkDeletionQueue::freeMemory(VkDeviceMemory memory) {
+    push([device = mDevice, memory] { vkFreeMemory(device, memory, nullptr); });
+}
+
+void VkDeletionQueue::destroySwapchain(VkSwapchainKHR swapchain) {
+    push([device = mDevice, swapchain] { vkDestroySwapchainKHR(device, swapchain, nullptr); });
+}
+
+size_t VkDeletionQueue::collect(const VkQueueTimelineValues &completedValues) {
+    // deleter가 다시 push를 호출할 수 있으므로 잠근 상태로 호출하지 않는다.
+    vector<Entry> completedEntries;
+    {
+        lock_guard<mutex> lock(mMutex);
+
+        auto completed = [&completedValues](const Entry &entry) {
+            for (auto i = 0; i != VK_QUEUE_TYPE_COUNT; ++i) {
+                if (entry.lastUse[i] > completedValues[i]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        // 놓은 순서를 유지해야 의존하는 객체(VkFramebuffer -> VkImageView)가 올바른 순서로 파괴된다.
+        auto pending = stable_partition(mEntries.begin(), mEntries.end(), completed);
+        move(mEntries.begin(), pending, back_inserter(completedEntries));
+        mEntries.erase(mEntries.begin(), pending);
+    }
+
+    for (auto &entry : completedEntries) {
+        entry.deleter();
+    }
+
+    return completedEntries.size();
+}
+
+size_t VkDeletionQueue::collect() {
+    assert(mDeviceQueues);
+    return collect(mDeviceQueues->completedValues());
+}
+
+void VkDeletionQueue::flush() {
+    VkQueueTimelineValues completedValues;
+    completedValues.fill(UINT64_MAX);
+
+    // deleter가 새 항목을 놓을 수 있으므로 빌 때까지 반복한다.
+    while (collect(completedValues) != 0) {
+    }
+}
+
+size_t VkDeletionQueue::size() const {
+    lock_guard<mutex> lock(mMutex);
+
+    return mEntries.size();
+}
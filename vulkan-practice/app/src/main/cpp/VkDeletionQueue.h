@@ -0,0 +1,88 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKDELETIONQUEUE_H
+#define PRACTICE_VULKAN_VKDELETIONQUEUE_H
+
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "VkDeviceQueues.h"
+#include "VkMemoryAllocator.h"
+
+// GPU가 아직 사용하고 있을 수 있는 리소스의 파괴를 미룬다.
+// 리소스를 놓을 때의 큐별 timeline 값을 함께 기록하고, 모든 큐가 그 값을 지난 후에 파괴한다.
+// vkDeviceWaitIdle 없이 실행 중에 리소스를 교체할 수 있다.
+class VkDeletionQueue {
+public:
+    typedef std::function<void()> Deleter;
+
+    // deviceQueues와 memoryAllocator가 nullptr이면 push와 collect(values)만 사용할 수 있다.
+    VkDeletionQueue(VkDevice device, VkDeviceQueues *deviceQueues, VkMemoryAllocator *memoryAllocator);
+    ~VkDeletionQueue();
+
+    VkDeletionQueue(const VkDeletionQueue &) = delete;
+    VkDeletionQueue &operator=(const VkDeletionQueue &) = delete;
+
+    // lastUse의 작업이 모두 끝나면 deleter를 호출한다.
+    void push(const VkQueueTimelineValues &lastUse, Deleter deleter);
+
+    // 지금까지 제출된 작업이 모두 끝나면 deleter를 호출한다.
+    void push(Deleter deleter);
+
+    // 지금까지 제출된 작업이 모두 끝나면 파괴한다. 리소스를 놓은 후에는 새로 제출되는 작업에서 사용하면 안 된다.
+    void destroyBuffer(VkBuffer buffer, const VkAllocation &allocation);
+    void destroyImage(VkImage image, const VkAllocation &allocation);
+    void destroyImageView(VkImageView imageView);
+    void destroyFramebuffer(VkFramebuffer framebuffer);
+    void destroySemaphore(VkSemaphore semaphore);
+    void destroyPipeline(VkPipeline pipeline);
+    void freeMemory(VkDeviceMemory memory);
+    void destroySwapchain(VkSwapchainKHR swapchain);
+
+    // completedValues를 지난 항목을 놓은 순서대로 파괴하고 파괴한 개수를 반환한다.
+    size_t collect(const VkQueueTimelineValues &completedValues);
+
+    // 실행이 끝난 작업의 항목을 파괴한다. 프레임마다 호출한다.
+    size_t collect();
+
+    // GPU의 실행이 모두 끝난 후에 남은 항목을 모두 파괴한다.
+    void flush();
+
+    size_t size() const;
+
+private:
+    struct Entry {
+        VkQueueTimelineValues lastUse;
+        Deleter deleter;
+    };
+
+    VkDevice mDevice;
+    VkDeviceQueues *mDeviceQueues;
+    VkMemoryAllocator *mMemoryAllocator;
+    mutable std::mutex mMutex;
+    std::vector<Entry> mEntries; // 놓은 순서대로 정렬
+};
+
+#endif //PRACTICE_VULKAN_VKDELETIONQUEUE_H
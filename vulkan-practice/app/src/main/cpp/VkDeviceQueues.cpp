@@ -0,0 +1,236 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cassert>
+
+#include "VkDeviceQueues.h"
+#include "VkUtil.h"
+
+using namespace std;
+
+VkQueueFamilyIndices vkChooseQueueFamilies(const vector<VkQueueFamilyProperties> &queueFamilyProperties) {
+    VkQueueFamilyIndices queueFamilyIndices{UINT32_MAX, UINT32_MAX, UINT32_MAX};
+
+    for (uint32_t i = 0; i != queueFamilyProperties.size(); ++i) {
+        auto queueFlags = queueFamilyProperties[i].queueFlags;
+        if (queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+            if (queueFamilyIndices.graphics == UINT32_MAX) {
+                queueFamilyIndices.graphics = i;
+            }
+        } else if (queueFlags & VK_QUEUE_COMPUTE_BIT) {
+            if (queueFamilyIndices.compute == UINT32_MAX) {
+                queueFamilyIndices.compute = i;
+            }
+        } else if (queueFlags & VK_QUEUE_TRANSFER_BIT) {
+            if (queueFamilyIndices.transfer == UINT32_MAX) {
+                queueFamilyIndices.transfer = i;
+            }
+        }
+    }
+    assert(queueFamilyIndices.graphics != UINT32_MAX);
+
+    // 전용 큐 패밀리가 없으면 graphics 큐에서 실행한다. graphics 큐는 compute와 transfer를 항상 지원한다.
+    if (queueFamilyIndices.compute == UINT32_MAX) {
+        queueFamilyIndices.compute = queueFamilyIndices.graphics;
+    }
+    if (queueFamilyIndices.transfer == UINT32_MAX) {
+        queueFamilyIndices.transfer = queueFamilyIndices.graphics;
+    }
+
+    return queueFamilyIndices;
+}
+
+vector<VkDeviceQueueCreateInfo> vkQueueCreateInfos(const VkQueueFamilyIndices &queueFamilyIndices) {
+    static const float kQueuePriority = 1.0;
+
+    vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+    for (auto familyIndex : {queueFamilyIndices.graphics, queueFamilyIndices.compute, queueFamilyIndices.transfer}) {
+        auto found = find_if(queueCreateInfos.begin(), queueCreateInfos.end(), [familyIndex](const auto &info) {
+            return info.queueFamilyIndex == familyIndex;
+        });
+        if (found != queueCreateInfos.end()) {
+            continue;
+        }
+
+        queueCreateInfos.push_back({
+                .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                .queueFamilyIndex = familyIndex,
+                .queueCount = 1,
+                .pQueuePriorities = &kQueuePriority
+        });
+    }
+
+    return queueCreateInfos;
+}
+
+VkDeviceQueues::VkDeviceQueues(VkDevice device, const VkQueueFamilyIndices &queueFamilyIndices)
+        : mDevice(device),
+          mFamilyIndices{queueFamilyIndices.graphics, queueFamilyIndices.compute, queueFamilyIndices.transfer} {
+    VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+            .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+            .initialValue = 0
+    };
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = &semaphoreTypeCreateInfo
+    };
+
+    for (auto i = 0; i != VK_QUEUE_TYPE_COUNT; ++i) {
+        // 같은 큐 패밀리는 같은 VkQueue를 얻는다.
+        vkGetDeviceQueue(mDevice, mFamilyIndices[i], 0, &mQueues[i]);
+        // VkQueue를 함께 사용하더라도 큐 종류마다 timeline을 따로 두어서 ticket의 값이 큐 종류별로 증가하게 한다.
+        VK_CHECK_ERROR(vkCreateSemaphore(mDevice, &semaphoreCreateInfo, nullptr, &mTimelineSemaphores[i]));
+    }
+}
+
+VkDeviceQueues::~VkDeviceQueues() {
+    waitIdle();
+
+    for (auto semaphore : mTimelineSemaphores) {
+        vkDestroySemaphore(mDevice, semaphore, nullptr);
+    }
+}
+
+VkQueueTicket VkDeviceQueues::submit(VkQueueType queueType,
+                                     const VkSubmitInfo &submitInfo,
+                                     optional<VkQueueWait> wait) {
+    lock_guard<mutex> lock(mMutex);
+
+    // ================================================================================
+    // 1. 다른 큐의 제출을 기다리는 목록에 추가
+    // ================================================================================
+    // binary semaphore의 값은 무시되지만 timeline semaphore와 함께 사용하려면 개수를 맞춰야 한다.
+    vector<VkSemaphore> waitSemaphores(submitInfo.pWaitSemaphores,
+                                       submitInfo.pWaitSemaphores + submitInfo.waitSemaphoreCount);
+    vector<VkPipelineStageFlags> waitStageMasks(submitInfo.pWaitDstStageMask,
+                                                submitInfo.pWaitDstStageMask + submitInfo.waitSemaphoreCount);
+    vector<uint64_t> waitValues(submitInfo.waitSemaphoreCount, 0);
+
+    // 같은 VkQueue에 제출된 작업은 제출 순서와 배리어로 동기화할 수 있다.
+    if (wait && wait->ticket.value != 0 && mQueues[wait->ticket.queueType] != mQueues[queueType]) {
+        waitSemaphores.push_back(mTimelineSemaphores[wait->ticket.queueType]);
+        waitValues.push_back(wait->ticket.value);
+        waitStageMasks.push_back(wait->waitStageMask);
+    }
+
+    // ================================================================================
+    // 2. 이 큐의 timeline semaphore를 Signal하는 목록에 추가
+    // ================================================================================
+    vector<VkSemaphore> signalSemaphores(submitInfo.pSignalSemaphores,
+                                         submitInfo.pSignalSemaphores + submitInfo.signalSemaphoreCount);
+    vector<uint64_t> signalValues(submitInfo.signalSemaphoreCount, 0);
+
+    VkQueueTicket ticket{queueType, ++mLastValues[queueType]};
+    signalSemaphores.push_back(mTimelineSemaphores[queueType]);
+    signalValues.push_back(ticket.value);
+
+    // ================================================================================
+    // 3. 제출
+    // ================================================================================
+    VkTimelineSemaphoreSubmitInfo timelineSemaphoreSubmitInfo{
+            .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+            .pNext = submitInfo.pNext,
+            .waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size()),
+            .pWaitSemaphoreValues = waitValues.data(),
+            .signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size()),
+            .pSignalSemaphoreValues = signalValues.data()
+    };
+
+    auto info = submitInfo;
+    info.pNext = &timelineSemaphoreSubmitInfo;
+    info.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+    info.pWaitSemaphores = waitSemaphores.data();
+    info.pWaitDstStageMask = waitStageMasks.data();
+    info.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+    info.pSignalSemaphores = signalSemaphores.data();
+
+    VK_CHECK_ERROR(vkQueueSubmit(mQueues[queueType], 1, &info, VK_NULL_HANDLE));
+
+    return ticket;
+}
+
+VkResult VkDeviceQueues::present(const VkPresentInfoKHR &presentInfo) {
+    lock_guard<mutex> lock(mMutex);
+
+    return vkQueuePresentKHR(mQueues[VK_QUEUE_TYPE_GRAPHICS], &presentInfo);
+}
+
+bool VkDeviceQueues::isComplete(VkQueueTicket ticket) const {
+    if (ticket.value == 0) {
+        return true;
+    }
+
+    uint64_t value;
+    VK_CHECK_ERROR(vkGetSemaphoreCounterValue(mDevice, mTimelineSemaphores[ticket.queueType], &value));
+    return value >= ticket.value;
+}
+
+void VkDeviceQueues::wait(VkQueueTicket ticket) const {
+    if (ticket.value == 0) {
+        return;
+    }
+
+    // VkQueue에 접근하지 않으므로 잠그지 않고 기다린다. 다른 스레드는 기다리는 동안에도 제출할 수 있다.
+    VkSemaphoreWaitInfo semaphoreWaitInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .semaphoreCount = 1,
+            .pSemaphores = &mTimelineSemaphores[ticket.queueType],
+            .pValues = &ticket.value
+    };
+    VK_CHECK_ERROR(vkWaitSemaphores(mDevice, &semaphoreWaitInfo, UINT64_MAX));
+}
+
+VkQueueTicket VkDeviceQueues::lastTicket(VkQueueType queueType) {
+    lock_guard<mutex> lock(mMutex);
+
+    return {queueType, mLastValues[queueType]};
+}
+
+VkQueueTimelineValues VkDeviceQueues::lastValues() {
+    lock_guard<mutex> lock(mMutex);
+
+    return mLastValues;
+}
+
+VkQueueTimelineValues VkDeviceQueues::completedValues() const {
+    VkQueueTimelineValues values;
+    for (auto i = 0; i != VK_QUEUE_TYPE_COUNT; ++i) {
+        VK_CHECK_ERROR(vkGetSemaphoreCounterValue(mDevice, mTimelineSemaphores[i], &values[i]));
+    }
+
+    return values;
+}
+
+void VkDeviceQueues::waitIdle() {
+    lock_guard<mutex> lock(mMutex);
+
+    // 출력도 끝나야 하므로 semaphore가 아니라 큐를 기다린다.
+    for (auto i = 0; i != VK_QUEUE_TYPE_COUNT; ++i) {
+        // 같은 VkQueue를 여러 번 기다리지 않는다.
+        if (find(mQueues.begin(), mQueues.begin() + i, mQueues[i]) == mQueues.begin() + i) {
+            VK_CHECK_ERROR(vkQueueWaitIdle(mQueues[i]));
+        }
+    }
+}
@@ -0,0 +1,126 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKDEVICEQUEUES_H
+#define PRACTICE_VULKAN_VKDEVICEQUEUES_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+typedef enum VkQueueType {
+    VK_QUEUE_TYPE_GRAPHICS = 0,
+    VK_QUEUE_TYPE_COMPUTE = 1,  // graphics를 지원하지 않는 compute 큐. 렌더링과 동시에 실행된다.
+    VK_QUEUE_TYPE_TRANSFER = 2, // graphics와 compute를 지원하지 않는 transfer 큐. 보통 DMA 엔진에 대응된다.
+    VK_QUEUE_TYPE_COUNT = 3
+} VkQueueType;
+
+struct VkQueueFamilyIndices {
+    uint32_t graphics;
+    uint32_t compute;  // 전용 큐 패밀리가 없으면 graphics와 같다.
+    uint32_t transfer; // 전용 큐 패밀리가 없으면 graphics와 같다.
+};
+
+// 제출을 구분하는 번호. 큐마다 timeline semaphore가 있고 제출할 때마다 그 값이 1씩 증가한다.
+// semaphore의 값이 value 이상이면 그 제출과 이전의 모든 제출이 끝난 것이다. value가 0이면 기다릴 제출이 없다.
+struct VkQueueTicket {
+    VkQueueType queueType{VK_QUEUE_TYPE_GRAPHICS};
+    uint64_t value{0};
+};
+
+// 큐 종류별 timeline semaphore의 값.
+typedef std::array<uint64_t, VK_QUEUE_TYPE_COUNT> VkQueueTimelineValues;
+
+// 제출이 ticket의 제출이 끝난 후에 waitStageMask 단계를 시작하도록 한다.
+struct VkQueueWait {
+    VkQueueTicket ticket;
+    VkPipelineStageFlags waitStageMask;
+};
+
+// graphics를 지원하는 첫 번째 큐 패밀리와 compute, transfer 전용 큐 패밀리를 찾는다.
+VkQueueFamilyIndices vkChooseQueueFamilies(const std::vector<VkQueueFamilyProperties> &queueFamilyProperties);
+
+// 큐 패밀리마다 큐를 하나씩 만드는 VkDeviceQueueCreateInfo. 같은 큐 패밀리는 한 번만 포함된다.
+std::vector<VkDeviceQueueCreateInfo> vkQueueCreateInfos(const VkQueueFamilyIndices &queueFamilyIndices);
+
+// 큐 종류별로 VkQueue와 timeline semaphore를 관리한다. 제출하면 VkQueueTicket을 반환하고,
+// CPU는 Fence 대신 ticket으로 제출이 끝났는지 확인하거나 기다린다. 다른 큐의 작업도 ticket의 값으로 기다린다.
+// 전용 큐 패밀리가 없으면 graphics 큐를 함께 사용하며, 같은 VkQueue에 제출하는 작업은 semaphore 없이 제출 순서로 동기화된다.
+// VkQueue는 외부에서 동기화해야 하므로 모든 제출과 출력은 이 클래스를 통해서 한다. timeline semaphore는 Vulkan 1.2가 필요하다.
+class VkDeviceQueues {
+public:
+    VkDeviceQueues(VkDevice device, const VkQueueFamilyIndices &queueFamilyIndices);
+    ~VkDeviceQueues();
+
+    VkDeviceQueues(const VkDeviceQueues &) = delete;
+    VkDeviceQueues &operator=(const VkDeviceQueues &) = delete;
+
+    VkQueue queue(VkQueueType queueType) const { return mQueues[queueType]; }
+
+    uint32_t familyIndex(VkQueueType queueType) const { return mFamilyIndices[queueType]; }
+
+    // graphics 큐와 다른 큐 패밀리를 사용하는지. 다르면 리소스의 소유권을 넘겨야 한다.
+    bool dedicated(VkQueueType queueType) const {
+        return mFamilyIndices[queueType] != mFamilyIndices[VK_QUEUE_TYPE_GRAPHICS];
+    }
+
+    // submitInfo를 queueType 큐에 제출하고 제출의 ticket을 반환한다. submitInfo의 semaphore는 binary semaphore여야 한다.
+    // wait이 있으면 그 ticket의 timeline semaphore를 함께 기다린다. 소유권을 가져오는 배리어를 기록한 제출에 넘겨서
+    // release와 acquire의 순서를 보장한다. 같은 VkQueue의 ticket이면 제출 순서와 배리어로 동기화되므로 기다리지 않는다.
+    // compute 작업은 VK_QUEUE_TYPE_COMPUTE에 제출하고, 결과를 읽는 graphics 제출에 그 ticket을 wait으로 넘긴다.
+    VkQueueTicket submit(VkQueueType queueType,
+                         const VkSubmitInfo &submitInfo,
+                         std::optional<VkQueueWait> wait = std::nullopt);
+
+    VkResult present(const VkPresentInfoKHR &presentInfo);
+
+    // 기다리지 않고 ticket의 제출이 끝났는지 확인한다.
+    bool isComplete(VkQueueTicket ticket) const;
+
+    // ticket의 제출이 끝날 때까지 CPU에서 기다린다.
+    void wait(VkQueueTicket ticket) const;
+
+    // queueType 큐에 마지막으로 제출한 작업의 ticket.
+    VkQueueTicket lastTicket(VkQueueType queueType);
+
+    // 모든 큐에 마지막으로 제출한 작업의 값. 이 값들이 끝나면 지금까지 제출한 모든 작업이 끝난 것이다.
+    VkQueueTimelineValues lastValues();
+
+    // 모든 큐에서 실행이 끝난 작업의 값.
+    VkQueueTimelineValues completedValues() const;
+
+    // 모든 큐의 실행이 끝날 때까지 기다린다.
+    void waitIdle();
+
+private:
+    VkDevice mDevice;
+    std::array<uint32_t, VK_QUEUE_TYPE_COUNT> mFamilyIndices;
+    std::array<VkQueue, VK_QUEUE_TYPE_COUNT> mQueues;
+    std::array<VkSemaphore, VK_QUEUE_TYPE_COUNT> mTimelineSemaphores;
+    std::mutex mMutex;
+    VkQueueTimelineValues mLastValues{};
+};
+
+#endif //PRACTICE_VULKAN_VKDEVICEQUEUES_H
@@ -0,0 +1,234 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <iomanip>
+#include <sstream>
+
+#include "VkBindlessHeap.h"
+#include "VkDeviceSelector.h"
+#include "VkUtil.h"
+
+using namespace std;
+
+namespace {
+string toLower(string_view text) {
+    string lower(text);
+    transform(lower.begin(), lower.end(), lower.begin(),
+              [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    return lower;
+}
+
+uint64_t deviceTypeScore(VkPhysicalDeviceType deviceType) {
+    switch (deviceType) {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+            return 10000;
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+            return 5000;
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+            return 2000;
+        case VK_PHYSICAL_DEVICE_TYPE_CPU:
+            // 소프트웨어 구현은 다른 장치가 없을 때만 사용한다.
+            return 100;
+        default:
+            return 0;
+    }
+}
+
+bool matchesPreference(const VkDeviceCandidate &candidate, size_t index, const string &preference) {
+    size_t preferredIndex;
+    auto [end, error] = from_chars(preference.data(), preference.data() + preference.size(), preferredIndex);
+    if (error == errc() && end == preference.data() + preference.size()) {
+        return preferredIndex == index;
+    }
+
+    auto lowerPreference = toLower(preference);
+    return toLower(candidate.name).find(lowerPreference) != string::npos ||
+           toLower(vkToString(candidate.deviceType)).find(lowerPreference) != string::npos;
+}
+}
+
+VkDeviceCandidate vkQueryDeviceCandidate(VkPhysicalDevice physicalDevice) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    VkDeviceCandidate candidate{
+            .name = properties.deviceName,
+            .deviceType = properties.deviceType,
+            .apiVersion = properties.apiVersion,
+            .deviceLocalMemorySize = 0,
+            .graphicsQueue = false,
+            .asyncComputeQueue = false,
+            .dedicatedTransferQueue = false,
+            .timestampQueries = false,
+            .swapchain = false,
+            // 1.2보다 낮은 장치는 어차피 사용하지 않으므로 기능을 조회하지 않는다.
+            .bindless = properties.apiVersion >= kMinDeviceApiVersion && vkSupportsBindless(physicalDevice)
+    };
+
+    for (auto i = 0; i != memoryProperties.memoryHeapCount; ++i) {
+        if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            candidate.deviceLocalMemorySize += memoryProperties.memoryHeaps[i].size;
+        }
+    }
+
+    uint32_t queueFamilyPropertiesCount;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertiesCount, nullptr);
+
+    vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyPropertiesCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertiesCount, queueFamilyProperties.data());
+
+    for (const auto &familyProperties : queueFamilyProperties) {
+        auto queueFlags = familyProperties.queueFlags;
+        if (queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+            candidate.graphicsQueue = true;
+            candidate.timestampQueries |= familyProperties.timestampValidBits != 0;
+        } else if (queueFlags & VK_QUEUE_COMPUTE_BIT) {
+            candidate.asyncComputeQueue = true;
+        } else if (queueFlags & VK_QUEUE_TRANSFER_BIT) {
+            candidate.dedicatedTransferQueue = true;
+        }
+    }
+
+    uint32_t extensionCount;
+    VK_CHECK_ERROR(vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr));
+
+    vector<VkExtensionProperties> extensionProperties(extensionCount);
+    VK_CHECK_ERROR(vkEnumerateDeviceExtensionProperties(physicalDevice,
+                                                        nullptr,
+                                                        &extensionCount,
+                                                        extensionProperties.data()));
+
+    for (const auto &properties : extensionProperties) {
+        if (properties.extensionName == string("VK_KHR_swapchain")) {
+            candidate.swapchain = true;
+        }
+    }
+
+    return candidate;
+}
+
+VkDeviceScore vkScoreDevice(const VkDeviceCandidate &candidate, bool presentable) {
+    // ================================================================================
+    // 1. 필수 조건 확인
+    // ================================================================================
+    if (!candidate.graphicsQueue) {
+        return {false, 0, "no graphics queue"};
+    }
+
+    if (candidate.apiVersion < kMinDeviceApiVersion) {
+        ostringstream reason;
+        reason << "Vulkan " << VK_API_VERSION_MAJOR(candidate.apiVersion) << "."
+               << VK_API_VERSION_MINOR(candidate.apiVersion) << " is older than 1.2";
+        return {false, 0, reason.str()};
+    }
+
+    if (!candidate.bindless) {
+        return {false, 0, "descriptor indexing for bindless resources not supported"};
+    }
+
+    if (presentable && !candidate.swapchain) {
+        return {false, 0, "VK_KHR_swapchain not supported"};
+    }
+
+    // ================================================================================
+    // 2. 점수 계산
+    // ================================================================================
+    ostringstream reason;
+    uint64_t score = deviceTypeScore(candidate.deviceType);
+    reason << vkToString(candidate.deviceType);
+
+    score += VK_API_VERSION_MINOR(candidate.apiVersion) * 100;
+    reason << ", Vulkan " << VK_API_VERSION_MAJOR(candidate.apiVersion) << "."
+           << VK_API_VERSION_MINOR(candidate.apiVersion);
+
+    // 같은 종류의 장치 사이에서만 차이가 나도록 메모리 점수는 종류의 차이보다 작게 제한한다.
+    auto deviceLocalMemoryMiB = candidate.deviceLocalMemorySize >> 20;
+    score += min<uint64_t>(deviceLocalMemoryMiB >> 8, 1000);
+    reason << ", " << deviceLocalMemoryMiB << " MiB device local";
+
+    if (candidate.asyncComputeQueue) {
+        score += 50;
+        reason << ", async compute queue";
+    }
+
+    if (candidate.dedicatedTransferQueue) {
+        score += 50;
+        reason << ", dedicated transfer queue";
+    }
+
+    if (candidate.timestampQueries) {
+        score += 10;
+        reason << ", timestamp queries";
+    }
+
+    return {true, score, reason.str()};
+}
+
+optional<size_t> vkSelectDevice(const vector<VkDeviceCandidate> &candidates,
+                                bool presentable,
+                                const string &preference) {
+    optional<size_t> preferredIndex;
+    optional<size_t> bestIndex;
+    uint64_t bestScore = 0;
+
+    // 선택되지 않은 장치도 이유를 확인할 수 있도록 모든 장치의 점수를 출력한다.
+    for (size_t i = 0; i != candidates.size(); ++i) {
+        auto [suitable, score, reason] = vkScoreDevice(candidates[i], presentable);
+
+        aout << "Physical Device [" << i << "] " << candidates[i].name << ": ";
+        if (!suitable) {
+            aout << "rejected (" << reason << ")" << endl;
+            continue;
+        }
+        aout << "score " << score << " (" << reason << ")" << endl;
+
+        if (!preferredIndex && !preference.empty() && matchesPreference(candidates[i], i, preference)) {
+            preferredIndex = i;
+        }
+
+        if (!bestIndex || score > bestScore) {
+            bestIndex = i;
+            bestScore = score;
+        }
+    }
+
+    if (preferredIndex) {
+        aout << "Physical Device [" << *preferredIndex << "] selected by preference \"" << preference << "\"" << endl;
+        return preferredIndex;
+    }
+
+    if (!preference.empty()) {
+        aout << "No suitable physical device matches \"" << preference << "\"" << endl;
+    }
+
+    if (bestIndex) {
+        aout << "Physical Device [" << *bestIndex << "] selected by score" << endl;
+    }
+
+    return bestIndex;
+}
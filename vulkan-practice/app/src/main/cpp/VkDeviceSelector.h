@@ -0,0 +1,72 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKDEVICESELECTOR_H
+#define PRACTICE_VULKAN_VKDEVICESELECTOR_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// 렌더러에 필요한 것만 모은 physical device의 정보. 점수 계산은 Vulkan을 호출하지 않는다.
+struct VkDeviceCandidate {
+    std::string name;
+    VkPhysicalDeviceType deviceType;
+    uint32_t apiVersion;
+    VkDeviceSize deviceLocalMemorySize;  // DEVICE_LOCAL 힙의 크기 합
+    bool graphicsQueue;                  // graphics를 지원하는 queueFamily가 있는지
+    bool asyncComputeQueue;              // graphics 없이 compute를 지원하는 queueFamily가 있는지
+    bool dedicatedTransferQueue;         // transfer만 지원하는 queueFamily가 있는지
+    bool timestampQueries;               // graphics 큐에서 타임스탬프 쿼리를 사용할 수 있는지
+    bool swapchain;                      // VK_KHR_swapchain 지원 여부
+    bool bindless;                       // bindless에 필요한 descriptor indexing 기능 지원 여부
+};
+
+struct VkDeviceScore {
+    bool suitable;
+    uint64_t score;      // suitable이 false면 0
+    std::string reason;  // 점수의 근거 또는 사용할 수 없는 이유
+};
+
+// 큐의 동기화에 timeline semaphore를 사용하기 때문에 필요한 최소 버전.
+// 최소 사양은 이 버전과 bindless에 필요한 descriptor indexing 기능이다. 셰이더가 bindless 배열로만 텍스처를 읽으므로
+// 이를 지원하지 않는 장치를 위한 경로는 두지 않는다. 사용할 수 있는 장치가 없으면 렌더러를 만들 때 중단한다.
+constexpr uint32_t kMinDeviceApiVersion = VK_MAKE_API_VERSION(0, 1, 2, 0);
+
+// 설정보다 우선하는 환경 변수. 장치의 인덱스나 이름 또는 종류의 일부("discrete", "cpu" 등)를 지정한다.
+constexpr const char *kDeviceEnvironmentVariable = "PRACTICE_VULKAN_DEVICE";
+
+VkDeviceCandidate vkQueryDeviceCandidate(VkPhysicalDevice physicalDevice);
+
+// 장치의 종류가 가장 큰 비중을 차지하고 API 버전, 메모리 크기, 큐의 기능 순으로 점수를 더한다.
+VkDeviceScore vkScoreDevice(const VkDeviceCandidate &candidate, bool presentable);
+
+// preference가 비어있지 않으면 그 장치를 사용하고, 없거나 사용할 수 없으면 점수가 가장 높은 장치를 사용한다.
+// preference는 인덱스이거나 장치의 이름 또는 종류에 포함되는 문자열이다. 대소문자를 구분하지 않는다.
+// 사용할 수 있는 장치가 없으면 nullopt를 반환한다.
+std::optional<size_t> vkSelectDevice(const std::vector<VkDeviceCandidate> &candidates,
+                                     bool presentable,
+                                     const std::string &preference);
+
+#endif //PRACTICE_VULKAN_VKDEVICESELECTOR_H
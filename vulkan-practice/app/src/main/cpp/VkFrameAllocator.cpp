@@ -0,0 +1,249 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+
+#include "VkFrameAllocator.h"
+#include "VkUtil.h"
+
+using namespace std;
+
+namespace {
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+}
+
+VkFrameAllocator::VkFrameAllocator(VkDevice device,
+                                   const VkPhysicalDeviceProperties &physicalDeviceProperties,
+                                   VkMemoryAllocator *memoryAllocator,
+                                   uint32_t frameCount,
+                                   VkDeviceSize frameSize)
+        : mDevice(device),
+          mMemoryAllocator(memoryAllocator) {
+    // ================================================================================
+    // 1. 정렬과 크기 결정
+    // ================================================================================
+    const auto &limits = physicalDeviceProperties.limits;
+    mAlignment = max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment);
+    mMaxRange = min<VkDeviceSize>({kMaxRange, limits.maxUniformBufferRange, limits.maxStorageBufferRange});
+    // 모든 슬롯의 시작 위치도 dynamic offset이므로 슬롯의 크기를 정렬에 맞춘다.
+    mFrameSize = alignUp(frameSize, mAlignment);
+
+    // descriptor는 오프셋 0에서 mMaxRange만큼을 가리키고 dynamic offset만큼 이동한다.
+    // 마지막 슬롯의 끝에서 할당해도 그 범위가 버퍼를 넘지 않도록 mMaxRange만큼 여유를 둔다.
+    auto bufferSize = mFrameSize * frameCount + mMaxRange;
+    assert(bufferSize <= UINT32_MAX); // dynamic offset은 32비트
+
+    // ================================================================================
+    // 2. VkBuffer 생성
+    // ================================================================================
+    VkBufferCreateInfo bufferCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size = bufferSize,
+            .usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+    };
+
+    // COHERENT 메모리이므로 쓴 데이터를 flush하지 않아도 제출할 때 GPU에서 보인다.
+    VkAllocationCreateInfo allocationCreateInfo{
+            .memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                   VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    };
+
+    VK_CHECK_ERROR(mMemoryAllocator->createBuffer(bufferCreateInfo,
+                                                  allocationCreateInfo,
+                                                  &mBuffer,
+                                                  &mAllocation));
+
+    // ================================================================================
+    // 3. VkDescriptorSetLayout 생성
+    // ================================================================================
+    array<VkDescriptorSetLayoutBinding, 2> descriptorSetLayoutBindings{
+            VkDescriptorSetLayoutBinding{
+                    .binding = kUniformBufferBinding,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_ALL
+            },
+            VkDescriptorSetLayoutBinding{
+                    .binding = kStorageBufferBinding,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_ALL
+            }
+    };
+
+    VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .bindingCount = static_cast<uint32_t>(descriptorSetLayoutBindings.size()),
+            .pBindings = descriptorSetLayoutBindings.data()
+    };
+
+    VK_CHECK_ERROR(vkCreateDescriptorSetLayout(mDevice,
+                                               &descriptorSetLayoutCreateInfo,
+                                               nullptr,
+                                               &mDescriptorSetLayout));
+
+    // ================================================================================
+    // 4. VkDescriptorPool 생성, VkDescriptorSet 할당
+    // ================================================================================
+    array<VkDescriptorPoolSize, 2> descriptorPoolSizes{
+            VkDescriptorPoolSize{
+                    .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+                    .descriptorCount = 1
+            },
+            VkDescriptorPoolSize{
+                    .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+                    .descriptorCount = 1
+            }
+    };
+
+    VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets = 1,
+            .poolSizeCount = static_cast<uint32_t>(descriptorPoolSizes.size()),
+            .pPoolSizes = descriptorPoolSizes.data()
+    };
+
+    VK_CHECK_ERROR(vkCreateDescriptorPool(mDevice, &descriptorPoolCreateInfo, nullptr, &mDescriptorPool));
+
+    VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool = mDescriptorPool,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &mDescriptorSetLayout
+    };
+
+    VK_CHECK_ERROR(vkAllocateDescriptorSets(mDevice, &descriptorSetAllocateInfo, &mDescriptorSet));
+
+    // ================================================================================
+    // 5. VkDescriptorSet 갱신
+    // ================================================================================
+    // 이후로는 descriptor를 갱신하지 않는다.
+    VkDescriptorBufferInfo descriptorBufferInfo{
+            .buffer = mBuffer,
+            .offset = 0,
+            .range = mMaxRange
+    };
+
+    array<VkWriteDescriptorSet, 2> writeDescriptorSets{
+            VkWriteDescriptorSet{
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = mDescriptorSet,
+                    .dstBinding = kUniformBufferBinding,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+                    .pBufferInfo = &descriptorBufferInfo
+            },
+            VkWriteDescriptorSet{
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = mDescriptorSet,
+                    .dstBinding = kStorageBufferBinding,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+                    .pBufferInfo = &descriptorBufferInfo
+            }
+    };
+
+    vkUpdateDescriptorSets(mDevice,
+                           static_cast<uint32_t>(writeDescriptorSets.size()),
+                           writeDescriptorSets.data(),
+                           0,
+                           nullptr);
+}
+
+VkFrameAllocator::~VkFrameAllocator() {
+    vkDestroyDescriptorPool(mDevice, mDescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(mDevice, mDescriptorSetLayout, nullptr);
+    mMemoryAllocator->destroyBuffer(mBuffer, &mAllocation);
+}
+
+void VkFrameAllocator::beginFrame(uint32_t frameIndex) {
+    // 이전 프레임이 요청한 크기를 통계에 반영한다.
+    if (mFrameBegun) {
+        mLastFrameSize = mFrameHead.load(memory_order_relaxed);
+        mHighWaterMark = max(mHighWaterMark, mLastFrameSize);
+    }
+
+    mFrameBegin = mFrameSize * frameIndex;
+    mFrameHead.store(0, memory_order_relaxed);
+    mFrameBegun = true;
+}
+
+bool VkFrameAllocator::allocate(VkDeviceSize size, VkFrameAllocation *allocation) {
+    assert(mFrameBegun);
+    assert(size <= mMaxRange); // descriptor의 범위보다 크면 셰이더에서 모두 읽을 수 없다.
+
+    // 스레드마다 겹치지 않는 구간을 얻는다. 실패해도 되돌리지 않으므로 mFrameHead는 요청된 크기의 합이 된다.
+    auto alignedSize = alignUp(size, mAlignment);
+    auto offset = mFrameHead.fetch_add(alignedSize, memory_order_relaxed);
+    if (offset + alignedSize > mFrameSize) {
+        mOverflowCount.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    auto bufferOffset = mFrameBegin + offset;
+    *allocation = {
+            .offset = static_cast<uint32_t>(bufferOffset),
+            .mappedData = static_cast<uint8_t *>(mAllocation.mappedData) + bufferOffset
+    };
+    return true;
+}
+
+bool VkFrameAllocator::push(const void *data, VkDeviceSize size, VkFrameAllocation *allocation) {
+    if (!allocate(size, allocation)) {
+        return false;
+    }
+
+    memcpy(allocation->mappedData, data, size);
+    return true;
+}
+
+void VkFrameAllocator::bind(VkCommandBuffer commandBuffer,
+                            VkPipelineLayout pipelineLayout,
+                            uint32_t set,
+                            uint32_t uniformOffset,
+                            uint32_t storageOffset) const {
+    // dynamic offset은 binding 순서대로 넘긴다.
+    array<uint32_t, 2> dynamicOffsets{uniformOffset, storageOffset};
+
+    vkCmdBindDescriptorSets(commandBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            pipelineLayout,
+                            set,
+                            1,
+                            &mDescriptorSet,
+                            static_cast<uint32_t>(dynamicOffsets.size()),
+                            dynamicOffsets.data());
+}
+
+VkFrameAllocatorStats VkFrameAllocator::stats() const {
+    return {
+            .frameSize = mFrameSize,
+            .lastFrameSize = mLastFrameSize,
+            .highWaterMark = mHighWaterMark,
+            .overflowCount = mOverflowCount.load(memory_order_relaxed)
+    };
+}
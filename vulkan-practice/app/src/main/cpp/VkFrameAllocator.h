@@ -0,0 +1,114 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKFRAMEALLOCATOR_H
+#define PRACTICE_VULKAN_VKFRAMEALLOCATOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+#include "VkMemoryAllocator.h"
+
+// 프레임 안에서만 사용하는 데이터의 위치. offset은 vkCmdBindDescriptorSets의 dynamic offset으로 사용한다.
+struct VkFrameAllocation {
+    uint32_t offset;
+    void *mappedData;
+};
+
+struct VkFrameAllocatorStats {
+    VkDeviceSize frameSize;     // 프레임마다 사용할 수 있는 크기
+    VkDeviceSize lastFrameSize; // 마지막으로 기록을 끝낸 프레임이 요청한 크기
+    VkDeviceSize highWaterMark; // 한 프레임이 요청한 크기의 최대값. frameSize보다 크면 공간이 부족했던 것이다.
+    uint64_t overflowCount;     // 공간이 부족해서 실패한 할당의 수
+};
+
+// 프레임마다 바뀌는 uniform, storage 데이터를 위한 선형 할당기.
+// 하나의 HOST_VISIBLE 버퍼를 프레임 슬롯 수만큼 나누고 생성할 때 한 번만 매핑한다.
+// 할당은 슬롯 안에서 앞으로 이동하기만 하고, 슬롯을 다시 사용할 때 한 번에 초기화한다.
+//
+// VkDescriptorSet은 생성할 때 한 번만 갱신하고, 할당된 위치는 dynamic offset으로 넘긴다.
+// 따라서 그리기마다 데이터가 달라도 프레임마다 descriptor를 갱신하지 않는다.
+//
+//   binding 0: uniform buffer (dynamic), 최대 kMaxRange 바이트
+//   binding 1: storage buffer (dynamic), 최대 kMaxRange 바이트
+class VkFrameAllocator {
+public:
+    static constexpr uint32_t kUniformBufferBinding = 0;
+    static constexpr uint32_t kStorageBufferBinding = 1;
+
+    // 하나의 할당이 가질 수 있는 최대 크기. 장치의 maxUniformBufferRange보다 크면 그 값으로 줄인다.
+    static constexpr VkDeviceSize kMaxRange = 64 * 1024;
+
+    VkFrameAllocator(VkDevice device,
+                     const VkPhysicalDeviceProperties &physicalDeviceProperties,
+                     VkMemoryAllocator *memoryAllocator,
+                     uint32_t frameCount,
+                     VkDeviceSize frameSize);
+    ~VkFrameAllocator();
+
+    VkFrameAllocator(const VkFrameAllocator &) = delete;
+    VkFrameAllocator &operator=(const VkFrameAllocator &) = delete;
+
+    // 프레임 슬롯의 이전 프레임이 GPU에서 끝난 후에 호출한다. 슬롯의 모든 할당을 해제한다.
+    void beginFrame(uint32_t frameIndex);
+
+    // 현재 프레임 슬롯에서 size 바이트를 할당한다. 여러 스레드에서 동시에 호출할 수 있다.
+    // 공간이 부족하면 false를 반환하고 overflowCount를 증가시킨다.
+    bool allocate(VkDeviceSize size, VkFrameAllocation *allocation);
+
+    // data를 복사하는 allocate.
+    bool push(const void *data, VkDeviceSize size, VkFrameAllocation *allocation);
+
+    // uniformOffset, storageOffset의 데이터를 셰이더에서 읽을 수 있도록 바인드한다.
+    void bind(VkCommandBuffer commandBuffer,
+              VkPipelineLayout pipelineLayout,
+              uint32_t set,
+              uint32_t uniformOffset,
+              uint32_t storageOffset = 0) const;
+
+    VkDescriptorSetLayout layout() const { return mDescriptorSetLayout; }
+
+    VkDeviceSize maxRange() const { return mMaxRange; }
+
+    VkFrameAllocatorStats stats() const;
+
+private:
+    VkDevice mDevice;
+    VkMemoryAllocator *mMemoryAllocator;
+    VkDeviceSize mAlignment;  // dynamic offset이 만족해야 하는 정렬
+    VkDeviceSize mMaxRange;
+    VkDeviceSize mFrameSize;
+    VkBuffer mBuffer;
+    VkAllocation mAllocation;
+    VkDescriptorSetLayout mDescriptorSetLayout;
+    VkDescriptorPool mDescriptorPool;
+    VkDescriptorSet mDescriptorSet;
+    VkDeviceSize mFrameBegin{0};                  // 현재 프레임 슬롯의 시작 위치
+    std::atomic<VkDeviceSize> mFrameHead{0};      // 현재 프레임 슬롯에서 요청된 크기. 실패한 할당도 포함한다.
+    std::atomic<uint64_t> mOverflowCount{0};
+    VkDeviceSize mLastFrameSize{0};
+    VkDeviceSize mHighWaterMark{0};
+    bool mFrameBegun{false};
+};
+
+#endif //PRACTICE_VULKAN_VKFRAMEALLOCATOR_H
@@ -0,0 +1,109 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include "VkFramePacer.h"
+
+using namespace std;
+
+uint64_t VkSteadyFrameClock::now() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void VkSteadyFrameClock::sleepUntil(uint64_t time) {
+    this_thread::sleep_until(chrono::steady_clock::time_point(chrono::nanoseconds(time)));
+}
+
+VkFramePacer::VkFramePacer(VkFrameClock *clock, uint64_t targetInterval)
+        : mClock(clock),
+          mTargetInterval(targetInterval) {
+    assert(mClock);
+}
+
+uint64_t VkFramePacer::frameInterval() const {
+    // 디스플레이 주기의 배수가 아니면 프레임마다 화면에 보이는 시간이 달라져서 끊겨 보인다.
+    auto refreshInterval = this->refreshInterval();
+    auto multiple = (mTargetInterval + refreshInterval / 2) / refreshInterval;
+    return refreshInterval * max<uint64_t>(multiple, 1);
+}
+
+void VkFramePacer::beginFrame() {
+    auto now = mClock->now();
+
+    mFrameMultiple = 1;
+    if (calibrated() && mNextFrameTime != 0 && now < mNextFrameTime) {
+        mClock->sleepUntil(mNextFrameTime);
+        now = mClock->now();
+        mFrameMultiple = max<uint64_t>(frameInterval() / refreshInterval(), 1);
+    }
+
+    // 한 프레임 이상 늦었다면 밀린 프레임을 따라잡지 않고 지금부터 다시 맞춘다.
+    auto frameStartTime = mNextFrameTime;
+    if (mNextFrameTime == 0 || now >= mNextFrameTime + frameInterval()) {
+        frameStartTime = now;
+    }
+
+    mNextFrameTime = frameStartTime + frameInterval();
+}
+
+void VkFramePacer::endFrame() {
+    auto now = mClock->now();
+
+    // CPU를 재운 프레임은 디스플레이 주기의 mFrameMultiple배 간격으로 출력되므로 그만큼 나눠서 측정한다.
+    // 재운 프레임도 측정해야 주사율이 바뀌었을 때 추정한 값이 따라간다.
+    if (mLastPresentTime != 0) {
+        mPresentIntervals[mPresentIntervalCount % mPresentIntervals.size()] = (now - mLastPresentTime) / mFrameMultiple;
+        ++mPresentIntervalCount;
+        updateRefreshInterval();
+    }
+
+    mLastPresentTime = now;
+    ++mFrameCount;
+}
+
+void VkFramePacer::setRefreshDuration(uint64_t refreshDuration) {
+    mRefreshDuration = refreshDuration;
+}
+
+void VkFramePacer::reset() {
+    mNextFrameTime = 0;
+    mLastPresentTime = 0;
+    mPresentIntervalCount = 0;
+    mRefreshDuration = 0;
+}
+
+void VkFramePacer::updateRefreshInterval() {
+    // 디스플레이가 주기를 알려줘도 측정은 계속하므로 calibrated()가 아니라 측정한 개수로 판단한다.
+    if (mPresentIntervalCount < kCalibrationFrameCount) {
+        return;
+    }
+
+    // 가끔 늦어지는 프레임에 흔들리지 않도록 중앙값을 사용한다.
+    auto intervals = mPresentIntervals;
+    nth_element(intervals.begin(), intervals.begin() + intervals.size() / 2, intervals.end());
+
+    // present가 기다리지 않는 경우(MAILBOX 등)에도 CPU를 쉬지 않고 돌리지 않도록 하한을 둔다.
+    mRefreshInterval = max(intervals[intervals.size() / 2], kMinRefreshInterval);
+}
@@ -0,0 +1,99 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKFRAMEPACER_H
+#define PRACTICE_VULKAN_VKFRAMEPACER_H
+
+#include <array>
+#include <cstdint>
+
+// 프레임 간격을 맞추는데 사용하는 시계. 단위는 나노초.
+// 테스트에서는 시간을 직접 움직이는 시계로 바꿔서 사용한다.
+class VkFrameClock {
+public:
+    virtual ~VkFrameClock() = default;
+
+    virtual uint64_t now() = 0;
+
+    // time이 될 때까지 스레드를 재운다.
+    virtual void sleepUntil(uint64_t time) = 0;
+};
+
+// steady_clock을 사용하는 기본 시계.
+class VkSteadyFrameClock : public VkFrameClock {
+public:
+    uint64_t now() override;
+    void sleepUntil(uint64_t time) override;
+};
+
+// 프레임을 디스플레이 주기(또는 그 배수)에 맞춰 시작하도록 CPU를 재운다.
+// VK_GOOGLE_display_timing이 알려준 디스플레이 주기가 있으면 그것을 사용한다.
+// 없으면 present가 끝난 시간의 간격으로 추정한다. FIFO에서는 present가 수직 동기화에 맞춰 반환되므로
+// 그 간격이 곧 디스플레이 주기다. 처음(또는 reset 후) kCalibrationFrameCount 프레임은 재우지 않고 간격만 측정한다.
+class VkFramePacer {
+public:
+    // targetInterval이 0이면 디스플레이 주기마다, 아니면 가장 가까운 디스플레이 주기의 배수마다 프레임을 시작한다.
+    explicit VkFramePacer(VkFrameClock *clock, uint64_t targetInterval = 0);
+
+    // 다음 프레임을 시작할 시간까지 기다린다.
+    void beginFrame();
+
+    // present 직후에 호출한다.
+    void endFrame();
+
+    // VK_GOOGLE_display_timing의 refreshDuration. 0이면 present 간격으로 추정한 값을 사용한다.
+    // 주사율이 바뀌거나 출력 방식이 바뀌어도 바로 따라가도록 프레임마다 호출한다.
+    void setRefreshDuration(uint64_t refreshDuration);
+
+    // 일시정지 후 다시 시작할 때 호출한다. 멈춰있던 시간을 밀린 프레임으로 보지 않고 디스플레이 주기를 다시 측정한다.
+    void reset();
+
+    // 추정한 디스플레이 주기.
+    uint64_t refreshInterval() const { return mRefreshDuration ? mRefreshDuration : mRefreshInterval; }
+
+    // 실제로 사용하는 프레임 간격.
+    uint64_t frameInterval() const;
+
+    uint64_t frameCount() const { return mFrameCount; }
+
+    bool calibrated() const { return mRefreshDuration != 0 || mPresentIntervalCount >= kCalibrationFrameCount; }
+
+    static constexpr uint64_t kDefaultRefreshInterval = 16'666'667; // 60Hz
+    static constexpr uint64_t kMinRefreshInterval = 4'166'667;      // 240Hz
+    static constexpr uint32_t kCalibrationFrameCount = 15;
+
+private:
+    void updateRefreshInterval();
+
+    VkFrameClock *mClock;
+    uint64_t mTargetInterval;
+    uint64_t mRefreshInterval{kDefaultRefreshInterval}; // present 간격으로 추정한 디스플레이 주기
+    uint64_t mRefreshDuration{0};                       // 0이면 디스플레이가 주기를 알려주지 않았다.
+    uint64_t mFrameMultiple{1};   // 이번 프레임을 재울 때 사용한 프레임 간격이 추정한 디스플레이 주기의 몇 배인지
+    uint64_t mNextFrameTime{0};   // 0이면 바로 시작한다.
+    uint64_t mLastPresentTime{0}; // 0이면 측정할 이전 present가 없다.
+    std::array<uint64_t, kCalibrationFrameCount> mPresentIntervals{};
+    uint32_t mPresentIntervalCount{0};
+    uint64_t mFrameCount{0};
+};
+
+#endif //PRACTICE_VULKAN_VKFRAMEPACER_H
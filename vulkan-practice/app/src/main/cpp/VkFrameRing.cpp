@@ -0,0 +1,115 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cassert>
+
+#include "VkFrameRing.h"
+#include "VkTrace.h"
+#include "VkUtil.h"
+
+using namespace std;
+
+VkFrameRing::VkFrameRing(VkDevice device, VkDeviceQueues *deviceQueues, uint32_t queueFamilyIndex, uint32_t frameCount)
+        : mDevice(device),
+          mDeviceQueues(deviceQueues),
+          mFrames(frameCount) {
+    assert(frameCount > 0);
+
+    // ================================================================================
+    // 1. 프레임마다 사용할 VkCommandPool 생성, VkCommandBuffer 할당
+    // ================================================================================
+    // command buffer를 하나씩 초기화하지 않고 VkCommandPool 전체를 초기화하므로 RESET_COMMAND_BUFFER가 필요 없다.
+    VkCommandPoolCreateInfo commandPoolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, // command buffer가 자주 변경될 것임을 알려줌
+            .queueFamilyIndex = queueFamilyIndex
+    };
+
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+    };
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
+    };
+
+    for (auto &frame : mFrames) {
+        VK_CHECK_ERROR(vkCreateCommandPool(mDevice, &commandPoolCreateInfo, nullptr, &frame.commandPool));
+
+        commandBufferAllocateInfo.commandPool = frame.commandPool;
+        VK_CHECK_ERROR(vkAllocateCommandBuffers(mDevice,
+                                                &commandBufferAllocateInfo,
+                                                &frame.commandBuffer));
+
+        // ================================================================================
+        // 2. 프레임마다 사용할 VkSemaphore 생성
+        // ================================================================================
+        // 출력을 기다리는 semaphore는 어느 프레임이 Signal 할지 이미지를 얻어야 알 수 있으므로
+        // 프레임 슬롯이 아니라 스왑체인 이미지마다 둔다. VkRenderer::createSwapchain을 참고한다.
+        VK_CHECK_ERROR(vkCreateSemaphore(mDevice,
+                                         &semaphoreCreateInfo,
+                                         nullptr,
+                                         &frame.acquireSemaphore));
+
+        // 첫 번째 프레임에서는 기다릴 제출이 없다.
+        frame.ticket = {};
+    }
+}
+
+VkFrameRing::~VkFrameRing() {
+    waitIdle();
+
+    for (auto &frame : mFrames) {
+        vkDestroySemaphore(mDevice, frame.acquireSemaphore, nullptr);
+        vkDestroyCommandPool(mDevice, frame.commandPool, nullptr); // commandBuffer도 함께 해제된다.
+    }
+    mFrames.clear();
+}
+
+VkFrame &VkFrameRing::beginFrame() {
+    VK_TRACE_SCOPE("WaitFrame");
+
+    auto &frame = mFrames[mFrameIndex];
+
+    // 이 슬롯을 마지막으로 사용한 프레임(= frameCount 프레임 전)이 끝날 때까지만 기다린다.
+    mDeviceQueues->wait(frame.ticket);
+
+    // 슬롯의 command buffer가 더 이상 사용되지 않으므로 VkCommandPool 전체를 한 번에 초기화한다.
+    VK_CHECK_ERROR(vkResetCommandPool(mDevice, frame.commandPool, 0));
+
+    return frame;
+}
+
+void VkFrameRing::endFrame() {
+    mFrameIndex = (mFrameIndex + 1) % frameCount();
+    ++mFrameNumber;
+}
+
+void VkFrameRing::waitIdle() {
+    // 같은 큐의 ticket은 값이 커지는 순서로 끝나므로 가장 최근 프레임만 기다려도 되지만
+    // 슬롯마다 다른 큐에 제출했을 수도 있으므로 모두 기다린다.
+    for (const auto &frame : mFrames) {
+        mDeviceQueues->wait(frame.ticket);
+    }
+}
@@ -0,0 +1,73 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKFRAMERING_H
+#define PRACTICE_VULKAN_VKFRAMERING_H
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "VkDeviceQueues.h"
+
+// 한 프레임을 기록하고 제출하는데 필요한 객체들.
+// 프레임마다 독립된 객체를 사용하기 때문에 GPU가 N번째 프레임을 처리하는 동안 CPU는 N+1번째 프레임을 기록할 수 있다.
+struct VkFrame {
+    VkCommandPool commandPool;           // 슬롯을 다시 사용할 때 한 번에 초기화한다.
+    VkCommandBuffer commandBuffer;
+    VkSemaphore acquireSemaphore;        // 스왑체인 이미지를 사용할 수 있을 때 Signal
+    VkQueueTicket ticket;                // 이 프레임의 마지막 제출. 끝나면 이 슬롯을 다시 사용할 수 있다.
+};
+
+class VkFrameRing {
+public:
+    VkFrameRing(VkDevice device, VkDeviceQueues *deviceQueues, uint32_t queueFamilyIndex, uint32_t frameCount);
+    ~VkFrameRing();
+
+    VkFrameRing(const VkFrameRing &) = delete;
+    VkFrameRing &operator=(const VkFrameRing &) = delete;
+
+    // 다음 프레임 슬롯이 GPU에서 사용이 끝날 때까지 기다린 후 슬롯의 VkCommandPool을 초기화해서 반환한다.
+    // 제출한 후에는 VkDeviceQueues::submit이 반환한 ticket을 슬롯에 저장해야 한다.
+    VkFrame &beginFrame();
+
+    // 다음 프레임 슬롯으로 넘어간다.
+    void endFrame();
+
+    // 모든 프레임 슬롯의 실행이 끝날 때까지 기다린다.
+    void waitIdle();
+
+    uint32_t frameIndex() const { return mFrameIndex; }
+
+    uint32_t frameCount() const { return static_cast<uint32_t>(mFrames.size()); }
+
+    uint64_t frameNumber() const { return mFrameNumber; }
+
+private:
+    VkDevice mDevice;
+    VkDeviceQueues *mDeviceQueues;
+    std::vector<VkFrame> mFrames;
+    uint32_t mFrameIndex{0};
+    uint64_t mFrameNumber{0};
+};
+
+#endif //PRACTICE_VULKAN_VKFRAMERING_H
@@ -0,0 +1,265 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+#include "VkGpuProfiler.h"
+#include "VkUtil.h"
+#include "AndroidOut.h"
+
+using namespace std;
+
+VkGpuProfiler::VkGpuProfiler(VkDevice device,
+                             const VkPhysicalDeviceProperties &physicalDeviceProperties,
+                             uint32_t timestampValidBits,
+                             uint32_t frameCount,
+                             uint32_t maxScopeCount)
+        : mDevice(device),
+          mTimestampPeriod(physicalDeviceProperties.limits.timestampPeriod),
+          mTimestampMask(timestampValidBits >= 64 ? UINT64_MAX : (uint64_t{1} << timestampValidBits) - 1),
+          mMaxScopeCount(maxScopeCount),
+          mSlots(frameCount) {
+    assert(frameCount > 0 && maxScopeCount > 0);
+
+    if (timestampValidBits == 0) {
+        aout << "Timestamp queries are not supported, GPU profiling is disabled." << endl;
+        return;
+    }
+
+    // ================================================================================
+    // 1. 타임스탬프 VkQueryPool 생성
+    // ================================================================================
+    // 프레임 슬롯마다 구간의 시작과 끝을 기록할 쿼리를 따로 둔다.
+    VkQueryPoolCreateInfo queryPoolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .queryType = VK_QUERY_TYPE_TIMESTAMP,
+            .queryCount = frameCount * maxScopeCount * 2
+    };
+
+    VK_CHECK_ERROR(vkCreateQueryPool(mDevice, &queryPoolCreateInfo, nullptr, &mQueryPool));
+}
+
+VkGpuProfiler::~VkGpuProfiler() {
+    if (enabled()) {
+        vkDestroyQueryPool(mDevice, mQueryPool, nullptr);
+    }
+}
+
+void VkGpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+    if (!enabled()) {
+        return;
+    }
+
+    assert(frameIndex < mSlots.size());
+    assert(mDepth == 0); // 이전 프레임의 구간이 모두 끝나야 한다.
+
+    // ================================================================================
+    // 1. 이 슬롯에서 이전에 측정한 결과 읽기
+    // ================================================================================
+    auto &slot = mSlots[frameIndex];
+    if (!slot.scopes.empty()) {
+        collect(slot, frameIndex);
+    }
+
+    // ================================================================================
+    // 2. 이 슬롯의 쿼리 초기화
+    // ================================================================================
+    vkCmdResetQueryPool(commandBuffer, mQueryPool, frameIndex * mMaxScopeCount * 2, mMaxScopeCount * 2);
+
+    slot.frameNumber = mFrameNumber++;
+    slot.cpuTime = vkTraceNow();
+    slot.scopes.clear();
+    mFrameIndex = frameIndex;
+}
+
+uint32_t VkGpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char *name) {
+    if (!enabled()) {
+        return UINT32_MAX;
+    }
+
+    auto &slot = mSlots[mFrameIndex];
+    if (slot.scopes.size() == mMaxScopeCount) {
+        return UINT32_MAX; // 쿼리가 부족하면 측정하지 않는다.
+    }
+
+    auto scope = static_cast<uint32_t>(slot.scopes.size());
+    slot.scopes.push_back({name, mDepth++});
+
+    vkCmdWriteTimestamp(commandBuffer,
+                        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                        mQueryPool,
+                        (mFrameIndex * mMaxScopeCount + scope) * 2);
+
+    return scope;
+}
+
+void VkGpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+    if (scope == UINT32_MAX) {
+        return;
+    }
+
+    assert(mDepth > 0);
+    mDepth--;
+
+    // 앞의 모든 명령이 끝난 시점을 기록한다.
+    vkCmdWriteTimestamp(commandBuffer,
+                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        mQueryPool,
+                        (mFrameIndex * mMaxScopeCount + scope) * 2 + 1);
+}
+
+vector<VkGpuTiming> VkGpuProfiler::timings() const {
+    vector<VkGpuTiming> timings;
+
+    for (const auto &[name, history]: mHistories) {
+        if (history.empty()) {
+            continue;
+        }
+
+        vector<double> samples(history.begin(), history.end());
+        sort(samples.begin(), samples.end());
+
+        VkGpuTiming timing{
+                .name = name,
+                .sampleCount = static_cast<uint32_t>(samples.size()),
+                .lastTime = history.back(),
+                .averageTime = accumulate(samples.begin(), samples.end(), 0.0) / samples.size(),
+                .minTime = samples.front(),
+                .maxTime = samples.back(),
+                .p50Time = samples[samples.size() / 2],
+                .p95Time = samples[min(samples.size() - 1, samples.size() * 95 / 100)],
+                .histogram{}
+        };
+
+        auto range = timing.maxTime - timing.minTime;
+        for (auto sample: samples) {
+            auto bin = range > 0.0
+                       ? static_cast<uint32_t>((sample - timing.minTime) / range * VkGpuTiming::kHistogramBinCount)
+                       : 0;
+            timing.histogram[min(bin, VkGpuTiming::kHistogramBinCount - 1)]++;
+        }
+
+        timings.push_back(std::move(timing));
+    }
+
+    return timings;
+}
+
+void VkGpuProfiler::collectTrace(vector<VkTraceEvent> *events, vector<VkTraceThread> *threads) const {
+    if (mTraceEvents.empty()) {
+        return;
+    }
+
+    uint32_t maxDepth = 0;
+    for (const auto &event: mTraceEvents) {
+        events->push_back({
+                .name = event.name,
+                .pid = kVkTraceGpuPid,
+                .tid = event.depth,
+                .beginTime = static_cast<uint64_t>(static_cast<int64_t>(event.beginTime) + mCpuTimeOffset),
+                .duration = event.duration,
+                .frameNumber = event.frameNumber
+        });
+        maxDepth = max(maxDepth, event.depth);
+    }
+
+    for (uint32_t depth = 0; depth <= maxDepth; ++depth) {
+        threads->push_back({kVkTraceGpuPid, depth, "Depth " + to_string(depth)});
+    }
+}
+
+bool VkGpuProfiler::writeChromeTrace(const string &path) const {
+    vector<VkTraceEvent> events;
+    vector<VkTraceThread> threads;
+    collectTrace(&events, &threads);
+
+    return vkWriteChromeTrace(path, events, threads);
+}
+
+void VkGpuProfiler::collect(Slot &slot, uint32_t frameIndex) {
+    // ================================================================================
+    // 1. 쿼리 결과 읽기
+    // ================================================================================
+    // WAIT 없이 읽고 availability 값으로 쓰여진 쿼리만 사용한다. 슬롯의 제출이 끝나기를 기다린 후이므로 보통 모두 쓰여져 있다.
+    auto queryCount = static_cast<uint32_t>(slot.scopes.size() * 2);
+    mTimestamps.resize(queryCount * 2);
+
+    auto result = vkGetQueryPoolResults(mDevice,
+                                        mQueryPool,
+                                        frameIndex * mMaxScopeCount * 2,
+                                        queryCount,
+                                        mTimestamps.size() * sizeof(uint64_t),
+                                        mTimestamps.data(),
+                                        sizeof(uint64_t) * 2,
+                                        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result != VK_SUCCESS && result != VK_NOT_READY) {
+        return;
+    }
+
+    // ================================================================================
+    // 2. 구간별 시간 계산
+    // ================================================================================
+    for (uint32_t i = 0; i != slot.scopes.size(); ++i) {
+        auto begin = mTimestamps[i * 4];
+        auto beginAvailable = mTimestamps[i * 4 + 1];
+        auto end = mTimestamps[i * 4 + 2];
+        auto endAvailable = mTimestamps[i * 4 + 3];
+        if (!beginAvailable || !endAvailable) {
+            continue;
+        }
+
+        if (!mHasFirstTimestamp) {
+            mFirstTimestamp = begin;
+            mHasFirstTimestamp = true;
+        }
+
+        // validBits보다 위의 비트는 정의되지 않으므로 마스크를 씌워서 값이 한 바퀴 돈 경우도 처리한다.
+        auto duration = static_cast<double>((end - begin) & mTimestampMask) * mTimestampPeriod; // 나노초
+        auto beginTime = static_cast<double>((begin - mFirstTimestamp) & mTimestampMask) * mTimestampPeriod;
+
+        // GPU는 command buffer 기록이 시작된 후에야 실행할 수 있으므로 그 차이가 가장 큰 값을 두 시계의 차이로 사용한다.
+        // 이렇게 맞추면 트레이스에서 GPU 구간이 그 프레임을 기록한 CPU 구간보다 앞서지 않는다.
+        if (i == 0) {
+            mCpuTimeOffset = max(mCpuTimeOffset, static_cast<int64_t>(slot.cpuTime) - static_cast<int64_t>(beginTime));
+        }
+
+        const auto &scope = slot.scopes[i];
+        auto &history = mHistories[scope.name];
+        history.push_back(duration / 1000000.0);
+        if (history.size() > kHistoryLength) {
+            history.pop_front();
+        }
+
+        mTraceEvents.push_back({
+                .name = scope.name,
+                .frameNumber = slot.frameNumber,
+                .beginTime = static_cast<uint64_t>(beginTime),
+                .duration = static_cast<uint64_t>(duration),
+                .depth = scope.depth
+        });
+        if (mTraceEvents.size() > kMaxTraceEventCount) {
+            mTraceEvents.pop_front();
+        }
+    }
+}
@@ -0,0 +1,145 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKGPUPROFILER_H
+#define PRACTICE_VULKAN_VKGPUPROFILER_H
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "VkTrace.h"
+
+// 하나의 구간에 대해 최근 프레임들의 GPU 시간 통계. 단위는 밀리초.
+struct VkGpuTiming {
+    static constexpr uint32_t kHistogramBinCount = 16;
+
+    std::string name;
+    uint32_t sampleCount;
+    double lastTime;
+    double averageTime;
+    double minTime;
+    double maxTime;
+    double p50Time;
+    double p95Time;
+    std::array<uint32_t, kHistogramBinCount> histogram; // [minTime, maxTime]를 균등하게 나눈 구간별 샘플 수
+};
+
+// 타임스탬프 쿼리로 command buffer 안의 구간별 GPU 실행 시간을 측정한다.
+// 결과는 같은 프레임 슬롯을 다시 사용할 때 읽으므로 frames-in-flight만큼 늦게 반영되고 CPU가 GPU를 기다리지 않는다.
+class VkGpuProfiler {
+public:
+    static constexpr uint32_t kHistoryLength = 256;     // 통계에 사용하는 최근 샘플 수
+    static constexpr uint32_t kMaxTraceEventCount = 16384;
+
+    // timestampValidBits가 0이면 타임스탬프를 지원하지 않는 큐이므로 아무것도 측정하지 않는다.
+    VkGpuProfiler(VkDevice device,
+                  const VkPhysicalDeviceProperties &physicalDeviceProperties,
+                  uint32_t timestampValidBits,
+                  uint32_t frameCount,
+                  uint32_t maxScopeCount = 32);
+    ~VkGpuProfiler();
+
+    VkGpuProfiler(const VkGpuProfiler &) = delete;
+    VkGpuProfiler &operator=(const VkGpuProfiler &) = delete;
+
+    // 프레임 슬롯의 이전 결과를 읽어오고 쿼리를 초기화한다.
+    // 슬롯의 제출이 끝나기를 기다린 후에 command buffer의 맨 앞에서 호출해야 한다.
+    void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+    // 반환된 값을 endScope에 넘긴다. 구간은 중첩될 수 있다.
+    uint32_t beginScope(VkCommandBuffer commandBuffer, const char *name);
+    void endScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+    bool enabled() const { return mQueryPool != VK_NULL_HANDLE; }
+
+    std::vector<VkGpuTiming> timings() const;
+
+    // 측정된 GPU 구간을 CPU 트레이스와 같은 시간축으로 옮겨서 모은다. 중첩 깊이가 tid가 된다.
+    void collectTrace(std::vector<VkTraceEvent> *events, std::vector<VkTraceThread> *threads) const;
+
+    // chrome://tracing이나 Perfetto에서 열 수 있는 JSON 파일로 저장한다.
+    bool writeChromeTrace(const std::string &path) const;
+
+private:
+    struct Scope {
+        std::string name;
+        uint32_t depth;
+    };
+
+    struct Slot {
+        uint64_t frameNumber;
+        uint64_t cpuTime; // 이 슬롯의 command buffer 기록을 시작한 CPU 시간
+        std::vector<Scope> scopes;
+    };
+
+    struct TraceEvent {
+        std::string name;
+        uint64_t frameNumber;
+        uint64_t beginTime; // 첫 타임스탬프부터의 GPU 시간, 나노초
+        uint64_t duration;  // 나노초
+        uint32_t depth;
+    };
+
+    void collect(Slot &slot, uint32_t frameIndex);
+
+    VkDevice mDevice;
+    double mTimestampPeriod; // 타임스탬프 1틱의 나노초
+    uint64_t mTimestampMask;
+    uint32_t mMaxScopeCount;
+    VkQueryPool mQueryPool{VK_NULL_HANDLE};
+    std::vector<Slot> mSlots;
+    uint32_t mFrameIndex{0};
+    uint64_t mFrameNumber{0};
+    uint32_t mDepth{0};
+    uint64_t mFirstTimestamp{0};
+    bool mHasFirstTimestamp{false};
+    int64_t mCpuTimeOffset{INT64_MIN}; // GPU 시간에 더하면 CPU 시간이 되는 값
+    std::vector<uint64_t> mTimestamps;
+    std::map<std::string, std::deque<double>> mHistories; // 구간 이름 -> 최근 GPU 시간, 밀리초
+    std::deque<TraceEvent> mTraceEvents;
+};
+
+// 생성될 때 beginScope, 파괴될 때 endScope를 호출한다.
+class VkGpuScope {
+public:
+    VkGpuScope(VkGpuProfiler *profiler, VkCommandBuffer commandBuffer, const char *name)
+            : mProfiler(profiler),
+              mCommandBuffer(commandBuffer),
+              mScope(profiler->beginScope(commandBuffer, name)) {}
+
+    ~VkGpuScope() { mProfiler->endScope(mCommandBuffer, mScope); }
+
+    VkGpuScope(const VkGpuScope &) = delete;
+    VkGpuScope &operator=(const VkGpuScope &) = delete;
+
+private:
+    VkGpuProfiler *mProfiler;
+    VkCommandBuffer mCommandBuffer;
+    uint32_t mScope;
+};
+
+#endif //PRACTICE_VULKAN_VKGPUPROFILER_H
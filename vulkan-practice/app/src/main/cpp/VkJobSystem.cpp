@@ -0,0 +1,243 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cassert>
+
+#include "VkJobSystem.h"
+#include "VkTrace.h"
+
+using namespace std;
+
+// 작업 스레드가 어느 작업 시스템의 몇 번 스레드인지. 작업 시스템을 만든 스레드는 기록하지 않는다.
+thread_local const VkJobSystem *tJobSystem{nullptr};
+thread_local uint32_t tThreadIndex{0};
+
+VkJobSystem::VkJobSystem(uint32_t threadCount)
+        : mOwnerThread(this_thread::get_id()) {
+    if (threadCount == 0) {
+        threadCount = max(thread::hardware_concurrency(), 1u);
+    }
+
+    // ================================================================================
+    // 1. 스레드마다 작업 큐와 작업 링 버퍼 생성
+    // ================================================================================
+    for (uint32_t i = 0; i != threadCount; ++i) {
+        mWorkQueues.push_back(make_unique<WorkQueue>());
+        mJobRings.emplace_back();
+        mJobRings.back().blocks.push_back(make_unique<VkJob[]>(kJobRingBlockSize));
+        mJobRings.back().next = 0;
+    }
+
+    // ================================================================================
+    // 2. 작업 스레드 생성
+    // ================================================================================
+    for (uint32_t i = 1; i < threadCount; ++i) {
+        mWorkers.emplace_back(&VkJobSystem::workerMain, this, i);
+    }
+}
+
+VkJobSystem::~VkJobSystem() {
+    {
+        lock_guard<mutex> lock(mSleepMutex);
+        mStop = true;
+    }
+    mSleepCondition.notify_all();
+
+    for (auto &worker : mWorkers) {
+        worker.join();
+    }
+}
+
+VkJob *VkJobSystem::create(VkJobFunction function, VkJob *parent) {
+    auto &jobRing = mJobRings[threadIndex()];
+    auto capacity = static_cast<uint32_t>(jobRing.blocks.size()) * kJobRingBlockSize;
+
+    // ================================================================================
+    // 1. 끝난 작업의 자리 찾기
+    // ================================================================================
+    // 보통은 다음 자리가 비어있다. 링 버퍼가 한 바퀴 돌았을 때 아직 진행중인 작업이 있으면 건너뛴다.
+    VkJob *job = nullptr;
+    for (uint32_t i = 0; i != capacity; ++i) {
+        auto index = (jobRing.next + i) % capacity;
+        auto candidate = &jobRing.blocks[index / kJobRingBlockSize][index % kJobRingBlockSize];
+        if (candidate->unfinishedCount.load(memory_order_acquire) == 0) {
+            job = candidate;
+            jobRing.next = (index + 1) % capacity;
+            break;
+        }
+    }
+
+    // ================================================================================
+    // 2. 모두 진행중이면 링 버퍼 늘리기
+    // ================================================================================
+    if (job == nullptr) {
+        jobRing.blocks.push_back(make_unique<VkJob[]>(kJobRingBlockSize));
+        job = &jobRing.blocks.back()[0];
+        jobRing.next = capacity + 1;
+    }
+
+    job->function = std::move(function);
+    job->parent = parent;
+    job->unfinishedCount.store(1, memory_order_relaxed);
+    if (parent != nullptr) {
+        parent->unfinishedCount.fetch_add(1, memory_order_relaxed);
+    }
+
+    return job;
+}
+
+void VkJobSystem::run(VkJob *job) {
+    auto &workQueue = *mWorkQueues[threadIndex()];
+    {
+        lock_guard<mutex> lock(workQueue.mutex);
+        workQueue.jobs.push_back(job);
+    }
+    mQueuedCount.fetch_add(1);
+
+    // 잠든 스레드가 있을 때만 깨운다. mSleepMutex를 잡아서 잠들기 직전의 스레드가 알림을 놓치지 않게 한다.
+    if (mSleepingCount.load() > 0) {
+        lock_guard<mutex> lock(mSleepMutex);
+        mSleepCondition.notify_one();
+    }
+}
+
+void VkJobSystem::wait(const VkJob *job) {
+    auto index = threadIndex();
+
+    // 기다리는 동안 놀지 않고 다른 작업을 실행한다. 기다리는 작업의 자식도 이렇게 실행될 수 있다.
+    while (!isComplete(job)) {
+        auto nextJob = pop(index);
+        if (nextJob == nullptr) {
+            nextJob = steal(index);
+        }
+
+        if (nextJob != nullptr) {
+            execute(nextJob);
+        } else {
+            this_thread::yield();
+        }
+    }
+}
+
+void VkJobSystem::parallelFor(uint32_t count,
+                              uint32_t grainSize,
+                              const function<void(uint32_t begin, uint32_t end)> &function) {
+    assert(grainSize > 0);
+
+    auto root = create({});
+    for (uint32_t begin = 0; begin < count; begin += grainSize) {
+        auto end = min(begin + grainSize, count);
+        run(create([&function, begin, end] { function(begin, end); }, root));
+    }
+    run(root);
+    wait(root);
+}
+
+uint32_t VkJobSystem::threadIndex() const {
+    if (tJobSystem == this) {
+        return tThreadIndex;
+    }
+
+    // 작업 스레드가 아니면 작업 시스템을 만든 스레드여야 한다.
+    assert(this_thread::get_id() == mOwnerThread);
+    return 0;
+}
+
+void VkJobSystem::workerMain(uint32_t threadIndex) {
+    VK_TRACE_THREAD_NAME("JobWorker");
+
+    tJobSystem = this;
+    tThreadIndex = threadIndex;
+
+    while (!mStop.load()) {
+        auto job = pop(threadIndex);
+        if (job == nullptr) {
+            job = steal(threadIndex);
+        }
+
+        if (job != nullptr) {
+            execute(job);
+            continue;
+        }
+
+        // 모든 큐가 비어있으면 새 작업이 들어올 때까지 잠든다.
+        unique_lock<mutex> lock(mSleepMutex);
+        mSleepingCount.fetch_add(1);
+        mSleepCondition.wait(lock, [this] { return mStop.load() || mQueuedCount.load() > 0; });
+        mSleepingCount.fetch_sub(1);
+    }
+
+    tJobSystem = nullptr;
+}
+
+VkJob *VkJobSystem::pop(uint32_t threadIndex) {
+    auto &workQueue = *mWorkQueues[threadIndex];
+
+    lock_guard<mutex> lock(workQueue.mutex);
+    if (workQueue.jobs.empty()) {
+        return nullptr;
+    }
+
+    // 마지막에 넣은 작업이 캐시에 남아있을 가능성이 높다.
+    auto job = workQueue.jobs.back();
+    workQueue.jobs.pop_back();
+    mQueuedCount.fetch_sub(1);
+    return job;
+}
+
+VkJob *VkJobSystem::steal(uint32_t threadIndex) {
+    auto queueCount = static_cast<uint32_t>(mWorkQueues.size());
+
+    // 다음 스레드부터 차례로 훔칠 작업을 찾는다.
+    for (uint32_t i = 1; i < queueCount; ++i) {
+        auto &workQueue = *mWorkQueues[(threadIndex + i) % queueCount];
+
+        lock_guard<mutex> lock(workQueue.mutex);
+        if (workQueue.jobs.empty()) {
+            continue;
+        }
+
+        // 먼저 넣은 작업은 보통 더 큰 작업을 나누기 전의 것이므로 앞에서 가져간다.
+        auto job = workQueue.jobs.front();
+        workQueue.jobs.pop_front();
+        mQueuedCount.fetch_sub(1);
+        return job;
+    }
+
+    return nullptr;
+}
+
+void VkJobSystem::execute(VkJob *job) {
+    if (job->function) {
+        job->function();
+        job->function = nullptr; // 캡처한 객체를 바로 해제한다.
+    }
+    finish(job);
+}
+
+void VkJobSystem::finish(VkJob *job) {
+    // 마지막으로 끝난 자식이 부모를 끝낸다.
+    if (job->unfinishedCount.fetch_sub(1, memory_order_acq_rel) == 1 && job->parent != nullptr) {
+        finish(job->parent);
+    }
+}
@@ -0,0 +1,115 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKJOBSYSTEM_H
+#define PRACTICE_VULKAN_VKJOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef std::function<void()> VkJobFunction;
+
+// 하나의 작업. 자식 작업이 모두 끝나야 끝난 것으로 본다.
+// 스레드마다 링 버퍼에 미리 만들어두고 돌아가며 다시 사용하므로 직접 만들거나 파괴하지 않는다.
+struct VkJob {
+    VkJobFunction function;
+    VkJob *parent;
+    std::atomic<int32_t> unfinishedCount; // 자기 자신 + 끝나지 않은 자식 작업의 수
+};
+
+// work-stealing 방식의 작업 스케줄러.
+// 스레드마다 작업 큐를 두고 자기 큐에서는 마지막에 넣은 작업부터 꺼내고(LIFO),
+// 자기 큐가 비면 다른 스레드의 큐에서 처음에 넣은 작업부터 훔쳐온다(FIFO).
+// 작업 시스템을 만든 스레드가 0번 스레드이고 작업 스레드는 threadCount - 1개다.
+// 작업을 만들고 실행하는 것은 0번 스레드와 작업 안에서만 할 수 있다.
+class VkJobSystem {
+public:
+    // 스레드마다 미리 만들어두는 작업의 개수. 진행중인 작업이 더 많아지면 이만큼씩 늘린다.
+    static constexpr uint32_t kJobRingBlockSize = 4096;
+
+    // threadCount가 0이면 하드웨어 스레드 수를 사용한다. 1이면 작업 스레드 없이 wait()에서 모든 작업을 실행한다.
+    explicit VkJobSystem(uint32_t threadCount = 0);
+    ~VkJobSystem();
+
+    VkJobSystem(const VkJobSystem &) = delete;
+    VkJobSystem &operator=(const VkJobSystem &) = delete;
+
+    // 작업을 만든다. parent가 있으면 parent는 이 작업이 끝날 때까지 끝나지 않는다.
+    // 만든 작업은 run()으로 실행해야 한다. 부모를 실행하기 전에 자식을 만들어야 한다.
+    VkJob *create(VkJobFunction function, VkJob *parent = nullptr);
+
+    // 현재 스레드의 작업 큐에 넣는다.
+    void run(VkJob *job);
+
+    // job이 끝날 때까지 다른 작업을 실행하면서 기다린다. 작업 안에서 호출해도 교착 상태가 되지 않는다.
+    void wait(const VkJob *job);
+
+    bool isComplete(const VkJob *job) const { return job->unfinishedCount.load(std::memory_order_acquire) == 0; }
+
+    // [0, count)를 grainSize개씩 나눠서 작업으로 실행하고 모두 끝날 때까지 기다린다.
+    void parallelFor(uint32_t count,
+                     uint32_t grainSize,
+                     const std::function<void(uint32_t begin, uint32_t end)> &function);
+
+    uint32_t threadCount() const { return static_cast<uint32_t>(mWorkQueues.size()); }
+
+    // 현재 스레드의 번호. 스레드마다 따로 두는 리소스를 고를 때 사용한다.
+    uint32_t threadIndex() const;
+
+private:
+    // 한 스레드의 작업 큐. 주인 스레드는 뒤에서 넣고 꺼내며, 다른 스레드는 앞에서 훔쳐간다.
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<VkJob *> jobs;
+    };
+
+    // 스레드마다 돌아가며 사용하는 작업들. 블록을 추가해서 늘리므로 이미 나눠준 작업의 주소는 바뀌지 않는다.
+    struct JobRing {
+        std::vector<std::unique_ptr<VkJob[]>> blocks;
+        uint32_t next;
+    };
+
+    void workerMain(uint32_t threadIndex);
+    VkJob *pop(uint32_t threadIndex);
+    VkJob *steal(uint32_t threadIndex);
+    void execute(VkJob *job);
+    void finish(VkJob *job);
+
+    std::thread::id mOwnerThread;
+    std::vector<std::unique_ptr<WorkQueue>> mWorkQueues;
+    std::vector<JobRing> mJobRings;
+    std::atomic<int32_t> mQueuedCount{0};   // 모든 큐에 들어있는 작업의 수
+    std::atomic<int32_t> mSleepingCount{0}; // 일이 없어서 잠든 작업 스레드의 수
+    std::mutex mSleepMutex;
+    std::condition_variable mSleepCondition;
+    std::atomic<bool> mStop{false};
+    std::vector<std::thread> mWorkers;
+};
+
+#endif //PRACTICE_VULKAN_VKJOBSYSTEM_H
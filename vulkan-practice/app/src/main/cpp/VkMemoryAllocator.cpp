@@ -0,0 +1,335 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+#include "VkMemoryAllocator.h"
+#include "VkUtil.h"
+#include "AndroidOut.h"
+
+using namespace std;
+
+VkMemoryAllocator::VkMemoryAllocator(VkDevice device,
+                                     const VkPhysicalDeviceProperties &physicalDeviceProperties,
+                                     const VkPhysicalDeviceMemoryProperties &physicalDeviceMemoryProperties,
+                                     VkDeviceSize blockSize)
+        : mDevice(device),
+          mPhysicalDeviceMemoryProperties(physicalDeviceMemoryProperties),
+          mBufferImageGranularity(physicalDeviceProperties.limits.bufferImageGranularity),
+          mMaxMemoryAllocationCount(physicalDeviceProperties.limits.maxMemoryAllocationCount),
+          mBlockSize(blockSize) {
+    assert(mBlockSize > 0);
+}
+
+VkMemoryAllocator::~VkMemoryAllocator() {
+    for (auto &[key, blocks]: mPools) {
+        for (auto &block: blocks) {
+            if (!block->subAllocator->empty()) {
+                aout << "VkMemoryAllocator is destroyed with " << block->subAllocator->allocationCount()
+                     << " live allocations." << endl;
+            }
+            destroyBlock(block.get());
+        }
+    }
+}
+
+VkResult VkMemoryAllocator::allocate(const VkMemoryRequirements &memoryRequirements,
+                                     const VkAllocationCreateInfo &allocationCreateInfo,
+                                     VkAllocation *allocation) {
+    assert(allocation);
+
+    // ================================================================================
+    // 1. 메모리 타입 인덱스 찾기
+    // ================================================================================
+    uint32_t memoryTypeIndex;
+    if (auto result = vkGetMemoryTypeIndex(mPhysicalDeviceMemoryProperties,
+                                           memoryRequirements,
+                                           allocationCreateInfo.memoryPropertyFlags,
+                                           &memoryTypeIndex); result != VK_SUCCESS) {
+        return result;
+    }
+
+    lock_guard<mutex> lock(mMutex);
+
+    auto key = poolKey(memoryTypeIndex, allocationCreateInfo);
+    auto &blocks = mPools[key];
+    VkMemoryBlock *block = nullptr;
+    VkDeviceSize offset = 0;
+
+    // ================================================================================
+    // 2. 블록의 절반보다 큰 리소스는 전용 메모리 할당
+    // ================================================================================
+    if (memoryRequirements.size > mBlockSize / 2) {
+        unique_ptr<VkMemoryBlock> dedicatedBlock;
+        if (auto result = createBlock(memoryTypeIndex,
+                                      memoryRequirements.size,
+                                      VK_SUB_ALLOCATOR_TYPE_LINEAR,
+                                      true,
+                                      &dedicatedBlock); result != VK_SUCCESS) {
+            return result;
+        }
+
+        dedicatedBlock->poolKey = key;
+        dedicatedBlock->subAllocator->allocate(memoryRequirements.size,
+                                               memoryRequirements.alignment,
+                                               &offset);
+        block = dedicatedBlock.get();
+        blocks.push_back(std::move(dedicatedBlock));
+    }
+
+    // ================================================================================
+    // 3. 기존 블록에서 서브 할당
+    // ================================================================================
+    if (!block) {
+        for (auto &candidate: blocks) {
+            if (!candidate->dedicated &&
+                candidate->subAllocator->allocate(memoryRequirements.size,
+                                                  memoryRequirements.alignment,
+                                                  &offset)) {
+                block = candidate.get();
+                break;
+            }
+        }
+    }
+
+    // ================================================================================
+    // 4. 빈 공간이 없으면 새로운 블록을 할당
+    // ================================================================================
+    if (!block) {
+        // 작은 힙에서 블록 하나가 힙을 다 차지하지 않도록 힙 크기의 1/8로 제한한다.
+        auto heapIndex = mPhysicalDeviceMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+        auto heapSize = mPhysicalDeviceMemoryProperties.memoryHeaps[heapIndex].size;
+        auto blockSize = max(min(mBlockSize, heapSize / 8), memoryRequirements.size);
+
+        // buddy 서브 할당기는 2의 거듭제곱 크기만 사용하므로 블록도 그 크기로 할당해서 버려지는 메모리가 없게 한다.
+        // 힙의 제한은 내림하고 리소스의 크기는 올림해서 리소스가 항상 들어가게 한다.
+        if (allocationCreateInfo.subAllocatorType == VK_SUB_ALLOCATOR_TYPE_BUDDY) {
+            blockSize = max(bit_floor(min(mBlockSize, heapSize / 8)),
+                            bit_ceil(max(memoryRequirements.size, VkBuddySubAllocator::kMinBlockSize)));
+        }
+
+        unique_ptr<VkMemoryBlock> newBlock;
+        if (auto result = createBlock(memoryTypeIndex,
+                                      blockSize,
+                                      allocationCreateInfo.subAllocatorType,
+                                      false,
+                                      &newBlock); result != VK_SUCCESS) {
+            return result;
+        }
+
+        newBlock->poolKey = key;
+        if (!newBlock->subAllocator->allocate(memoryRequirements.size,
+                                              memoryRequirements.alignment,
+                                              &offset)) {
+            destroyBlock(newBlock.get());
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+        block = newBlock.get();
+        blocks.push_back(std::move(newBlock));
+    }
+
+    *allocation = {
+            .memory = block->memory,
+            .offset = offset,
+            .size = memoryRequirements.size,
+            .mappedData = block->mappedData ? static_cast<uint8_t *>(block->mappedData) + offset
+                                            : nullptr,
+            .block = block
+    };
+
+    return VK_SUCCESS;
+}
+
+void VkMemoryAllocator::free(VkAllocation *allocation) {
+    assert(allocation);
+
+    if (!allocation->block) {
+        return;
+    }
+
+    lock_guard<mutex> lock(mMutex);
+
+    auto block = allocation->block;
+    block->subAllocator->free(allocation->offset);
+    *allocation = {};
+
+    if (!block->subAllocator->empty()) {
+        return;
+    }
+
+    // 블록이 비면 전용 메모리는 바로 해제하고, 일반 블록은 다른 블록이 남아있는 경우에만 해제한다.
+    // 마지막 블록은 다음 할당을 위해 남겨서 할당과 해제가 반복될 때 vkAllocateMemory가 호출되지 않게 한다.
+    auto &blocks = mPools[block->poolKey];
+    auto sharedBlockCount = count_if(blocks.begin(), blocks.end(), [](const auto &candidate) {
+        return !candidate->dedicated;
+    });
+
+    if (block->dedicated || sharedBlockCount > 1) {
+        destroyBlock(block);
+        blocks.erase(find_if(blocks.begin(), blocks.end(), [block](const auto &candidate) {
+            return candidate.get() == block;
+        }));
+    }
+}
+
+VkResult VkMemoryAllocator::createBuffer(const VkBufferCreateInfo &bufferCreateInfo,
+                                         const VkAllocationCreateInfo &allocationCreateInfo,
+                                         VkBuffer *buffer,
+                                         VkAllocation *allocation) {
+    if (auto result = vkCreateBuffer(mDevice, &bufferCreateInfo, nullptr, buffer); result != VK_SUCCESS) {
+        return result;
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(mDevice, *buffer, &memoryRequirements);
+
+    auto bufferAllocationCreateInfo = allocationCreateInfo;
+    bufferAllocationCreateInfo.optimalTiling = false;
+
+    if (auto result = allocate(memoryRequirements, bufferAllocationCreateInfo, allocation); result != VK_SUCCESS) {
+        vkDestroyBuffer(mDevice, *buffer, nullptr);
+        *buffer = VK_NULL_HANDLE;
+        return result;
+    }
+
+    return vkBindBufferMemory(mDevice, *buffer, allocation->memory, allocation->offset);
+}
+
+void VkMemoryAllocator::destroyBuffer(VkBuffer buffer, VkAllocation *allocation) {
+    vkDestroyBuffer(mDevice, buffer, nullptr);
+    free(allocation);
+}
+
+VkResult VkMemoryAllocator::createImage(const VkImageCreateInfo &imageCreateInfo,
+                                        const VkAllocationCreateInfo &allocationCreateInfo,
+                                        VkImage *image,
+                                        VkAllocation *allocation) {
+    if (auto result = vkCreateImage(mDevice, &imageCreateInfo, nullptr, image); result != VK_SUCCESS) {
+        return result;
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(mDevice, *image, &memoryRequirements);
+
+    auto imageAllocationCreateInfo = allocationCreateInfo;
+    imageAllocationCreateInfo.optimalTiling = imageCreateInfo.tiling == VK_IMAGE_TILING_OPTIMAL;
+
+    if (auto result = allocate(memoryRequirements, imageAllocationCreateInfo, allocation); result != VK_SUCCESS) {
+        vkDestroyImage(mDevice, *image, nullptr);
+        *image = VK_NULL_HANDLE;
+        return result;
+    }
+
+    return vkBindImageMemory(mDevice, *image, allocation->memory, allocation->offset);
+}
+
+void VkMemoryAllocator::destroyImage(VkImage image, VkAllocation *allocation) {
+    vkDestroyImage(mDevice, image, nullptr);
+    free(allocation);
+}
+
+VkMemoryAllocatorStats VkMemoryAllocator::stats() const {
+    lock_guard<mutex> lock(mMutex);
+
+    VkMemoryAllocatorStats stats{};
+    VkDeviceSize largestFreeRange = 0;
+
+    for (const auto &[key, blocks]: mPools) {
+        for (const auto &block: blocks) {
+            stats.blockCount++;
+            stats.allocationCount += block->subAllocator->allocationCount();
+            stats.allocatedSize += block->subAllocator->size();
+            stats.usedSize += block->subAllocator->usedSize();
+            largestFreeRange = max(largestFreeRange, block->subAllocator->largestFreeRange());
+        }
+    }
+
+    auto freeSize = stats.allocatedSize - stats.usedSize;
+    stats.utilization = stats.allocatedSize ? static_cast<float>(stats.usedSize) / stats.allocatedSize : 0.0f;
+    stats.fragmentation = freeSize ? 1.0f - static_cast<float>(largestFreeRange) / freeSize : 0.0f;
+
+    return stats;
+}
+
+uint32_t VkMemoryAllocator::poolKey(uint32_t memoryTypeIndex,
+                                    const VkAllocationCreateInfo &allocationCreateInfo) const {
+    // bufferImageGranularity가 1보다 크면 같은 메모리 안에서 버퍼(LINEAR)와 OPTIMAL 이미지가 이웃할 때
+    // 그 크기만큼 떨어져 있어야 한다. 경계를 검사하는 대신 두 종류를 서로 다른 블록에서 할당한다.
+    auto optimalTiling = mBufferImageGranularity > 1 && allocationCreateInfo.optimalTiling;
+
+    return (memoryTypeIndex << 8) |
+           (static_cast<uint32_t>(allocationCreateInfo.subAllocatorType) << 1) |
+           (optimalTiling ? 1 : 0);
+}
+
+VkResult VkMemoryAllocator::createBlock(uint32_t memoryTypeIndex,
+                                        VkDeviceSize size,
+                                        VkSubAllocatorType subAllocatorType,
+                                        bool dedicated,
+                                        unique_ptr<VkMemoryBlock> *block) {
+    if (mMemoryAllocationCount >= mMaxMemoryAllocationCount) {
+        return VK_ERROR_TOO_MANY_OBJECTS;
+    }
+
+    VkMemoryAllocateInfo memoryAllocateInfo{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .allocationSize = size,
+            .memoryTypeIndex = memoryTypeIndex
+    };
+
+    VkDeviceMemory memory;
+    if (auto result = vkAllocateMemory(mDevice, &memoryAllocateInfo, nullptr, &memory); result != VK_SUCCESS) {
+        return result;
+    }
+
+    void *mappedData = nullptr;
+    auto propertyFlags = mPhysicalDeviceMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+    if (propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        if (auto result = vkMapMemory(mDevice, memory, 0, VK_WHOLE_SIZE, 0, &mappedData); result != VK_SUCCESS) {
+            vkFreeMemory(mDevice, memory, nullptr);
+            return result;
+        }
+    }
+
+    mMemoryAllocationCount++;
+
+    *block = make_unique<VkMemoryBlock>(VkMemoryBlock{
+            .memory = memory,
+            .memoryTypeIndex = memoryTypeIndex,
+            .poolKey = 0,
+            .mappedData = mappedData,
+            .dedicated = dedicated,
+            .subAllocator = VkSubAllocator::create(subAllocatorType, size)
+    });
+
+    return VK_SUCCESS;
+}
+
+void VkMemoryAllocator::destroyBlock(VkMemoryBlock *block) {
+    if (block->mappedData) {
+        vkUnmapMemory(mDevice, block->memory);
+    }
+    vkFreeMemory(mDevice, block->memory, nullptr);
+    mMemoryAllocationCount--;
+}
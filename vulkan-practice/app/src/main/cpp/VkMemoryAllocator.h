@@ -0,0 +1,127 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKMEMORYALLOCATOR_H
+#define PRACTICE_VULKAN_VKMEMORYALLOCATOR_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "VkSubAllocator.h"
+
+// vkAllocateMemory로 할당한 하나의 큰 메모리. 여러 리소스가 나눠서 사용한다.
+struct VkMemoryBlock {
+    VkDeviceMemory memory;
+    uint32_t memoryTypeIndex;
+    uint32_t poolKey;
+    void *mappedData;  // HOST_VISIBLE 메모리는 생성할 때 한 번만 매핑해둔다.
+    bool dedicated;    // 블록보다 큰 리소스를 위해 따로 할당된 메모리
+    std::unique_ptr<VkSubAllocator> subAllocator;
+};
+
+struct VkAllocation {
+    VkDeviceMemory memory{VK_NULL_HANDLE};
+    VkDeviceSize offset{0};
+    VkDeviceSize size{0};
+    void *mappedData{nullptr}; // HOST_VISIBLE 메모리인 경우 offset이 이미 더해진 포인터
+    VkMemoryBlock *block{nullptr};
+};
+
+struct VkAllocationCreateInfo {
+    VkMemoryPropertyFlags memoryPropertyFlags{0};
+    VkSubAllocatorType subAllocatorType{VK_SUB_ALLOCATOR_TYPE_FREE_LIST};
+    bool optimalTiling{false}; // VK_IMAGE_TILING_OPTIMAL 이미지이면 true, 버퍼나 LINEAR 이미지이면 false
+};
+
+struct VkMemoryAllocatorStats {
+    uint32_t blockCount;
+    uint32_t allocationCount;
+    VkDeviceSize allocatedSize; // vkAllocateMemory로 할당한 크기의 합
+    VkDeviceSize usedSize;      // 리소스에 나눠준 크기의 합
+    float utilization;          // usedSize / allocatedSize
+    float fragmentation;        // 1 - (가장 큰 빈 공간 / 전체 빈 공간). 0이면 빈 공간이 한 덩어리다.
+};
+
+// 메모리 타입마다 큰 블록을 할당해두고 리소스에는 블록의 일부분을 나눠준다.
+// vkAllocateMemory 호출 횟수가 maxMemoryAllocationCount를 넘지 않게 하고 디바이스 메모리의 단편화를 줄인다.
+class VkMemoryAllocator {
+public:
+    static constexpr VkDeviceSize kDefaultBlockSize = 64 * 1024 * 1024;
+
+    VkMemoryAllocator(VkDevice device,
+                      const VkPhysicalDeviceProperties &physicalDeviceProperties,
+                      const VkPhysicalDeviceMemoryProperties &physicalDeviceMemoryProperties,
+                      VkDeviceSize blockSize = kDefaultBlockSize);
+    ~VkMemoryAllocator();
+
+    VkMemoryAllocator(const VkMemoryAllocator &) = delete;
+    VkMemoryAllocator &operator=(const VkMemoryAllocator &) = delete;
+
+    VkResult allocate(const VkMemoryRequirements &memoryRequirements,
+                      const VkAllocationCreateInfo &allocationCreateInfo,
+                      VkAllocation *allocation);
+
+    void free(VkAllocation *allocation);
+
+    // VkBuffer를 생성하고 메모리를 할당해서 바인드한다.
+    VkResult createBuffer(const VkBufferCreateInfo &bufferCreateInfo,
+                          const VkAllocationCreateInfo &allocationCreateInfo,
+                          VkBuffer *buffer,
+                          VkAllocation *allocation);
+
+    void destroyBuffer(VkBuffer buffer, VkAllocation *allocation);
+
+    // VkImage를 생성하고 메모리를 할당해서 바인드한다. optimalTiling은 imageCreateInfo.tiling에서 결정된다.
+    VkResult createImage(const VkImageCreateInfo &imageCreateInfo,
+                         const VkAllocationCreateInfo &allocationCreateInfo,
+                         VkImage *image,
+                         VkAllocation *allocation);
+
+    void destroyImage(VkImage image, VkAllocation *allocation);
+
+    VkMemoryAllocatorStats stats() const;
+
+private:
+    uint32_t poolKey(uint32_t memoryTypeIndex,
+                     const VkAllocationCreateInfo &allocationCreateInfo) const;
+    VkResult createBlock(uint32_t memoryTypeIndex,
+                         VkDeviceSize size,
+                         VkSubAllocatorType subAllocatorType,
+                         bool dedicated,
+                         std::unique_ptr<VkMemoryBlock> *block);
+    void destroyBlock(VkMemoryBlock *block);
+
+    VkDevice mDevice;
+    VkPhysicalDeviceMemoryProperties mPhysicalDeviceMemoryProperties;
+    VkDeviceSize mBufferImageGranularity;
+    uint32_t mMaxMemoryAllocationCount;
+    VkDeviceSize mBlockSize;
+    mutable std::mutex mMutex;
+    std::map<uint32_t, std::vector<std::unique_ptr<VkMemoryBlock>>> mPools; // poolKey -> 블록들
+    uint32_t mMemoryAllocationCount{0};
+};
+
+#endif //PRACTICE_VULKAN_VKMEMORYALLOCATOR_H
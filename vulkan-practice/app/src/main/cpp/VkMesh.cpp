@@ -0,0 +1,378 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+
+#include "VkMesh.h"
+#include "VkUtil.h"
+
+using namespace std;
+
+namespace {
+
+// Forsyth 알고리즘에서 점수를 계산할 때 가정하는 LRU 캐시의 크기와 가중치
+constexpr int32_t kCacheSize = 32;
+constexpr float kCacheDecayPower = 1.5f;
+constexpr float kLastTriangleScore = 0.75f;
+constexpr float kValenceBoostScale = 2.0f;
+constexpr float kValenceBoostPower = 0.5f;
+
+float vertexScore(int32_t cachePosition, uint32_t remainingTriangleCount) {
+    // 더 이상 사용하는 삼각형이 없는 정점은 선택될 필요가 없다.
+    if (remainingTriangleCount == 0) {
+        return -1.0f;
+    }
+
+    auto score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            // 마지막 삼각형에 사용된 정점은 일부러 점수를 낮춰서 바로 옆 삼각형만 따라가지 않게 한다.
+            score = kLastTriangleScore;
+        } else {
+            auto scale = 1.0f / (kCacheSize - 3);
+            score = powf(1.0f - (cachePosition - 3) * scale, kCacheDecayPower);
+        }
+    }
+
+    // 남은 삼각형이 적은 정점을 먼저 처리해서 나중에 혼자 남는 정점을 줄인다.
+    score += kValenceBoostScale * powf(static_cast<float>(remainingTriangleCount), -kValenceBoostPower);
+
+    return score;
+}
+
+struct VertexHash {
+    size_t operator()(const Vertex &vertex) const {
+        return hash<string_view>()({reinterpret_cast<const char *>(&vertex), sizeof(Vertex)});
+    }
+};
+
+struct VertexEqual {
+    bool operator()(const Vertex &lhs, const Vertex &rhs) const {
+        return memcmp(&lhs, &rhs, sizeof(Vertex)) == 0;
+    }
+};
+
+} // namespace
+
+void vkDeduplicateVertices(const vector<Vertex> &vertices, MeshData *meshData) {
+    assert(meshData);
+
+    unordered_map<Vertex, uint32_t, VertexHash, VertexEqual> indexMap;
+    indexMap.reserve(vertices.size());
+
+    meshData->vertices.clear();
+    meshData->indices.clear();
+    meshData->indices.reserve(vertices.size());
+
+    for (const auto &vertex: vertices) {
+        auto [iter, inserted] = indexMap.try_emplace(vertex, static_cast<uint32_t>(meshData->vertices.size()));
+        if (inserted) {
+            meshData->vertices.push_back(vertex);
+        }
+        meshData->indices.push_back(iter->second);
+    }
+}
+
+void vkOptimizeVertexCache(uint32_t vertexCount, vector<uint32_t> *indices) {
+    assert(indices && indices->size() % 3 == 0);
+
+    auto triangleCount = static_cast<uint32_t>(indices->size() / 3);
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // ================================================================================
+    // 1. 정점마다 사용하는 삼각형 목록 만들기
+    // ================================================================================
+    // vertexTriangles[triangleOffsets[v], triangleOffsets[v] + remainingCounts[v])가 아직 출력되지 않은 삼각형이다.
+    vector<uint32_t> remainingCounts(vertexCount, 0);
+    for (auto index: *indices) {
+        assert(index < vertexCount);
+        remainingCounts[index]++;
+    }
+
+    vector<uint32_t> triangleOffsets(vertexCount + 1, 0);
+    for (uint32_t v = 0; v != vertexCount; ++v) {
+        triangleOffsets[v + 1] = triangleOffsets[v] + remainingCounts[v];
+    }
+
+    vector<uint32_t> vertexTriangles(indices->size());
+    vector<uint32_t> fillCounts(vertexCount, 0);
+    for (uint32_t t = 0; t != triangleCount; ++t) {
+        for (uint32_t k = 0; k != 3; ++k) {
+            auto v = (*indices)[t * 3 + k];
+            vertexTriangles[triangleOffsets[v] + fillCounts[v]++] = t;
+        }
+    }
+
+    // ================================================================================
+    // 2. 초기 점수 계산
+    // ================================================================================
+    vector<int32_t> cachePositions(vertexCount, -1);
+    vector<float> vertexScores(vertexCount);
+    for (uint32_t v = 0; v != vertexCount; ++v) {
+        vertexScores[v] = vertexScore(-1, remainingCounts[v]);
+    }
+
+    vector<float> triangleScores(triangleCount);
+    vector<bool> emitted(triangleCount, false);
+    for (uint32_t t = 0; t != triangleCount; ++t) {
+        triangleScores[t] = vertexScores[(*indices)[t * 3]] +
+                            vertexScores[(*indices)[t * 3 + 1]] +
+                            vertexScores[(*indices)[t * 3 + 2]];
+    }
+
+    // ================================================================================
+    // 3. 점수가 가장 높은 삼각형을 하나씩 출력
+    // ================================================================================
+    vector<uint32_t> optimizedIndices;
+    optimizedIndices.reserve(indices->size());
+
+    vector<uint32_t> cache;
+    vector<uint32_t> nextCache;
+    cache.reserve(kCacheSize + 3);
+    nextCache.reserve(kCacheSize + 3);
+
+    int64_t bestTriangle = -1;
+    uint32_t scanCursor = 0;
+
+    for (uint32_t n = 0; n != triangleCount; ++n) {
+        // 캐시에 있는 정점으로 만든 삼각형이 없으면 아직 출력되지 않은 첫 번째 삼각형부터 다시 시작한다.
+        if (bestTriangle < 0) {
+            while (emitted[scanCursor]) {
+                ++scanCursor;
+            }
+            bestTriangle = scanCursor;
+        }
+
+        auto triangle = static_cast<uint32_t>(bestTriangle);
+        emitted[triangle] = true;
+
+        // 출력한 삼각형을 정점의 남은 삼각형 목록에서 제거한다.
+        for (uint32_t k = 0; k != 3; ++k) {
+            auto v = (*indices)[triangle * 3 + k];
+            optimizedIndices.push_back(v);
+
+            auto begin = vertexTriangles.begin() + triangleOffsets[v];
+            auto end = begin + remainingCounts[v];
+            auto iter = find(begin, end, triangle);
+            assert(iter != end);
+            iter_swap(iter, end - 1);
+            remainingCounts[v]--;
+        }
+
+        // 출력한 삼각형의 정점을 캐시의 앞으로 옮긴다.
+        nextCache.clear();
+        for (uint32_t k = 0; k != 3; ++k) {
+            nextCache.push_back((*indices)[triangle * 3 + k]);
+        }
+        for (auto v: cache) {
+            if (find(nextCache.begin(), nextCache.begin() + 3, v) == nextCache.begin() + 3) {
+                nextCache.push_back(v);
+            }
+        }
+
+        // 캐시에 남은 정점과 밀려난 정점의 점수를 다시 계산한다.
+        for (int32_t i = 0; i != static_cast<int32_t>(nextCache.size()); ++i) {
+            auto v = nextCache[i];
+            cachePositions[v] = i < kCacheSize ? i : -1;
+            vertexScores[v] = vertexScore(cachePositions[v], remainingCounts[v]);
+        }
+
+        // 점수가 바뀐 정점을 사용하는 삼각형 중에서 다음 삼각형을 고른다.
+        bestTriangle = -1;
+        auto bestScore = -1.0f;
+        for (auto v: nextCache) {
+            auto begin = vertexTriangles.begin() + triangleOffsets[v];
+            auto end = begin + remainingCounts[v];
+            for (auto iter = begin; iter != end; ++iter) {
+                auto t = *iter;
+                triangleScores[t] = vertexScores[(*indices)[t * 3]] +
+                                    vertexScores[(*indices)[t * 3 + 1]] +
+                                    vertexScores[(*indices)[t * 3 + 2]];
+                if (triangleScores[t] > bestScore) {
+                    bestScore = triangleScores[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        if (nextCache.size() > kCacheSize) {
+            nextCache.resize(kCacheSize);
+        }
+        swap(cache, nextCache);
+    }
+
+    *indices = std::move(optimizedIndices);
+}
+
+void vkOptimizeVertexFetch(MeshData *meshData) {
+    assert(meshData);
+
+    // ================================================================================
+    // 1. 처음 사용되는 순서대로 새로운 인덱스 부여
+    // ================================================================================
+    vector<uint32_t> remap(meshData->vertices.size(), UINT32_MAX);
+    vector<Vertex> vertices;
+    vertices.reserve(meshData->vertices.size());
+
+    for (auto &index: meshData->indices) {
+        if (remap[index] == UINT32_MAX) {
+            remap[index] = static_cast<uint32_t>(vertices.size());
+            vertices.push_back(meshData->vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    // ================================================================================
+    // 2. 사용되지 않는 정점은 버린다.
+    // ================================================================================
+    meshData->vertices = std::move(vertices);
+}
+
+float vkCalculateAcmr(const vector<uint32_t> &indices, uint32_t cacheSize) {
+    // 삼각형이 하나도 없으면 삼각형 수로 나눌 수 없다.
+    if (indices.size() < 3) {
+        return 0.0f;
+    }
+
+    deque<uint32_t> cache;
+    uint32_t missCount = 0;
+
+    for (auto index: indices) {
+        if (find(cache.begin(), cache.end(), index) == cache.end()) {
+            missCount++;
+            cache.push_back(index);
+            if (cache.size() > cacheSize) {
+                cache.pop_front();
+            }
+        }
+    }
+
+    return static_cast<float>(missCount) / static_cast<float>(indices.size() / 3);
+}
+
+VkMesh::VkMesh(VkMemoryAllocator *memoryAllocator, VkUploadQueue *uploadQueue, const MeshData &meshData)
+        : mMemoryAllocator(memoryAllocator),
+          mVertexCount(static_cast<uint32_t>(meshData.vertices.size())),
+          mIndexCount(static_cast<uint32_t>(meshData.indices.size())) {
+    assert(mVertexCount > 0);
+
+    VkAllocationCreateInfo allocationCreateInfo{
+            .memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    };
+
+    // ================================================================================
+    // 1. Vertex VkBuffer 생성 및 업로드
+    // ================================================================================
+    VkDeviceSize vertexDataSize{mVertexCount * sizeof(Vertex)};
+
+    VkBufferCreateInfo vertexBufferCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size = vertexDataSize,
+            .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+    };
+
+    VK_CHECK_ERROR(mMemoryAllocator->createBuffer(vertexBufferCreateInfo,
+                                                  allocationCreateInfo,
+                                                  &mVertexBuffer,
+                                                  &mVertexAllocation));
+
+    mUploadTicket = uploadQueue->upload(mVertexBuffer,
+                                        0,
+                                        meshData.vertices.data(),
+                                        vertexDataSize,
+                                        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+
+    if (!indexed()) {
+        return;
+    }
+
+    // ================================================================================
+    // 2. Index VkBuffer 생성 및 업로드
+    // ================================================================================
+    // 16비트 인덱스는 메모리와 대역폭을 절반만 사용한다. 0xFFFF는 primitive restart 값이므로 사용하지 않는다.
+    vector<uint16_t> shortIndices;
+    const void *indexData = meshData.indices.data();
+    VkDeviceSize indexDataSize{mIndexCount * sizeof(uint32_t)};
+
+    if (mVertexCount < UINT16_MAX) {
+        mIndexType = VK_INDEX_TYPE_UINT16;
+        shortIndices.assign(meshData.indices.begin(), meshData.indices.end());
+        indexData = shortIndices.data();
+        indexDataSize = mIndexCount * sizeof(uint16_t);
+    }
+
+    VkBufferCreateInfo indexBufferCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size = indexDataSize,
+            .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+    };
+
+    VK_CHECK_ERROR(mMemoryAllocator->createBuffer(indexBufferCreateInfo,
+                                                  allocationCreateInfo,
+                                                  &mIndexBuffer,
+                                                  &mIndexAllocation));
+
+    mUploadTicket = uploadQueue->upload(mIndexBuffer,
+                                        0,
+                                        indexData,
+                                        indexDataSize,
+                                        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                        VK_ACCESS_INDEX_READ_BIT);
+}
+
+VkMesh::~VkMesh() {
+    if (mIndexBuffer != VK_NULL_HANDLE) {
+        mMemoryAllocator->destroyBuffer(mIndexBuffer, &mIndexAllocation);
+    }
+    mMemoryAllocator->destroyBuffer(mVertexBuffer, &mVertexAllocation);
+}
+
+void VkMesh::draw(VkCommandBuffer commandBuffer, uint32_t instanceCount) const {
+    bind(commandBuffer);
+    drawInstances(commandBuffer, instanceCount);
+}
+
+void VkMesh::bind(VkCommandBuffer commandBuffer) const {
+    VkDeviceSize vertexBufferOffset{0};
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mVertexBuffer, &vertexBufferOffset);
+
+    if (indexed()) {
+        vkCmdBindIndexBuffer(commandBuffer, mIndexBuffer, 0, mIndexType);
+    }
+}
+
+void VkMesh::drawInstances(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance) const {
+    if (indexed()) {
+        vkCmdDrawIndexed(commandBuffer, mIndexCount, instanceCount, 0, 0, firstInstance);
+    } else {
+        vkCmdDraw(commandBuffer, mVertexCount, instanceCount, 0, firstInstance);
+    }
+}
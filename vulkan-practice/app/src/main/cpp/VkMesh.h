@@ -0,0 +1,127 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKMESH_H
+#define PRACTICE_VULKAN_VKMESH_H
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "VkMemoryAllocator.h"
+#include "VkUploadQueue.h"
+
+struct Vector3 {
+    union {
+        float x;
+        float r;
+    };
+
+    union {
+        float y;
+        float g;
+    };
+
+    union {
+        float z;
+        float b;
+    };
+};
+
+// binding 0, 정점마다 읽는 데이터
+struct Vertex {
+    Vector3 position;
+    Vector3 color;
+};
+
+// binding 1, 인스턴스마다 읽는 데이터
+struct MeshInstance {
+    Vector3 offset;
+    float scale;
+};
+
+// indices가 비어있으면 인덱스 없이 vertices를 순서대로 그린다.
+struct MeshData {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+// ================================================================================
+// 메시 최적화
+// ================================================================================
+// 인덱스 없는 정점 배열에서 중복된 정점을 합쳐 인덱스가 있는 메시를 만든다.
+void vkDeduplicateVertices(const std::vector<Vertex> &vertices, MeshData *meshData);
+
+// 정점 셰이더 결과를 재사용할 수 있도록 삼각형의 순서를 바꾼다. (Tom Forsyth, Linear-Speed Vertex Cache Optimisation)
+void vkOptimizeVertexCache(uint32_t vertexCount, std::vector<uint32_t> *indices);
+
+// 인덱스에서 처음 사용되는 순서대로 정점을 재배치해서 정점을 읽을 때의 메모리 접근을 순차적으로 만든다.
+void vkOptimizeVertexFetch(MeshData *meshData);
+
+// 크기가 cacheSize인 FIFO 캐시를 가정했을 때 삼각형 하나당 정점 셰이더가 실행되는 평균 횟수.
+// 0.5에 가까울수록 좋고 인덱스가 없으면 3이다. 삼각형이 하나도 없으면 0을 반환한다.
+float vkCalculateAcmr(const std::vector<uint32_t> &indices, uint32_t cacheSize = 16);
+
+// ================================================================================
+// 메시
+// ================================================================================
+// DEVICE_LOCAL 메모리에 있는 정점, 인덱스 버퍼. 모든 정점을 16비트로 가리킬 수 있으면 16비트 인덱스를 사용한다.
+class VkMesh {
+public:
+    VkMesh(VkMemoryAllocator *memoryAllocator, VkUploadQueue *uploadQueue, const MeshData &meshData);
+    ~VkMesh();
+
+    VkMesh(const VkMesh &) = delete;
+    VkMesh &operator=(const VkMesh &) = delete;
+
+    // 정점 버퍼를 binding 0에 바인드하고 그린다. 인스턴스 버퍼는 호출하는 쪽에서 바인드한다.
+    void draw(VkCommandBuffer commandBuffer, uint32_t instanceCount = 1) const;
+
+    // 정점 버퍼를 binding 0에, 인덱스 버퍼가 있으면 함께 바인드한다.
+    void bind(VkCommandBuffer commandBuffer) const;
+
+    // bind()한 후에 firstInstance부터 instanceCount개의 인스턴스를 그린다. 그리기를 여러 번 나눌 때 사용한다.
+    void drawInstances(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance = 0) const;
+
+    VkUploadTicket uploadTicket() const { return mUploadTicket; }
+
+    bool indexed() const { return mIndexCount != 0; }
+
+    VkIndexType indexType() const { return mIndexType; }
+
+    uint32_t vertexCount() const { return mVertexCount; }
+
+    uint32_t indexCount() const { return mIndexCount; }
+
+private:
+    VkMemoryAllocator *mMemoryAllocator;
+    VkBuffer mVertexBuffer;
+    VkAllocation mVertexAllocation;
+    VkBuffer mIndexBuffer{VK_NULL_HANDLE};
+    VkAllocation mIndexAllocation;
+    VkIndexType mIndexType{VK_INDEX_TYPE_UINT32};
+    uint32_t mVertexCount;
+    uint32_t mIndexCount;
+    VkUploadTicket mUploadTicket;
+};
+
+#endif //PRACTICE_VULKAN_VKMESH_H
@@ -0,0 +1,177 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+
+#include "VkPipelineBuilder.h"
+#include "VkTrace.h"
+#include "VkUtil.h"
+#include "AndroidOut.h"
+
+using namespace std;
+
+VkPipelineBuilder::VkPipelineBuilder(VkDevice device, VkJobSystem *jobSystem, VkPipelineCacheStore *pipelineCacheStore)
+        : mDevice(device),
+          mJobSystem(jobSystem) {
+    for (uint32_t i = 0; i != mJobSystem->threadCount(); ++i) {
+        mWorkerCaches.push_back(pipelineCacheStore->createWorkerCache());
+    }
+}
+
+uint32_t VkPipelineBuilder::addShader(string name, VkShaderCompileFunction compileFunction) {
+    mShaders.push_back({
+            .name = std::move(name),
+            .compileFunction = std::move(compileFunction)
+    });
+    return static_cast<uint32_t>(mShaders.size() - 1);
+}
+
+uint32_t VkPipelineBuilder::addPipeline(string name, vector<uint32_t> shaders, VkPipelineCreateFunction createFunction) {
+    for (auto shader : shaders) {
+        assert(shader < mShaders.size());
+    }
+
+    mPipelines.push_back({
+            .name = std::move(name),
+            .shaders = std::move(shaders),
+            .createFunction = std::move(createFunction)
+    });
+    return static_cast<uint32_t>(mPipelines.size() - 1);
+}
+
+void VkPipelineBuilder::build() {
+    VK_TRACE_SCOPE("BuildPipelines");
+
+    mTimeline.clear();
+    mBuildBeginTime = vkTraceNow();
+
+    // ================================================================================
+    // 1. 셰이더 작업 실행
+    // ================================================================================
+    // 모든 작업이 root의 자식이므로 root가 끝나면 모든 셰이더와 파이프라인이 만들어진 것이다.
+    auto root = mJobSystem->create({});
+    for (auto &shader : mShaders) {
+        shader.job = mJobSystem->create([this, &shader] { buildShader(&shader); }, root);
+    }
+
+    // ================================================================================
+    // 2. 파이프라인 작업 실행
+    // ================================================================================
+    // 파이프라인 작업은 자신의 셰이더 작업만 기다린다. 기다리는 동안 다른 작업을 실행하므로 스레드가 놀지 않는다.
+    // 파이프라인 작업을 먼저 넣어서 LIFO로 꺼낼 때 셰이더 작업이 먼저 실행되게 한다.
+    for (auto &pipeline : mPipelines) {
+        mJobSystem->run(mJobSystem->create([this, &pipeline] {
+            for (auto shader : pipeline.shaders) {
+                mJobSystem->wait(mShaders[shader].job);
+            }
+            buildPipeline(&pipeline);
+        }, root));
+    }
+    for (auto &shader : mShaders) {
+        mJobSystem->run(shader.job);
+    }
+
+    mJobSystem->run(root);
+    mJobSystem->wait(root);
+
+    mBuildTime = chrono::nanoseconds(vkTraceNow() - mBuildBeginTime);
+}
+
+chrono::nanoseconds VkPipelineBuilder::serialTime(bool pipeline) const {
+    chrono::nanoseconds time{0};
+    for (const auto &step : mTimeline) {
+        if (step.pipeline == pipeline) {
+            time += chrono::nanoseconds(step.endTime - step.beginTime);
+        }
+    }
+    return time;
+}
+
+void VkPipelineBuilder::logTimeline() const {
+    auto toMilliseconds = [this](uint64_t time) {
+        return static_cast<double>(time - mBuildBeginTime) / 1e6;
+    };
+
+    auto steps = mTimeline;
+    sort(steps.begin(), steps.end(), [](const VkBuildStep &lhs, const VkBuildStep &rhs) {
+        return lhs.threadIndex != rhs.threadIndex ? lhs.threadIndex < rhs.threadIndex : lhs.beginTime < rhs.beginTime;
+    });
+
+    aout << "Pipeline Build Timeline ↓" << endl;
+    aout << fixed << setprecision(3);
+    for (const auto &step : steps) {
+        aout << " - Thread " << step.threadIndex << ": "
+             << toMilliseconds(step.beginTime) << " ~ " << toMilliseconds(step.endTime) << " ms "
+             << (step.pipeline ? "Pipeline " : "Shader ") << step.name << endl;
+    }
+}
+
+void VkPipelineBuilder::buildShader(Shader *shader) {
+    VK_TRACE_SCOPE("BuildShader");
+
+    auto beginTime = vkTraceNow();
+
+    auto binary = shader->compileFunction();
+    assert(!binary.empty());
+
+    VkShaderModuleCreateInfo shaderModuleCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+            .codeSize = binary.size() * sizeof(uint32_t), // 바이트 단위.
+            .pCode = binary.data()
+    };
+
+    VK_CHECK_ERROR(vkCreateShaderModule(mDevice, &shaderModuleCreateInfo, nullptr, &shader->shaderModule));
+
+    addStep(shader->name, false, beginTime);
+}
+
+void VkPipelineBuilder::buildPipeline(Pipeline *pipeline) {
+    VK_TRACE_SCOPE("BuildPipeline");
+
+    auto beginTime = vkTraceNow();
+
+    vector<VkShaderModule> shaderModules;
+    for (auto shader : pipeline->shaders) {
+        shaderModules.push_back(mShaders[shader].shaderModule);
+    }
+
+    VK_CHECK_ERROR(pipeline->createFunction(shaderModules,
+                                            mWorkerCaches[mJobSystem->threadIndex()],
+                                            &pipeline->pipeline));
+
+    addStep(pipeline->name, true, beginTime);
+}
+
+void VkPipelineBuilder::addStep(const string &name, bool pipeline, uint64_t beginTime) {
+    auto endTime = vkTraceNow();
+
+    lock_guard<mutex> lock(mTimelineMutex);
+    mTimeline.push_back({
+            .name = name,
+            .pipeline = pipeline,
+            .threadIndex = mJobSystem->threadIndex(),
+            .beginTime = beginTime,
+            .endTime = endTime
+    });
+}
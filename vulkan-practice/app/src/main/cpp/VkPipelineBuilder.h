@@ -0,0 +1,119 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKPIPELINEBUILDER_H
+#define PRACTICE_VULKAN_VKPIPELINEBUILDER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "VkJobSystem.h"
+#include "VkPipelineCacheStore.h"
+
+// SPIR-V를 반환한다. 빌드된 배열을 복사하거나 실행 중에 컴파일한다.
+typedef std::function<std::vector<uint32_t>()> VkShaderCompileFunction;
+
+// addPipeline에 넘긴 순서대로 정렬된 VkShaderModule로 파이프라인을 만든다.
+typedef std::function<VkResult(const std::vector<VkShaderModule> &shaderModules,
+                               VkPipelineCache pipelineCache,
+                               VkPipeline *pipeline)> VkPipelineCreateFunction;
+
+// 시작 단계에서 한 일과 그 일을 실행한 스레드. 시간은 vkTraceNow()와 같은 나노초.
+struct VkBuildStep {
+    std::string name;
+    bool pipeline;        // false이면 셰이더
+    uint32_t threadIndex;
+    uint64_t beginTime;
+    uint64_t endTime;
+};
+
+// 셰이더 컴파일, VkShaderModule 생성, 파이프라인 생성을 작업 시스템에서 동시에 실행한다.
+// 파이프라인은 필요한 셰이더가 준비되는 대로 시작하므로 다른 셰이더의 컴파일을 기다리지 않는다.
+// 하나의 VkPipelineCache를 함께 사용하면 드라이버의 잠금에서 스레드가 경쟁하므로
+// 작업 시스템의 스레드마다 워커 캐시를 사용하고, 저장할 때 VkPipelineCacheStore가 합친다.
+// 만든 VkShaderModule과 VkPipeline은 호출하는 쪽이 소유하고 파괴한다.
+class VkPipelineBuilder {
+public:
+    VkPipelineBuilder(VkDevice device, VkJobSystem *jobSystem, VkPipelineCacheStore *pipelineCacheStore);
+
+    // 셰이더를 추가하고 번호를 반환한다.
+    uint32_t addShader(std::string name, VkShaderCompileFunction compileFunction);
+
+    // shaders 번호의 셰이더를 사용하는 파이프라인을 추가하고 번호를 반환한다.
+    uint32_t addPipeline(std::string name, std::vector<uint32_t> shaders, VkPipelineCreateFunction createFunction);
+
+    // 추가된 모든 셰이더와 파이프라인을 만들고 끝날 때까지 기다린다.
+    // 작업 시스템을 만든 스레드에서 호출해야 하고 기다리는 동안 이 스레드도 작업을 실행한다.
+    void build();
+
+    VkShaderModule shaderModule(uint32_t shader) const { return mShaders[shader].shaderModule; }
+
+    VkPipeline pipeline(uint32_t pipeline) const { return mPipelines[pipeline].pipeline; }
+
+    // 끝난 순서대로 정렬된 단계들.
+    const std::vector<VkBuildStep> &timeline() const { return mTimeline; }
+
+    // build()를 시작해서 끝날 때까지의 시간.
+    std::chrono::nanoseconds buildTime() const { return mBuildTime; }
+
+    // 단계의 시간을 모두 더한 것. 한 스레드에서 순서대로 만들었을 때의 시간에 가깝다.
+    std::chrono::nanoseconds serialTime(bool pipeline) const;
+
+    // 스레드마다 단계를 시간 순서대로 로그에 출력한다.
+    void logTimeline() const;
+
+private:
+    struct Shader {
+        std::string name;
+        VkShaderCompileFunction compileFunction;
+        VkShaderModule shaderModule{VK_NULL_HANDLE};
+        VkJob *job{nullptr};
+    };
+
+    struct Pipeline {
+        std::string name;
+        std::vector<uint32_t> shaders;
+        VkPipelineCreateFunction createFunction;
+        VkPipeline pipeline{VK_NULL_HANDLE};
+    };
+
+    void buildShader(Shader *shader);
+    void buildPipeline(Pipeline *pipeline);
+    void addStep(const std::string &name, bool pipeline, uint64_t beginTime);
+
+    VkDevice mDevice;
+    VkJobSystem *mJobSystem;
+    std::vector<VkPipelineCache> mWorkerCaches; // 스레드 번호로 찾는다. VkPipelineCacheStore가 소유한다.
+    std::vector<Shader> mShaders;
+    std::vector<Pipeline> mPipelines;
+    std::mutex mTimelineMutex;
+    std::vector<VkBuildStep> mTimeline;
+    uint64_t mBuildBeginTime{0};
+    std::chrono::nanoseconds mBuildTime{0};
+};
+
+#endif //PRACTICE_VULKAN_VKPIPELINEBUILDER_H
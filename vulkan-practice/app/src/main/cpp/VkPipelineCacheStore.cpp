@@ -0,0 +1,177 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "VkPipelineCacheStore.h"
+#include "VkUtil.h"
+#include "AndroidOut.h"
+
+using namespace std;
+
+VkPipelineCacheStore::VkPipelineCacheStore(VkDevice device,
+                                           const VkPhysicalDeviceProperties &physicalDeviceProperties,
+                                           string path)
+        : mDevice(device),
+          mPhysicalDeviceProperties(physicalDeviceProperties),
+          mPath(std::move(path)) {
+    // ================================================================================
+    // 1. 파일에서 캐시 데이터 읽기
+    // ================================================================================
+    vector<uint8_t> data;
+    if (!mPath.empty()) {
+        ifstream file(mPath, ios::binary);
+        if (file) {
+            data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+        }
+    }
+
+    // ================================================================================
+    // 2. 캐시 헤더 검증
+    // ================================================================================
+    mWarm = validate(data, mPhysicalDeviceProperties);
+    if (!mWarm && !data.empty()) {
+        aout << "Pipeline cache at " << mPath << " is stale, starting with an empty cache." << endl;
+        data.clear();
+    }
+
+    // ================================================================================
+    // 3. VkPipelineCache 생성
+    // ================================================================================
+    VkPipelineCacheCreateInfo pipelineCacheCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .initialDataSize = data.size(),
+            .pInitialData = data.empty() ? nullptr : data.data()
+    };
+
+    VK_CHECK_ERROR(vkCreatePipelineCache(mDevice, &pipelineCacheCreateInfo, nullptr, &mPipelineCache));
+}
+
+VkPipelineCacheStore::~VkPipelineCacheStore() {
+    save();
+
+    for (auto workerCache : mWorkerCaches) {
+        vkDestroyPipelineCache(mDevice, workerCache, nullptr);
+    }
+    vkDestroyPipelineCache(mDevice, mPipelineCache, nullptr);
+}
+
+VkPipelineCache VkPipelineCacheStore::createWorkerCache() {
+    lock_guard<mutex> lock(mMutex);
+
+    // 파일에서 불러온 내용과 합쳐진 내용을 워커 캐시에서도 찾을 수 있도록 메인 캐시의 데이터로 시작한다.
+    auto data = cacheData();
+
+    VkPipelineCacheCreateInfo pipelineCacheCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .initialDataSize = data.size(),
+            .pInitialData = data.empty() ? nullptr : data.data()
+    };
+
+    VkPipelineCache workerCache;
+    VK_CHECK_ERROR(vkCreatePipelineCache(mDevice, &pipelineCacheCreateInfo, nullptr, &workerCache));
+
+    mWorkerCaches.push_back(workerCache);
+    return workerCache;
+}
+
+void VkPipelineCacheStore::save() {
+    // ================================================================================
+    // 1. 워커 캐시를 합치고 캐시 데이터 얻기
+    // ================================================================================
+    vector<uint8_t> data;
+    {
+        lock_guard<mutex> lock(mMutex);
+        mergeWorkerCaches();
+
+        if (mPath.empty()) {
+            return;
+        }
+        data = cacheData();
+    }
+
+    // ================================================================================
+    // 2. 임시 파일에 쓰고 원래 파일과 교체
+    // ================================================================================
+    auto temporaryPath = mPath + ".tmp";
+    auto fd = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        aout << "Failed to open " << temporaryPath << ": " << strerror(errno) << endl;
+        return;
+    }
+
+    auto written = write(fd, data.data(), data.size());
+    auto synced = fsync(fd) == 0; // rename 전에 데이터가 디스크에 기록되어야 한다.
+    close(fd);
+
+    if (written != static_cast<ssize_t>(data.size()) || !synced ||
+        rename(temporaryPath.c_str(), mPath.c_str()) != 0) {
+        aout << "Failed to write pipeline cache to " << mPath << "." << endl;
+        unlink(temporaryPath.c_str());
+    }
+}
+
+void VkPipelineCacheStore::mergeWorkerCaches() {
+    if (mWorkerCaches.empty()) {
+        return;
+    }
+
+    // 워커 캐시는 읽기만 하므로 다른 스레드가 그 캐시로 파이프라인을 만드는 중이어도 된다.
+    VK_CHECK_ERROR(vkMergePipelineCaches(mDevice,
+                                         mPipelineCache,
+                                         static_cast<uint32_t>(mWorkerCaches.size()),
+                                         mWorkerCaches.data()));
+}
+
+vector<uint8_t> VkPipelineCacheStore::cacheData() const {
+    size_t dataSize;
+    VK_CHECK_ERROR(vkGetPipelineCacheData(mDevice, mPipelineCache, &dataSize, nullptr));
+
+    vector<uint8_t> data(dataSize);
+    VK_CHECK_ERROR(vkGetPipelineCacheData(mDevice, mPipelineCache, &dataSize, data.data()));
+    data.resize(dataSize);
+    return data;
+}
+
+bool VkPipelineCacheStore::validate(const vector<uint8_t> &data,
+                                    const VkPhysicalDeviceProperties &physicalDeviceProperties) {
+    VkPipelineCacheHeaderVersionOne header;
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+
+    return header.headerSize >= sizeof(header) &&
+           header.headerSize <= data.size() &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == physicalDeviceProperties.vendorID &&
+           header.deviceID == physicalDeviceProperties.deviceID &&
+           memcmp(header.pipelineCacheUUID,
+                  physicalDeviceProperties.pipelineCacheUUID,
+                  VK_UUID_SIZE) == 0;
+}
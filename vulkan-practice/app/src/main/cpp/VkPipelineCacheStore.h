@@ -0,0 +1,78 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKPIPELINECACHESTORE_H
+#define PRACTICE_VULKAN_VKPIPELINECACHESTORE_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// VkPipelineCache를 파일에 저장하고 다음 실행 때 다시 불러와서 파이프라인 컴파일 비용을 줄인다.
+// 파일의 헤더가 현재 디바이스와 맞지 않으면 (드라이버 업데이트, 다른 GPU 등) 버리고 빈 캐시로 시작한다.
+// 파이프라인을 만드는 스레드마다 워커 캐시를 사용해서 드라이버의 캐시 잠금을 두고 경쟁하지 않게 한다.
+class VkPipelineCacheStore {
+public:
+    // path가 비어있으면 파일에 저장하지 않고 메모리에서만 사용한다.
+    VkPipelineCacheStore(VkDevice device,
+                         const VkPhysicalDeviceProperties &physicalDeviceProperties,
+                         std::string path);
+    ~VkPipelineCacheStore();
+
+    VkPipelineCacheStore(const VkPipelineCacheStore &) = delete;
+    VkPipelineCacheStore &operator=(const VkPipelineCacheStore &) = delete;
+
+    VkPipelineCache cache() const { return mPipelineCache; }
+
+    // 파일에서 유효한 캐시를 불러왔는지 여부.
+    bool isWarm() const { return mWarm; }
+
+    // 한 스레드가 사용할 캐시를 메인 캐시의 내용으로 생성한다. 저장할 때마다 메인 캐시에 합쳐지고
+    // 이 객체가 파괴될 때 함께 파괴되므로, 그 전에 워커 캐시를 사용하는 스레드가 끝나야 한다.
+    VkPipelineCache createWorkerCache();
+
+    // 워커 캐시를 메인 캐시에 합친 후 임시 파일에 쓰고 rename으로 교체한다.
+    // 중간에 앱이 종료되어도 이전 파일이나 새 파일 중 하나는 온전하게 남는다.
+    // 워커 캐시는 파괴하지 않으므로 다른 스레드가 파이프라인을 만드는 중에 호출해도 된다.
+    void save();
+
+    // data가 이 디바이스에서 만들어진 캐시인지 확인한다.
+    static bool validate(const std::vector<uint8_t> &data,
+                         const VkPhysicalDeviceProperties &physicalDeviceProperties);
+
+private:
+    // mMutex를 잡은 상태에서 호출한다.
+    void mergeWorkerCaches();
+    std::vector<uint8_t> cacheData() const;
+
+    VkDevice mDevice;
+    VkPhysicalDeviceProperties mPhysicalDeviceProperties;
+    std::string mPath;
+    VkPipelineCache mPipelineCache{VK_NULL_HANDLE};
+    bool mWarm{false};
+    std::mutex mMutex;
+    std::vector<VkPipelineCache> mWorkerCaches;
+};
+
+#endif //PRACTICE_VULKAN_VKPIPELINECACHESTORE_H
@@ -0,0 +1,472 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cassert>
+#include <functional>
+
+#include "VkPipelineManager.h"
+#include "VkTrace.h"
+#include "VkUtil.h"
+
+using namespace std;
+
+namespace {
+// boost::hash_combine과 같은 방법으로 값을 섞는다.
+template<typename T>
+void hashCombine(size_t *seed, const T &value) {
+    *seed ^= hash<T>()(value) + 0x9e3779b9 + (*seed << 6) + (*seed >> 2);
+}
+
+VkPipelineColorBlendAttachmentState blendAttachmentState(VkBlendMode blendMode) {
+    VkPipelineColorBlendAttachmentState pipelineColorBlendAttachmentState{
+            .colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
+                              VK_COLOR_COMPONENT_G_BIT |
+                              VK_COLOR_COMPONENT_B_BIT |
+                              VK_COLOR_COMPONENT_A_BIT
+    };
+
+    if (blendMode != VK_BLEND_MODE_OPAQUE) {
+        pipelineColorBlendAttachmentState.blendEnable = VK_TRUE;
+        pipelineColorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        pipelineColorBlendAttachmentState.dstColorBlendFactor = blendMode == VK_BLEND_MODE_ALPHA ?
+                                                                VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA :
+                                                                VK_BLEND_FACTOR_ONE;
+        pipelineColorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+        pipelineColorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        pipelineColorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        pipelineColorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
+    }
+
+    return pipelineColorBlendAttachmentState;
+}
+
+// extended dynamic state에서 동적으로 바꿀 수 있는 topology는 파이프라인과 같은 종류여야 한다.
+VkPrimitiveTopology topologyClass(VkPrimitiveTopology topology) {
+    switch (topology) {
+        case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+            return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+        case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+        case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+        case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+        case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+            return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+        case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+            return VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+        default:
+            return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    }
+}
+
+// Vulkan 1.3에서는 코어 함수로, 그 전에는 확장 함수로 가져온다.
+template<typename T>
+T deviceProcAddr(VkDevice device, const char *coreName, const char *extensionName) {
+    auto function = vkGetDeviceProcAddr(device, coreName);
+    if (!function) {
+        function = vkGetDeviceProcAddr(device, extensionName);
+    }
+    assert(function);
+    return reinterpret_cast<T>(function);
+}
+}
+
+size_t VkPipelineKeyHash::operator()(const VkPipelineKey &key) const {
+    // 구조체의 패딩이 섞이지 않도록 필드마다 해시한다.
+    size_t seed = 0;
+    hashCombine(&seed, key.vertexShader);
+    hashCombine(&seed, key.fragmentShader);
+    hashCombine(&seed, key.renderPass);
+    hashCombine(&seed, key.subpass);
+    hashCombine(&seed, static_cast<uint32_t>(key.colorFormat));
+    hashCombine(&seed, key.vertexLayout);
+    hashCombine(&seed, static_cast<uint32_t>(key.state.topology));
+    hashCombine(&seed, static_cast<uint32_t>(key.state.polygonMode));
+    hashCombine(&seed, static_cast<uint32_t>(key.state.cullMode));
+    hashCombine(&seed, static_cast<uint32_t>(key.state.frontFace));
+    hashCombine(&seed, static_cast<uint32_t>(key.state.blendMode));
+    hashCombine(&seed, static_cast<uint32_t>(key.state.depthCompareOp));
+    hashCombine(&seed, key.state.depthTest);
+    hashCombine(&seed, key.state.depthWrite);
+    return seed;
+}
+
+VkPipelineManager::VkPipelineManager(VkDevice device,
+                                     VkPipelineLayout pipelineLayout,
+                                     VkPipelineCache pipelineCache,
+                                     const VkPipelineFeatures &features,
+                                     VkPipelineKeyCreateFunction createFunction)
+        : mDevice(device),
+          mPipelineLayout(pipelineLayout),
+          mPipelineCache(pipelineCache),
+          mFeatures(features),
+          mCreateFunction(std::move(createFunction)) {
+    if (!mCreateFunction) {
+        mCreateFunction = [this](const VkPipelineKey &key, VkPipelineCache pipelineCache, VkPipeline *pipeline) {
+            return createPipeline(key, pipelineCache, pipeline);
+        };
+    }
+
+    if (mFeatures.extendedDynamicState && mDevice != VK_NULL_HANDLE) {
+        mCmdSetCullMode = deviceProcAddr<PFN_vkCmdSetCullModeEXT>(
+                mDevice, "vkCmdSetCullMode", "vkCmdSetCullModeEXT");
+        mCmdSetFrontFace = deviceProcAddr<PFN_vkCmdSetFrontFaceEXT>(
+                mDevice, "vkCmdSetFrontFace", "vkCmdSetFrontFaceEXT");
+        mCmdSetPrimitiveTopology = deviceProcAddr<PFN_vkCmdSetPrimitiveTopologyEXT>(
+                mDevice, "vkCmdSetPrimitiveTopology", "vkCmdSetPrimitiveTopologyEXT");
+        mCmdSetDepthTestEnable = deviceProcAddr<PFN_vkCmdSetDepthTestEnableEXT>(
+                mDevice, "vkCmdSetDepthTestEnable", "vkCmdSetDepthTestEnableEXT");
+        mCmdSetDepthWriteEnable = deviceProcAddr<PFN_vkCmdSetDepthWriteEnableEXT>(
+                mDevice, "vkCmdSetDepthWriteEnable", "vkCmdSetDepthWriteEnableEXT");
+        mCmdSetDepthCompareOp = deviceProcAddr<PFN_vkCmdSetDepthCompareOpEXT>(
+                mDevice, "vkCmdSetDepthCompareOp", "vkCmdSetDepthCompareOpEXT");
+    }
+
+    mCompileThread = thread(&VkPipelineManager::compileMain, this);
+}
+
+VkPipelineManager::~VkPipelineManager() {
+    {
+        lock_guard<mutex> lock(mCompileMutex);
+        mStop = true;
+    }
+    // 만들기를 멈추므로 남은 요청이 끝나기를 기다리는 스레드도 깨운다.
+    mCompileCondition.notify_all();
+    mIdleCondition.notify_all();
+    mCompileThread.join();
+
+    if (mDevice == VK_NULL_HANDLE) {
+        return;
+    }
+
+    for (auto &shard : mShards) {
+        for (auto &[key, pipeline] : shard.pipelines) {
+            vkDestroyPipeline(mDevice, pipeline, nullptr);
+        }
+    }
+}
+
+uint32_t VkPipelineManager::addVertexLayout(vector<VkVertexInputBindingDescription> bindings,
+                                            vector<VkVertexInputAttributeDescription> attributes) {
+    // 백그라운드 스레드가 읽기 시작한 후에 바뀌면 안 된다.
+    assert(mPipelineCount == 0);
+
+    mVertexLayouts.push_back({std::move(bindings), std::move(attributes)});
+    return static_cast<uint32_t>(mVertexLayouts.size() - 1);
+}
+
+VkResult VkPipelineManager::createPipeline(const VkPipelineKey &key,
+                                           VkPipelineCache pipelineCache,
+                                           VkPipeline *pipeline) const {
+    const auto &state = key.state;
+    const auto &vertexLayout = mVertexLayouts[key.vertexLayout];
+
+    array<VkPipelineShaderStageCreateInfo, 2> pipelineShaderStageCreateInfos{
+            VkPipelineShaderStageCreateInfo{
+                    .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                    .stage = VK_SHADER_STAGE_VERTEX_BIT,
+                    .module = key.vertexShader,
+                    .pName = "main"
+            },
+            VkPipelineShaderStageCreateInfo{
+                    .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                    .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+                    .module = key.fragmentShader,
+                    .pName = "main"
+            }
+    };
+
+    VkPipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+            .vertexBindingDescriptionCount = static_cast<uint32_t>(vertexLayout.bindings.size()),
+            .pVertexBindingDescriptions = vertexLayout.bindings.data(),
+            .vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexLayout.attributes.size()),
+            .pVertexAttributeDescriptions = vertexLayout.attributes.data()
+    };
+
+    VkPipelineInputAssemblyStateCreateInfo pipelineInputAssemblyStateCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+            .topology = state.topology
+    };
+
+    // viewport와 scissor는 동적 상태로 두어서 스왑체인의 크기가 바뀌어도 파이프라인을 다시 만들지 않는다.
+    VkPipelineViewportStateCreateInfo pipelineViewportStateCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+            .viewportCount = 1,
+            .scissorCount = 1
+    };
+
+    VkPipelineRasterizationStateCreateInfo pipelineRasterizationStateCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+            .polygonMode = state.polygonMode,
+            .cullMode = state.cullMode,
+            .frontFace = state.frontFace,
+            .lineWidth = 1.0f
+    };
+
+    VkPipelineMultisampleStateCreateInfo pipelineMultisampleStateCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+    };
+
+    VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilStateCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+            .depthTestEnable = state.depthTest,
+            .depthWriteEnable = state.depthWrite,
+            .depthCompareOp = state.depthCompareOp
+    };
+
+    auto pipelineColorBlendAttachmentState = blendAttachmentState(state.blendMode);
+
+    VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+            .attachmentCount = 1,
+            .pAttachments = &pipelineColorBlendAttachmentState
+    };
+
+    vector<VkDynamicState> dynamicStates{
+            VK_DYNAMIC_STATE_VIEWPORT,
+            VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    // 키를 정규화했으므로 여기서 사용한 값은 기록할 때 setDynamicState()로 덮어쓴다.
+    if (mFeatures.extendedDynamicState) {
+        dynamicStates.insert(dynamicStates.end(), {
+                VK_DYNAMIC_STATE_CULL_MODE,
+                VK_DYNAMIC_STATE_FRONT_FACE,
+                VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY,
+                VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+                VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+                VK_DYNAMIC_STATE_DEPTH_COMPARE_OP
+        });
+    }
+
+    VkPipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+            .dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
+            .pDynamicStates = dynamicStates.data()
+    };
+
+    // render pass 없이 dynamic rendering으로 그리면 attachment의 포맷을 직접 알려준다.
+    VkPipelineRenderingCreateInfo pipelineRenderingCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+            .colorAttachmentCount = 1,
+            .pColorAttachmentFormats = &key.colorFormat
+    };
+
+    VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext = key.renderPass == VK_NULL_HANDLE ? &pipelineRenderingCreateInfo : nullptr,
+            .stageCount = pipelineShaderStageCreateInfos.size(),
+            .pStages = pipelineShaderStageCreateInfos.data(),
+            .pVertexInputState = &pipelineVertexInputStateCreateInfo,
+            .pInputAssemblyState = &pipelineInputAssemblyStateCreateInfo,
+            .pViewportState = &pipelineViewportStateCreateInfo,
+            .pRasterizationState = &pipelineRasterizationStateCreateInfo,
+            .pMultisampleState = &pipelineMultisampleStateCreateInfo,
+            .pDepthStencilState = &pipelineDepthStencilStateCreateInfo,
+            .pColorBlendState = &pipelineColorBlendStateCreateInfo,
+            .pDynamicState = &pipelineDynamicStateCreateInfo,
+            .layout = mPipelineLayout,
+            .renderPass = key.renderPass,
+            .subpass = key.subpass
+    };
+
+    return vkCreateGraphicsPipelines(mDevice,
+                                     pipelineCache,
+                                     1,
+                                     &graphicsPipelineCreateInfo,
+                                     nullptr,
+                                     pipeline);
+}
+
+void VkPipelineManager::insert(const VkPipelineKey &key, VkPipeline pipeline) {
+    auto normalizedKey = normalize(key);
+    auto &keyShard = shard(normalizedKey);
+    unique_lock<shared_mutex> lock(keyShard.mutex);
+
+    auto [iterator, inserted] = keyShard.pipelines.emplace(normalizedKey, pipeline);
+    assert(inserted); // 요청되어 만들고 있는 키이면 백그라운드 스레드가 만든 것과 겹친다.
+    mPipelineCount.fetch_add(1, memory_order_relaxed);
+}
+
+void VkPipelineManager::setFallback(const VkPipelineKey &key) {
+    auto normalizedKey = normalize(key);
+    auto &keyShard = shard(normalizedKey);
+    shared_lock<shared_mutex> lock(keyShard.mutex);
+
+    auto iterator = keyShard.pipelines.find(normalizedKey);
+    assert(iterator != keyShard.pipelines.end() && iterator->second != VK_NULL_HANDLE);
+    mFallbackPipelines[topologyClass(key.state.topology)].store(iterator->second, memory_order_release);
+}
+
+VkPipeline VkPipelineManager::request(const VkPipelineKey &requestedKey) {
+    auto key = normalize(requestedKey);
+    auto &keyShard = shard(key);
+
+    // ================================================================================
+    // 1. 읽기 잠금으로 찾기
+    // ================================================================================
+    // 대부분의 요청은 이미 만들어진 파이프라인이므로 여러 스레드가 동시에 찾을 수 있다.
+    {
+        shared_lock<shared_mutex> lock(keyShard.mutex);
+
+        auto iterator = keyShard.pipelines.find(key);
+        if (iterator != keyShard.pipelines.end()) {
+            if (iterator->second != VK_NULL_HANDLE) {
+                mHitCount.fetch_add(1, memory_order_relaxed);
+                return iterator->second;
+            }
+
+            return fallback(key);
+        }
+    }
+
+    // ================================================================================
+    // 2. 없으면 자리를 만들고 백그라운드 스레드에 넘기기
+    // ================================================================================
+    {
+        unique_lock<shared_mutex> lock(keyShard.mutex);
+
+        // 잠금을 바꾸는 사이에 다른 스레드가 먼저 넣었으면 그 스레드가 이미 요청했다.
+        auto [iterator, inserted] = keyShard.pipelines.emplace(key, VK_NULL_HANDLE);
+        if (!inserted && iterator->second != VK_NULL_HANDLE) {
+            mHitCount.fetch_add(1, memory_order_relaxed);
+            return iterator->second;
+        }
+
+        if (inserted) {
+            mMissCount.fetch_add(1, memory_order_relaxed);
+            {
+                lock_guard<mutex> compileLock(mCompileMutex);
+                mCompileQueue.push_back(key);
+                ++mPendingCount;
+            }
+            mCompileCondition.notify_one();
+        }
+    }
+
+    return fallback(key);
+}
+
+void VkPipelineManager::setDynamicState(VkCommandBuffer commandBuffer, const VkPipelineState &state) const {
+    if (!mFeatures.extendedDynamicState) {
+        return;
+    }
+
+    mCmdSetCullMode(commandBuffer, state.cullMode);
+    mCmdSetFrontFace(commandBuffer, state.frontFace);
+    mCmdSetPrimitiveTopology(commandBuffer, state.topology);
+    mCmdSetDepthTestEnable(commandBuffer, state.depthTest);
+    mCmdSetDepthWriteEnable(commandBuffer, state.depthWrite);
+    mCmdSetDepthCompareOp(commandBuffer, state.depthCompareOp);
+}
+
+void VkPipelineManager::waitIdle() {
+    unique_lock<mutex> lock(mCompileMutex);
+    // 파괴되기 시작하면 큐에 남은 파이프라인은 만들지 않으므로 기다리지 않는다.
+    mIdleCondition.wait(lock, [this] { return mStop || mPendingCount == 0; });
+}
+
+VkPipelineManagerStats VkPipelineManager::stats() const {
+    uint32_t pendingCount;
+    {
+        lock_guard<mutex> lock(mCompileMutex);
+        pendingCount = mPendingCount;
+    }
+
+    return {
+            .pipelineCount = mPipelineCount.load(memory_order_relaxed),
+            .pendingCount = pendingCount,
+            .hitCount = mHitCount.load(memory_order_relaxed),
+            .missCount = mMissCount.load(memory_order_relaxed),
+            .fallbackCount = mFallbackCount.load(memory_order_relaxed),
+            .skipCount = mSkipCount.load(memory_order_relaxed),
+            .failureCount = mFailureCount.load(memory_order_relaxed)
+    };
+}
+
+VkPipelineKey VkPipelineManager::normalize(const VkPipelineKey &key) const {
+    if (!mFeatures.extendedDynamicState) {
+        return key;
+    }
+
+    VkPipelineState defaultState;
+    auto normalizedKey = key;
+    normalizedKey.state.topology = topologyClass(key.state.topology);
+    normalizedKey.state.cullMode = defaultState.cullMode;
+    normalizedKey.state.frontFace = defaultState.frontFace;
+    normalizedKey.state.depthCompareOp = defaultState.depthCompareOp;
+    normalizedKey.state.depthTest = defaultState.depthTest;
+    normalizedKey.state.depthWrite = defaultState.depthWrite;
+    return normalizedKey;
+}
+
+VkPipeline VkPipelineManager::fallback(const VkPipelineKey &key) {
+    auto pipeline = mFallbackPipelines[topologyClass(key.state.topology)].load(memory_order_acquire);
+    if (pipeline == VK_NULL_HANDLE) {
+        mSkipCount.fetch_add(1, memory_order_relaxed);
+    } else {
+        mFallbackCount.fetch_add(1, memory_order_relaxed);
+    }
+    return pipeline;
+}
+
+void VkPipelineManager::compileMain() {
+    VK_TRACE_THREAD_NAME("PipelineCompile");
+
+    while (true) {
+        VkPipelineKey key;
+        {
+            unique_lock<mutex> lock(mCompileMutex);
+            mCompileCondition.wait(lock, [this] { return mStop || !mCompileQueue.empty(); });
+            if (mStop) {
+                return;
+            }
+
+            key = mCompileQueue.front();
+            mCompileQueue.pop_front();
+        }
+
+        VkPipeline pipeline{VK_NULL_HANDLE};
+        VkResult result;
+        {
+            VK_TRACE_SCOPE("CreatePipeline");
+            result = mCreateFunction(key, mPipelineCache, &pipeline);
+        }
+
+        // 실패해도 렌더링은 계속한다. 키는 VK_NULL_HANDLE로 남으므로 다시 요청되지 않고 fallback으로 그린다.
+        if (result == VK_SUCCESS) {
+            auto &keyShard = shard(key);
+            unique_lock<shared_mutex> lock(keyShard.mutex);
+            keyShard.pipelines[key] = pipeline;
+            mPipelineCount.fetch_add(1, memory_order_relaxed);
+        } else {
+            aout << "createPipeline returns " << vkToString(result) << "." << endl;
+            mFailureCount.fetch_add(1, memory_order_relaxed);
+        }
+
+        {
+            lock_guard<mutex> lock(mCompileMutex);
+            --mPendingCount;
+        }
+        mIdleCondition.notify_all();
+    }
+}
@@ -0,0 +1,224 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKPIPELINEMANAGER_H
+#define PRACTICE_VULKAN_VKPIPELINEMANAGER_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+enum VkBlendMode {
+    VK_BLEND_MODE_OPAQUE,
+    VK_BLEND_MODE_ALPHA,   // src * srcAlpha + dst * (1 - srcAlpha)
+    VK_BLEND_MODE_ADDITIVE // src * srcAlpha + dst
+};
+
+// 셰이더와 render pass를 제외한 파이프라인의 고정 상태. 재질마다 달라질 수 있는 것만 둔다.
+// viewport와 scissor는 항상 동적 상태이므로 포함하지 않는다.
+// extended dynamic state를 사용하면 topology의 종류를 제외한 래스터화와 깊이 상태도 동적 상태가 되어
+// 그 상태들만 다른 키는 같은 파이프라인을 사용한다. VkPipelineManager::setDynamicState로 기록한다.
+struct VkPipelineState {
+    VkPrimitiveTopology topology{VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST};
+    VkPolygonMode polygonMode{VK_POLYGON_MODE_FILL};
+    VkCullModeFlags cullMode{VK_CULL_MODE_NONE};
+    VkFrontFace frontFace{VK_FRONT_FACE_COUNTER_CLOCKWISE};
+    VkBlendMode blendMode{VK_BLEND_MODE_OPAQUE};
+    VkCompareOp depthCompareOp{VK_COMPARE_OP_LESS_OR_EQUAL};
+    bool depthTest{false};
+    bool depthWrite{false};
+
+    bool operator==(const VkPipelineState &other) const {
+        return topology == other.topology &&
+               polygonMode == other.polygonMode &&
+               cullMode == other.cullMode &&
+               frontFace == other.frontFace &&
+               blendMode == other.blendMode &&
+               depthCompareOp == other.depthCompareOp &&
+               depthTest == other.depthTest &&
+               depthWrite == other.depthWrite;
+    }
+};
+
+// 파이프라인을 구분하는 키. 같은 키이면 같은 파이프라인을 사용한다.
+// render pass는 호환되는 render pass끼리 같은 파이프라인을 사용할 수 있으므로 대표하는 것 하나를 넣는다.
+// dynamic rendering을 사용하면 renderPass는 VK_NULL_HANDLE이고 colorFormat만으로 호환성이 결정된다.
+struct VkPipelineKey {
+    VkShaderModule vertexShader;
+    VkShaderModule fragmentShader;
+    VkRenderPass renderPass;
+    uint32_t subpass;
+    VkFormat colorFormat;
+    uint32_t vertexLayout; // VkPipelineManager::addVertexLayout이 반환한 번호
+    VkPipelineState state;
+
+    bool operator==(const VkPipelineKey &other) const {
+        return vertexShader == other.vertexShader &&
+               fragmentShader == other.fragmentShader &&
+               renderPass == other.renderPass &&
+               subpass == other.subpass &&
+               colorFormat == other.colorFormat &&
+               vertexLayout == other.vertexLayout &&
+               state == other.state;
+    }
+};
+
+struct VkPipelineKeyHash {
+    size_t operator()(const VkPipelineKey &key) const;
+};
+
+// 장치에서 활성화된 파이프라인 관련 기능.
+struct VkPipelineFeatures {
+    bool dynamicRendering;     // VK_KHR_dynamic_rendering (Vulkan 1.3 core)
+    bool extendedDynamicState; // VK_EXT_extended_dynamic_state (Vulkan 1.3 core)
+};
+
+// 백그라운드 스레드에서 키로부터 파이프라인을 만든다. 기본값은 VkPipelineManager::createPipeline이다.
+typedef std::function<VkResult(const VkPipelineKey &key,
+                               VkPipelineCache pipelineCache,
+                               VkPipeline *pipeline)> VkPipelineKeyCreateFunction;
+
+struct VkPipelineManagerStats {
+    uint32_t pipelineCount;  // 만들어진 파이프라인의 수
+    uint32_t pendingCount;   // 만들고 있거나 만들기를 기다리는 파이프라인의 수
+    uint64_t hitCount;       // 만들어진 파이프라인을 찾은 횟수
+    uint64_t missCount;      // 처음 요청되어 만들기 시작한 횟수
+    uint64_t fallbackCount;  // 아직 만들어지지 않아서 대신 fallback을 반환한 횟수
+    uint64_t skipCount;      // 같은 topology 종류의 fallback이 없어서 VK_NULL_HANDLE을 반환한 횟수
+    uint32_t failureCount;   // 만들기에 실패한 파이프라인의 수. 실패한 키에는 계속 fallback을 반환한다.
+};
+
+// 파이프라인 상태를 키로 해서 VkPipeline을 찾고, 없으면 백그라운드 스레드에서 만든다.
+// 만드는 동안은 fallback 파이프라인을 반환하므로 처음 보는 재질이나 상태 조합이 프레임을 멈추지 않는다.
+//
+// 찾기는 기록 스레드에서 동시에 호출되므로 키의 해시로 나눈 샤드마다 shared_mutex를 둔다.
+// 작업 시스템은 기다리는 스레드도 다른 작업을 실행하므로, 오래 걸리는 파이프라인 생성을 작업으로 넣으면
+// 프레임의 기록을 기다리던 스레드가 그것을 가져가서 프레임이 멈출 수 있다. 그래서 전용 스레드에서 만든다.
+class VkPipelineManager {
+public:
+    static constexpr uint32_t kShardCount = 16;
+
+    // pipelineCache는 전용 스레드만 사용하므로 VkPipelineCacheStore::createWorkerCache()로 만든 캐시를 넘긴다.
+    // device가 VK_NULL_HANDLE이면 파이프라인을 파괴하지 않고 키와 fallback만 관리한다. createFunction과 함께 테스트에서 사용한다.
+    VkPipelineManager(VkDevice device,
+                      VkPipelineLayout pipelineLayout,
+                      VkPipelineCache pipelineCache,
+                      const VkPipelineFeatures &features,
+                      VkPipelineKeyCreateFunction createFunction = {});
+    ~VkPipelineManager();
+
+    VkPipelineManager(const VkPipelineManager &) = delete;
+    VkPipelineManager &operator=(const VkPipelineManager &) = delete;
+
+    // 정점 입력 레이아웃을 등록하고 키에 넣을 번호를 반환한다. 파이프라인을 만들기 전에 모두 등록해야 한다.
+    uint32_t addVertexLayout(std::vector<VkVertexInputBindingDescription> bindings,
+                             std::vector<VkVertexInputAttributeDescription> attributes);
+
+    // 키로부터 파이프라인을 만든다. 캐시에 넣지 않으므로 insert()로 넘기거나 호출하는 쪽에서 파괴한다.
+    // 여러 스레드에서 동시에 호출할 수 있다.
+    VkResult createPipeline(const VkPipelineKey &key, VkPipelineCache pipelineCache, VkPipeline *pipeline) const;
+
+    // 이미 만들어진 파이프라인을 캐시에 넣는다. 파이프라인은 VkPipelineManager가 파괴한다.
+    void insert(const VkPipelineKey &key, VkPipeline pipeline);
+
+    // 요청한 파이프라인이 아직 없을 때 대신 사용할 파이프라인. insert()로 넣은 키여야 한다.
+    // topology의 종류(점, 선, 삼각형, 패치)마다 하나씩 둘 수 있고, 같은 종류의 요청에만 사용한다.
+    void setFallback(const VkPipelineKey &key);
+
+    // 파이프라인을 찾는다. 없으면 백그라운드에서 만들기 시작하고 fallback을 반환한다. 여러 스레드에서 호출할 수 있다.
+    // 요청한 topology와 같은 종류의 fallback이 없으면 VK_NULL_HANDLE을 반환하고, 호출하는 쪽은 그리지 않는다.
+    // 다른 종류의 파이프라인에 setDynamicState()로 topology를 기록하면 잘못된 그리기가 되기 때문이다.
+    VkPipeline request(const VkPipelineKey &requestedKey);
+
+    // 동적 상태로 만든 상태를 기록한다. 파이프라인을 바인드한 후에 호출한다.
+    void setDynamicState(VkCommandBuffer commandBuffer, const VkPipelineState &state) const;
+
+    // 요청된 파이프라인을 모두 만들 때까지 기다린다. 파괴되기 시작하면 바로 반환한다.
+    void waitIdle();
+
+    const VkPipelineFeatures &features() const { return mFeatures; }
+
+    VkPipelineManagerStats stats() const;
+
+private:
+    struct VertexLayout {
+        std::vector<VkVertexInputBindingDescription> bindings;
+        std::vector<VkVertexInputAttributeDescription> attributes;
+    };
+
+    // 만들고 있거나 만들기에 실패한 파이프라인은 VK_NULL_HANDLE로 들어있다.
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<VkPipelineKey, VkPipeline, VkPipelineKeyHash> pipelines;
+    };
+
+    Shard &shard(const VkPipelineKey &key) { return mShards[VkPipelineKeyHash()(key) % kShardCount]; }
+
+    // 동적 상태로 설정되는 필드를 기본값으로 바꿔서 그 필드만 다른 키가 같은 파이프라인을 찾게 한다.
+    VkPipelineKey normalize(const VkPipelineKey &key) const;
+
+    // key와 같은 topology 종류의 fallback을 반환한다. 없으면 VK_NULL_HANDLE이다.
+    VkPipeline fallback(const VkPipelineKey &key);
+
+    void compileMain();
+
+    VkDevice mDevice;
+    VkPipelineLayout mPipelineLayout;
+    VkPipelineCache mPipelineCache;
+    VkPipelineFeatures mFeatures;
+    VkPipelineKeyCreateFunction mCreateFunction;
+    PFN_vkCmdSetCullModeEXT mCmdSetCullMode{nullptr};
+    PFN_vkCmdSetFrontFaceEXT mCmdSetFrontFace{nullptr};
+    PFN_vkCmdSetPrimitiveTopologyEXT mCmdSetPrimitiveTopology{nullptr};
+    PFN_vkCmdSetDepthTestEnableEXT mCmdSetDepthTestEnable{nullptr};
+    PFN_vkCmdSetDepthWriteEnableEXT mCmdSetDepthWriteEnable{nullptr};
+    PFN_vkCmdSetDepthCompareOpEXT mCmdSetDepthCompareOp{nullptr};
+    std::vector<VertexLayout> mVertexLayouts;
+    std::array<Shard, kShardCount> mShards;
+    // topology 종류를 대표하는 VkPrimitiveTopology 값을 인덱스로 사용한다.
+    std::array<std::atomic<VkPipeline>, VK_PRIMITIVE_TOPOLOGY_PATCH_LIST + 1> mFallbackPipelines{};
+    mutable std::mutex mCompileMutex;
+    std::condition_variable mCompileCondition;
+    std::condition_variable mIdleCondition;
+    std::deque<VkPipelineKey> mCompileQueue;
+    uint32_t mPendingCount{0}; // mCompileMutex로 보호된다. 큐에 있거나 만들고 있는 파이프라인의 수
+    bool mStop{false};
+    std::atomic<uint32_t> mPipelineCount{0};
+    std::atomic<uint64_t> mHitCount{0};
+    std::atomic<uint64_t> mMissCount{0};
+    std::atomic<uint64_t> mFallbackCount{0};
+    std::atomic<uint64_t> mSkipCount{0};
+    std::atomic<uint32_t> mFailureCount{0};
+    std::thread mCompileThread;
+};
+
+#endif //PRACTICE_VULKAN_VKPIPELINEMANAGER_H
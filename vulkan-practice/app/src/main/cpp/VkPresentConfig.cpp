@@ -0,0 +1,92 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include "VkPresentConfig.h"
+
+using namespace std;
+
+VkPresentModeKHR vkChoosePresentMode(VkPresentModeKHR requested,
+                                     const vector<VkPresentModeKHR> &availablePresentModes) {
+    vector<VkPresentModeKHR> candidates;
+    switch (requested) {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR:
+            candidates = {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+            break;
+        case VK_PRESENT_MODE_MAILBOX_KHR:
+            // IMMEDIATE로 대체하면 티어링이 생기므로 FIFO를 사용한다.
+            candidates = {VK_PRESENT_MODE_MAILBOX_KHR};
+            break;
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+            candidates = {VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+            break;
+        default:
+            break;
+    }
+
+    for (auto candidate : candidates) {
+        if (find(availablePresentModes.begin(), availablePresentModes.end(), candidate) !=
+            availablePresentModes.end()) {
+            return candidate;
+        }
+    }
+
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+uint32_t vkChooseSwapchainImageCount(const VkPresentConfig &config,
+                                     VkPresentModeKHR presentMode,
+                                     const VkSurfaceCapabilitiesKHR &surfaceCapabilities) {
+    auto imageCount = config.imageCount;
+    if (imageCount == 0) {
+        if (presentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
+            // 출력중인 이미지, 교체를 기다리는 이미지, 렌더링중인 이미지가 동시에 필요하다.
+            imageCount = max(surfaceCapabilities.minImageCount + 1, 3u);
+        } else {
+            // FIFO에서는 이미지가 많을수록 큐에 쌓인 프레임만큼 지연이 늘어나므로 최소 개수를 사용한다.
+            imageCount = surfaceCapabilities.minImageCount;
+        }
+    }
+
+    imageCount = max(imageCount, surfaceCapabilities.minImageCount);
+    // maxImageCount가 0이면 제한이 없다.
+    if (surfaceCapabilities.maxImageCount != 0) {
+        imageCount = min(imageCount, surfaceCapabilities.maxImageCount);
+    }
+
+    return imageCount;
+}
+
+VkExtent2D vkChooseSwapchainExtent(const VkSurfaceCapabilitiesKHR &surfaceCapabilities, VkExtent2D windowExtent) {
+    if (surfaceCapabilities.currentExtent.width != UINT32_MAX) {
+        return surfaceCapabilities.currentExtent;
+    }
+
+    return {
+            clamp(windowExtent.width,
+                  surfaceCapabilities.minImageExtent.width,
+                  surfaceCapabilities.maxImageExtent.width),
+            clamp(windowExtent.height,
+                  surfaceCapabilities.minImageExtent.height,
+                  surfaceCapabilities.maxImageExtent.height)
+    };
+}
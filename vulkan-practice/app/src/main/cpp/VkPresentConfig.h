@@ -0,0 +1,65 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKPRESENTCONFIG_H
+#define PRACTICE_VULKAN_VKPRESENTCONFIG_H
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// 화면 출력 방식.
+struct VkPresentConfig {
+    // 지원하지 않으면 vkChoosePresentMode의 순서에 따라 대체한다.
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    // 스왑체인 이미지의 개수. 0이면 출력 방식에 맞춰 정한다.
+    uint32_t imageCount = 0;
+    // CPU가 이전 프레임의 GPU 실행이 끝난 후에 다음 프레임을 시작한다.
+    // 처리량은 줄어들 수 있지만 입력을 읽고 화면에 출력될 때까지의 지연이 줄어든다.
+    bool lowLatency = false;
+};
+
+// 출력 방식별로 측정한 결과.
+struct VkPresentStats {
+    VkPresentModeKHR presentMode;    // 실제로 사용하는 출력 방식
+    uint32_t imageCount;             // 실제로 사용하는 스왑체인 이미지의 개수
+    uint64_t frameCount{0};
+    double frameTime{0.0};           // 평균 present 간격. 밀리초
+    uint64_t latencySampleCount{0};  // VK_GOOGLE_display_timing을 지원하지 않으면 0
+    double latency{0.0};             // 프레임 시작부터 화면에 출력될 때까지의 평균 시간. 밀리초
+    uint64_t refreshDuration{0};     // 디스플레이 주기. 나노초. VK_GOOGLE_display_timing을 지원하지 않으면 0
+};
+
+// requested를 지원하지 않으면 비슷한 성격의 방식을 사용한다. FIFO는 항상 지원된다.
+// MAILBOX -> FIFO, IMMEDIATE -> MAILBOX -> FIFO, FIFO_RELAXED -> FIFO
+VkPresentModeKHR vkChoosePresentMode(VkPresentModeKHR requested,
+                                     const std::vector<VkPresentModeKHR> &availablePresentModes);
+
+// surface가 허용하는 범위 안에서 스왑체인 이미지의 개수를 정한다.
+uint32_t vkChooseSwapchainImageCount(const VkPresentConfig &config,
+                                     VkPresentModeKHR presentMode,
+                                     const VkSurfaceCapabilitiesKHR &surfaceCapabilities);
+
+// 스왑체인 이미지의 크기. currentExtent가 0xFFFFFFFF이면 스왑체인이 크기를 정하므로 창의 크기를 허용 범위로 제한해서 사용한다.
+VkExtent2D vkChooseSwapchainExtent(const VkSurfaceCapabilitiesKHR &surfaceCapabilities, VkExtent2D windowExtent);
+
+#endif //PRACTICE_VULKAN_VKPRESENTCONFIG_H
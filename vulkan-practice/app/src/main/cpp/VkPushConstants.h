@@ -0,0 +1,77 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKPUSHCONSTANTS_H
+#define PRACTICE_VULKAN_VKPUSHCONSTANTS_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <type_traits>
+#include <vulkan/vulkan.h>
+
+#include "AndroidOut.h"
+
+// 모든 장치가 지원하는 maxPushConstantsSize의 최소값.
+constexpr uint32_t kMinMaxPushConstantsSize = 128;
+
+// 타입이 정해진 push constant 범위. VkPipelineLayout을 만들 때 range()를 넘기고,
+// 기록할 때 같은 stageFlags와 offset으로 push()를 호출하므로 레이아웃과 기록이 어긋나지 않는다.
+// T는 셰이더의 push_constant 블록과 같은 std430 레이아웃이어야 한다.
+template<typename T>
+class VkPushConstants {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "push constant는 memcpy로 복사할 수 있어야 한다.");
+    static_assert(sizeof(T) % 4 == 0, "push constant의 크기는 4의 배수여야 한다.");
+    static_assert(sizeof(T) <= kMinMaxPushConstantsSize, "모든 장치에서 사용할 수 있는 크기를 넘는다.");
+
+    // offset + sizeof(T)가 장치의 maxPushConstantsSize를 넘지 않는지 확인한다.
+    // 넘으면 파이프라인 레이아웃과 기록이 모두 잘못되므로 릴리즈 빌드에서도 중단한다.
+    VkPushConstants(const VkPhysicalDeviceLimits &limits, VkShaderStageFlags stageFlags, uint32_t offset = 0)
+            : mStageFlags(stageFlags),
+              mOffset(offset) {
+        if (offset % 4 != 0 || offset + sizeof(T) > limits.maxPushConstantsSize) {
+            aout << "Push constant range [" << offset << ", " << offset + sizeof(T)
+                 << ") is invalid for maxPushConstantsSize " << limits.maxPushConstantsSize << "." << std::endl;
+            abort();
+        }
+    }
+
+    VkPushConstantRange range() const {
+        return {
+                .stageFlags = mStageFlags,
+                .offset = mOffset,
+                .size = static_cast<uint32_t>(sizeof(T))
+        };
+    }
+
+    // command buffer에 값을 기록한다. 버퍼나 descriptor를 갱신하지 않으므로 그리기마다 호출해도 된다.
+    void push(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, const T &value) const {
+        vkCmdPushConstants(commandBuffer, pipelineLayout, mStageFlags, mOffset, sizeof(T), &value);
+    }
+
+private:
+    VkShaderStageFlags mStageFlags;
+    uint32_t mOffset;
+};
+
+#endif //PRACTICE_VULKAN_VKPUSHCONSTANTS_H
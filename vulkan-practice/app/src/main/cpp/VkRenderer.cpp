@@ -20,41 +20,62 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
+#include <cstring>
+#include <cstdlib>
 #include <array>
+#include <iterator>
+#include <memory>
 #include <vector>
 #include <iomanip>
 
 #include "VkRenderer.h"
+#include "VkDeviceSelector.h"
+#include "VkPipelineBuilder.h"
+#include "VkPipelineCacheStore.h"
+#ifdef VK_RUNTIME_SHADER_COMPILE
+#include "VkShaderCache.h"
+#endif
+#include "triangle.vert.h"
+#ifndef VK_RUNTIME_SHADER_COMPILE
+#include "triangle.ubo.vert.h"
+#endif
+#include "triangle.frag.h"
+#include "VkTrace.h"
 #include "VkUtil.h"
 #include "AndroidOut.h"
 
 using namespace std;
 
-struct Vector3 {
-    union {
-        float x;
-        float r;
-    };
-
-    union {
-        float y;
-        float g;
-    };
+// 그리기가 이보다 적으면 secondary command buffer로 나누지 않는다.
+constexpr uint32_t kMinParallelDrawCount = 64;
 
-    union {
-        float z;
-        float b;
-    };
+// 프레임마다 set 1, binding 0의 uniform buffer로 넘기는 상수. triangle.vert의 FrameConstants 블록과 같은 std140 레이아웃이다.
+struct FrameConstants {
+    array<array<float, 4>, 2> preRotation; // mat2. std140에서 mat2의 열은 vec4의 크기를 차지한다.
 };
 
-struct Vertex {
-    Vector3 position;
-    Vector3 color;
-};
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+VkRenderer::VkRenderer(ANativeWindow *window, const VkRendererConfig &config) : mPresentConfig(config.present) {
+    createInstance(true);
+    createDevice(true, config);
+    createSurface(window);
+    createSwapchain();
+    createRenderResources(config);
+}
+#endif
+
+VkRenderer::VkRenderer(VkExtent2D extent, const VkRendererConfig &config) {
+    createInstance(false);
+    createDevice(false, config);
+    createOffscreenImages(extent, config.maxFramesInFlight);
+    createRenderResources(config);
+}
 
-VkRenderer::VkRenderer(ANativeWindow *window) {
+void VkRenderer::createInstance(bool presentable) {
     // ================================================================================
     // 1. VkInstance 생성
     // ================================================================================
@@ -91,13 +112,15 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
                                                           instanceExtensionProperties.data()));
 
     vector<const char *> instanceExtensionNames; // instanceExtensionName을 담는 배열
-    for (const auto &properties: instanceExtensionProperties) {
-        if (properties.extensionName == string("VK_KHR_surface") ||
-            properties.extensionName == string("VK_KHR_android_surface")) {
-            instanceExtensionNames.push_back(properties.extensionName);
+    if (presentable) { // 헤드리스 모드에서는 surface 관련 extension이 필요 없다.
+        for (const auto &properties: instanceExtensionProperties) {
+            if (properties.extensionName == string("VK_KHR_surface") ||
+                properties.extensionName == string("VK_KHR_android_surface")) {
+                instanceExtensionNames.push_back(properties.extensionName);
+            }
         }
+        assert(instanceExtensionNames.size() == 2); // 반드시 2개의 이름이 필요하기 때문에 확인
     }
-    assert(instanceExtensionNames.size() == 2); // 반드시 2개의 이름이 필요하기 때문에 확인
 
     // sType: 구조체의 타입, pApplicationInfo: 어플리케이션의 이름
     // enabledLayerCount, ppEnableLayerNames: 사용할 레이어의 정보를 정의
@@ -112,8 +135,9 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
 
     // vkCreateInstance로 인스턴스 생성. 생성된 인스턴스가 mInstance에 쓰여진다.
     VK_CHECK_ERROR(vkCreateInstance(&instanceCreateInfo, nullptr, &mInstance));
+}
 
-
+void VkRenderer::createDevice(bool presentable, const VkRendererConfig &config) {
     // ================================================================================
     // 2. VkPhysicalDevice 선택
     // ================================================================================
@@ -123,27 +147,41 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
     vector<VkPhysicalDevice> physicalDevices(physicalDeviceCount);
     VK_CHECK_ERROR(vkEnumeratePhysicalDevices(mInstance, &physicalDeviceCount, physicalDevices.data()));
 
-    // 간단한 예제를 위해 첫 번째 VkPhysicalDevice를 사용
-    mPhysicalDevice = physicalDevices[0];
+    // 첫 번째 장치가 소프트웨어 구현일 수도 있으므로 모든 장치의 점수를 매겨서 선택한다.
+    vector<VkDeviceCandidate> candidates;
+    for (auto physicalDevice : physicalDevices) {
+        candidates.push_back(vkQueryDeviceCandidate(physicalDevice));
+    }
+
+    auto environmentDevice = getenv(kDeviceEnvironmentVariable);
+    auto physicalDeviceIndex = vkSelectDevice(candidates,
+                                              presentable,
+                                              environmentDevice ? environmentDevice : config.physicalDevice);
+    // 렌더러를 실행할 수 있는 장치가 반드시 필요하다. 릴리즈 빌드에서도 확인해야 하므로 assert를 사용하지 않는다.
+    if (!physicalDeviceIndex) {
+        aout << "No physical device can run the renderer. Vulkan 1.2 with descriptor indexing is required." << endl;
+        abort();
+    }
+    mPhysicalDevice = physicalDevices[*physicalDeviceIndex];
 
-    VkPhysicalDeviceProperties physicalDeviceProperties; // 이 구조체 안에 GPU에 필요한 모든 정보가 있다.
-    vkGetPhysicalDeviceProperties(mPhysicalDevice, &physicalDeviceProperties);
+    // 이 구조체 안에 GPU에 필요한 모든 정보가 있다.
+    vkGetPhysicalDeviceProperties(mPhysicalDevice, &mPhysicalDeviceProperties);
 
     aout << "Selected Physical Device Information ↓" << endl;
     aout << setw(16) << left << " - Device Name: "
-         << string_view(physicalDeviceProperties.deviceName) << endl;
+         << string_view(mPhysicalDeviceProperties.deviceName) << endl;
     aout << setw(16) << left << " - Device Type: "
-         << vkToString(physicalDeviceProperties.deviceType) << endl;
+         << vkToString(mPhysicalDeviceProperties.deviceType) << endl;
     aout << std::hex;
-    aout << setw(16) << left << " - Device ID: " << physicalDeviceProperties.deviceID << endl;
-    aout << setw(16) << left << " - Vendor ID: " << physicalDeviceProperties.vendorID << endl;
+    aout << setw(16) << left << " - Device ID: " << mPhysicalDeviceProperties.deviceID << endl;
+    aout << setw(16) << left << " - Vendor ID: " << mPhysicalDeviceProperties.vendorID << endl;
     aout << std::dec;
     aout << setw(16) << left << " - API Version: "
-         << VK_API_VERSION_MAJOR(physicalDeviceProperties.apiVersion) << "."
-         << VK_API_VERSION_MINOR(physicalDeviceProperties.apiVersion);
+         << VK_API_VERSION_MAJOR(mPhysicalDeviceProperties.apiVersion) << "."
+         << VK_API_VERSION_MINOR(mPhysicalDeviceProperties.apiVersion);
     aout << setw(16) << left << " - Driver Version: "
-         << VK_API_VERSION_MAJOR(physicalDeviceProperties.driverVersion) << "."
-         << VK_API_VERSION_MINOR(physicalDeviceProperties.driverVersion);
+         << VK_API_VERSION_MAJOR(mPhysicalDeviceProperties.driverVersion) << "."
+         << VK_API_VERSION_MINOR(mPhysicalDeviceProperties.driverVersion);
 
     // ================================================================================
     // 3. VkPhysicalDeviceMemoryProperties 얻기
@@ -165,23 +203,16 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
     vkGetPhysicalDeviceQueueFamilyProperties(mPhysicalDevice, &queueFamilyPropertiesCount, queueFamilyProperties.data());
     //---------------------------------------------------------------------------------
 
-    // 특정 queueFamilyProperties가 VK_QUEUE_GRAPHICS_BIT를 지원하는지 확인.
-    // 지원하는 queueFamilyProperties를 찾으면 break. queueFamily에 대한 정보는 mQueueFamilyIndex에 저장.
-    for (mQueueFamilyIndex = 0;
-         mQueueFamilyIndex != queueFamilyPropertiesCount; ++mQueueFamilyIndex) {
-        if (queueFamilyProperties[mQueueFamilyIndex].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-            break;
-        }
-    }
+    // graphics를 지원하는 queueFamily와 함께 compute, transfer 전용 queueFamily를 찾는다.
+    // 전용 큐는 graphics 큐와 동시에 실행되므로 업로드나 compute 작업이 렌더링 뒤에 줄을 서지 않는다.
+    auto queueFamilyIndices = vkChooseQueueFamilies(queueFamilyProperties);
+    mQueueFamilyIndex = queueFamilyIndices.graphics;
 
-    // 생성할 큐를 정의
-    const vector<float> queuePriorities{1.0};
-    VkDeviceQueueCreateInfo deviceQueueCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-            .queueFamilyIndex = mQueueFamilyIndex,      // queueFamilyIndex
-            .queueCount = 1,                            // 생성할 큐의 개수
-            .pQueuePriorities = queuePriorities.data()  // 큐의 우선순위
-    };
+    // 타임스탬프 쿼리의 유효한 비트 수. 0이면 이 큐에서 타임스탬프를 사용할 수 없다.
+    mTimestampValidBits = queueFamilyProperties[mQueueFamilyIndex].timestampValidBits;
+
+    // 생성할 큐를 정의. queueFamily마다 큐를 하나씩 만든다.
+    auto deviceQueueCreateInfos = vkQueueCreateInfos(queueFamilyIndices);
 
     uint32_t deviceExtensionCount; // 사용 가능한 deviceExtension 개수
     VK_CHECK_ERROR(vkEnumerateDeviceExtensionProperties(mPhysicalDevice,
@@ -196,28 +227,152 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
                                                         deviceExtensionProperties.data()));
 
     vector<const char *> deviceExtensionNames;
-    for (const auto &properties: deviceExtensionProperties) {
-        if (properties.extensionName == string("VK_KHR_swapchain")) {
-            deviceExtensionNames.push_back(properties.extensionName);
+    bool displayTimingSupported = false;
+    if (presentable) { // 헤드리스 모드에서는 스왑체인을 만들지 않는다.
+        for (const auto &properties: deviceExtensionProperties) {
+            if (properties.extensionName == string("VK_KHR_swapchain")) {
+                deviceExtensionNames.push_back(properties.extensionName);
+            }
+        }
+        assert(deviceExtensionNames.size() == 1); // VK_KHR_swapchain이 반드시 필요하기 때문에 확인
+
+        // 있으면 프레임이 화면에 출력된 시간을 측정하는데 사용한다.
+        for (const auto &properties: deviceExtensionProperties) {
+            if (properties.extensionName == string("VK_GOOGLE_display_timing")) {
+                deviceExtensionNames.push_back(properties.extensionName);
+                displayTimingSupported = true;
+            }
+        }
+    }
+
+    // 큐의 제출을 timeline semaphore로 동기화한다. Vulkan 1.2부터 항상 지원된다.
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+            .timelineSemaphore = VK_TRUE
+    };
+    void *featureChain = &timelineSemaphoreFeatures;
+
+    // dynamic rendering과 extended dynamic state는 Vulkan 1.3부터 코어에 포함된다.
+    // 그 전의 장치에서는 확장이 있고 기능을 지원할 때만 사용하고, 없으면 VkRenderPass와 고정 상태를 사용한다.
+    auto core13 = mPhysicalDeviceProperties.apiVersion >= VK_API_VERSION_1_3;
+    auto extensionSupported = [&deviceExtensionProperties](const char *extensionName) {
+        for (const auto &properties: deviceExtensionProperties) {
+            if (properties.extensionName == string(extensionName)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    VkPhysicalDeviceExtendedDynamicStateFeaturesEXT supportedExtendedDynamicStateFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT
+    };
+
+    VkPhysicalDeviceDynamicRenderingFeatures supportedDynamicRenderingFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES
+    };
+
+    VkPhysicalDeviceFeatures2 supportedFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2
+    };
+
+    // 확장이 없는 장치에 확장의 구조체를 넘기면 안 되므로 있는 것만 연결해서 조회한다.
+    auto dynamicRenderingExtension = !core13 && extensionSupported("VK_KHR_dynamic_rendering");
+    if (core13 || dynamicRenderingExtension) {
+        supportedDynamicRenderingFeatures.pNext = supportedFeatures.pNext;
+        supportedFeatures.pNext = &supportedDynamicRenderingFeatures;
+    }
+    auto extendedDynamicStateExtension = !core13 && extensionSupported("VK_EXT_extended_dynamic_state");
+    if (extendedDynamicStateExtension) {
+        supportedExtendedDynamicStateFeatures.pNext = supportedFeatures.pNext;
+        supportedFeatures.pNext = &supportedExtendedDynamicStateFeatures;
+    }
+    vkGetPhysicalDeviceFeatures2(mPhysicalDevice, &supportedFeatures);
+
+    // Vulkan 1.3에서 extended dynamic state는 기능 비트 없이 항상 지원된다.
+    mPipelineFeatures = {
+            .dynamicRendering = config.dynamicRendering &&
+                                supportedDynamicRenderingFeatures.dynamicRendering == VK_TRUE,
+            .extendedDynamicState = config.extendedDynamicState &&
+                                    (core13 || supportedExtendedDynamicStateFeatures.extendedDynamicState == VK_TRUE)
+    };
+
+    VkPhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES,
+            .pNext = featureChain,
+            .dynamicRendering = VK_TRUE
+    };
+    if (mPipelineFeatures.dynamicRendering) {
+        featureChain = &dynamicRenderingFeatures;
+        if (dynamicRenderingExtension) {
+            deviceExtensionNames.push_back("VK_KHR_dynamic_rendering");
         }
     }
-    assert(deviceExtensionNames.size() == 1); // VK_KHR_swapchain이 반드시 필요하기 때문에 확인
+
+    VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicStateFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT,
+            .pNext = featureChain,
+            .extendedDynamicState = VK_TRUE
+    };
+    if (mPipelineFeatures.extendedDynamicState && extendedDynamicStateExtension) {
+        featureChain = &extendedDynamicStateFeatures;
+        deviceExtensionNames.push_back("VK_EXT_extended_dynamic_state");
+    }
+
+    // 텍스처와 버퍼를 인덱스로 접근하기 위한 descriptor indexing 기능. 장치를 선택할 때 지원 여부를 확인했다.
+    auto bindlessFeatures = vkBindlessFeatures(featureChain);
 
     // 생성할 Device 정의
     VkDeviceCreateInfo deviceCreateInfo{
             .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-            .queueCreateInfoCount = 1,                   // 큐의 개수
-            .pQueueCreateInfos = &deviceQueueCreateInfo, // 생성할 큐의 정보
+            .pNext = &bindlessFeatures,
+            .queueCreateInfoCount = static_cast<uint32_t>(deviceQueueCreateInfos.size()), // 큐의 개수
+            .pQueueCreateInfos = deviceQueueCreateInfos.data(), // 생성할 큐의 정보
             .enabledExtensionCount = static_cast<uint32_t>(deviceExtensionNames.size()),
             .ppEnabledExtensionNames = deviceExtensionNames.data() // 활성화하려는 deviceExtension들을 넘겨줌
     };
 
     // vkCreateDevice를 호출하여 Device 생성(= mDevice 생성)
     VK_CHECK_ERROR(vkCreateDevice(mPhysicalDevice, &deviceCreateInfo, nullptr, &mDevice));
-    // 생성된 Device(= mDevice)로부터 큐를 vkGetDeviceQueue를 호출하여 얻어온다.
-    vkGetDeviceQueue(mDevice, mQueueFamilyIndex, 0, &mQueue);
+    // 생성된 Device(= mDevice)로부터 큐들을 얻어온다. 큐 사이의 동기화는 mDeviceQueues가 처리한다.
+    mDeviceQueues = make_unique<VkDeviceQueues>(mDevice, queueFamilyIndices);
+    mQueue = mDeviceQueues->queue(VK_QUEUE_TYPE_GRAPHICS);
+
+    aout << "Queue Families: graphics " << queueFamilyIndices.graphics
+         << ", compute " << queueFamilyIndices.compute
+         << (mDeviceQueues->dedicated(VK_QUEUE_TYPE_COMPUTE) ? " (async)" : "")
+         << ", transfer " << queueFamilyIndices.transfer
+         << (mDeviceQueues->dedicated(VK_QUEUE_TYPE_TRANSFER) ? " (dedicated)" : "") << endl;
+    aout << "Pipeline Features: dynamic rendering " << (mPipelineFeatures.dynamicRendering ? "on" : "off")
+         << ", extended dynamic state " << (mPipelineFeatures.extendedDynamicState ? "on" : "off") << endl;
+
+    // device extension의 함수는 로더가 내보내지 않으므로 직접 얻어온다.
+    if (displayTimingSupported) {
+        mGetPastPresentationTiming = reinterpret_cast<PFN_vkGetPastPresentationTimingGOOGLE>(
+                vkGetDeviceProcAddr(mDevice, "vkGetPastPresentationTimingGOOGLE"));
+        mGetRefreshCycleDuration = reinterpret_cast<PFN_vkGetRefreshCycleDurationGOOGLE>(
+                vkGetDeviceProcAddr(mDevice, "vkGetRefreshCycleDurationGOOGLE"));
+    }
+    if (mPipelineFeatures.dynamicRendering) {
+        auto beginRenderingName = core13 ? "vkCmdBeginRendering" : "vkCmdBeginRenderingKHR";
+        auto endRenderingName = core13 ? "vkCmdEndRendering" : "vkCmdEndRenderingKHR";
+        mCmdBeginRendering = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(
+                vkGetDeviceProcAddr(mDevice, beginRenderingName));
+        mCmdEndRendering = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(
+                vkGetDeviceProcAddr(mDevice, endRenderingName));
+    }
+
+    // 리소스마다 vkAllocateMemory를 호출하지 않고 큰 블록에서 나눠서 할당한다.
+    mMemoryAllocator = make_unique<VkMemoryAllocator>(mDevice,
+                                                      mPhysicalDeviceProperties,
+                                                      mPhysicalDeviceMemoryProperties);
 
+    // 실행 중에 교체되는 리소스는 바로 파괴하지 않고 사용하던 제출이 끝난 후에 파괴한다.
+    mDeletionQueue = make_unique<VkDeletionQueue>(mDevice, mDeviceQueues.get(), mMemoryAllocator.get());
+}
 
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+void VkRenderer::createSurface(ANativeWindow *window) {
     // ================================================================================
     // 5. VkSurface 생성
     // ================================================================================
@@ -226,6 +381,9 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
             .window = window
     };
 
+    // 스왑체인을 다시 만들 때 창의 크기가 필요할 수 있다.
+    mWindow = window;
+
     // surface 생성.
     VK_CHECK_ERROR(vkCreateAndroidSurfaceKHR(mInstance, &surfaceCreateInfo, nullptr, &mSurface));
 
@@ -235,8 +393,10 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
                                                         mSurface,
                                                         &supported)); // 지원 여부를 받아옴.
     assert(supported);
+}
+#endif
 
-
+void VkRenderer::createSwapchain() {
     // ================================================================================
     // 6. VkSwapchain 생성
     // ================================================================================
@@ -254,6 +414,35 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
     }
     assert(compositeAlpha != VK_COMPOSITE_ALPHA_FLAG_BITS_MAX_ENUM_KHR);
 
+    // 스왑체인 이미지의 크기는 surface의 현재 크기를 사용한다. surface가 크기를 정하지 않으면 창의 크기를 사용한다.
+    mSwapchainImageExtent = vkChooseSwapchainExtent(surfaceCapabilities, {
+            static_cast<uint32_t>(ANativeWindow_getWidth(mWindow)),
+            static_cast<uint32_t>(ANativeWindow_getHeight(mWindow))
+    });
+
+    // 화면이 회전되어 있을 때 preTransform을 currentTransform과 맞추면 합성기가 이미지를 다시 회전하지 않는다.
+    // 대신 스왑체인 이미지는 회전되지 않은 방향의 크기로 만들고 정점 셰이더에서 회전시킨다.
+    mPreTransform = surfaceCapabilities.currentTransform;
+    if (mPreTransform & (VK_SURFACE_TRANSFORM_ROTATE_90_BIT_KHR | VK_SURFACE_TRANSFORM_ROTATE_270_BIT_KHR)) {
+        swap(mSwapchainImageExtent.width, mSwapchainImageExtent.height);
+    }
+
+    // preTransform만큼 정점을 회전시키는 2x2 행렬. 열 우선.
+    switch (mPreTransform) {
+        case VK_SURFACE_TRANSFORM_ROTATE_90_BIT_KHR:
+            mPreRotation = {0.0f, 1.0f, -1.0f, 0.0f};
+            break;
+        case VK_SURFACE_TRANSFORM_ROTATE_180_BIT_KHR:
+            mPreRotation = {-1.0f, 0.0f, 0.0f, -1.0f};
+            break;
+        case VK_SURFACE_TRANSFORM_ROTATE_270_BIT_KHR:
+            mPreRotation = {0.0f, -1.0f, 1.0f, 0.0f};
+            break;
+        default:
+            mPreRotation = {1.0f, 0.0f, 0.0f, 1.0f};
+            break;
+    }
+
     VkImageUsageFlags swapchainImageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
     assert(surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
 
@@ -277,6 +466,8 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
         }
     }
     assert(surfaceFormatIndex != VK_FORMAT_MAX_ENUM);
+    mColorFormat = surfaceFormats[surfaceFormatIndex].format;
+    mColorFinalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; // 렌더링이 끝나면 화면에 출력
 
     uint32_t presentModeCount;
     VK_CHECK_ERROR(vkGetPhysicalDeviceSurfacePresentModesKHR(mPhysicalDevice,
@@ -290,32 +481,37 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
                                                              &presentModeCount,
                                                              presentModes.data()));
 
-    uint32_t presentModeIndex = VK_PRESENT_MODE_MAX_ENUM_KHR;
-    for (auto i = 0; i != presentModeCount; ++i) {
-        if (presentModes[i] == VK_PRESENT_MODE_FIFO_KHR) {
-            presentModeIndex = i;
-            break;
-        }
-    }
-    assert(presentModeIndex != VK_PRESENT_MODE_MAX_ENUM_KHR);
+    // 요청한 출력 방식을 지원하지 않으면 비슷한 방식을 사용한다. FIFO는 항상 지원된다.
+    auto presentMode = vkChoosePresentMode(mPresentConfig.presentMode, presentModes);
+    auto minImageCount = vkChooseSwapchainImageCount(mPresentConfig, presentMode, surfaceCapabilities);
 
     VkSwapchainCreateInfoKHR swapchainCreateInfo{
             .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
             .surface = mSurface,
-            .minImageCount = surfaceCapabilities.minImageCount,
+            .minImageCount = minImageCount,
             .imageFormat = surfaceFormats[surfaceFormatIndex].format,
             .imageColorSpace = surfaceFormats[surfaceFormatIndex].colorSpace,
             .imageExtent = mSwapchainImageExtent,
             .imageArrayLayers = 1,
             .imageUsage = swapchainImageUsage,
             .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
-            .preTransform = surfaceCapabilities.currentTransform,
+            .preTransform = mPreTransform,
             .compositeAlpha = compositeAlpha,
-            .presentMode = presentModes[presentModeIndex]
+            .presentMode = presentMode,
+            .clipped = VK_TRUE,
+            .oldSwapchain = mSwapchain // 다시 만드는 경우 이전 스왑체인의 자원을 넘겨받는다.
     };
 
+    auto oldSwapchain = mSwapchain;
     VK_CHECK_ERROR(vkCreateSwapchainKHR(mDevice, &swapchainCreateInfo, nullptr, &mSwapchain));
 
+    // 이전 스왑체인은 더 이상 이미지를 얻을 수 없고, 출력 중인 이미지는 드라이버가 끝까지 출력한다.
+    // 그 출력은 이전 semaphore를 기다리고 있을 수 있으므로 둘을 함께 새 스왑체인에서 이미지를 얻을 때까지 둔다.
+    if (oldSwapchain != VK_NULL_HANDLE) {
+        mRetiredSwapchains.push_back({oldSwapchain, std::move(mRenderFinishedSemaphores)});
+        mRenderFinishedSemaphores.clear();
+    }
+
     uint32_t swapchainImageCount;
     VK_CHECK_ERROR(vkGetSwapchainImagesKHR(mDevice, mSwapchain, &swapchainImageCount, nullptr));
 
@@ -325,6 +521,24 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
                                            &swapchainImageCount,
                                            mSwapchainImages.data()));
 
+    // 출력은 이미지를 다시 얻을 때까지 semaphore를 기다리고 있을 수 있다. 프레임 슬롯마다 semaphore를 두면
+    // 이미지가 frames-in-flight보다 많을 때 출력이 기다리는 semaphore를 다른 프레임이 다시 Signal 할 수 있으므로
+    // 이미지마다 두고, 그 이미지를 다시 얻은 프레임만 Signal 한다.
+    VkSemaphoreCreateInfo semaphoreCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
+    };
+
+    mRenderFinishedSemaphores.resize(swapchainImageCount);
+    for (auto &semaphore : mRenderFinishedSemaphores) {
+        VK_CHECK_ERROR(vkCreateSemaphore(mDevice, &semaphoreCreateInfo, nullptr, &semaphore));
+    }
+
+    mPresentStats.presentMode = presentMode;
+    mPresentStats.imageCount = swapchainImageCount;
+
+    aout << "Swapchain: " << vkToString(presentMode) << ", " << swapchainImageCount << " images"
+         << (mPresentConfig.lowLatency ? ", low latency" : "") << endl;
+
 
     mSwapchainImageViews.resize(swapchainImageCount); // ImageView를 Swapchain의 개수만큼 생성
     for (auto i = 0; i != swapchainImageCount; ++i) {
@@ -356,62 +570,77 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
                                          nullptr,
                                          &mSwapchainImageViews[i])); // mSwapchainImageViews[i] 생성
     }
+}
 
-    // ================================================================================
-    // 8. VkCommandPool 생성
-    // ================================================================================
-    VkCommandPoolCreateInfo commandPoolCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |           // command buffer가 자주 변경될 것임을 알려줌
-                     VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, // command buffer를 개별적으로 초기화 가능하게 설정
-            .queueFamilyIndex = mQueueFamilyIndex
-    };
-
-    VK_CHECK_ERROR(vkCreateCommandPool(mDevice, &commandPoolCreateInfo, nullptr, &mCommandPool)); // mCommandPool 생성
-
-    // ================================================================================
-    // 9. VkCommandBuffer 할당
-    // ================================================================================
-    VkCommandBufferAllocateInfo commandBufferAllocateInfo{ // 할당하려는 command buffer 정의
-            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-            .commandPool = mCommandPool,
-            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-            .commandBufferCount = 1
-    };
-
-    VK_CHECK_ERROR(vkAllocateCommandBuffers(mDevice, &commandBufferAllocateInfo, &mCommandBuffer));
-
-
-    // ================================================================================
-    // 10. VkFence 생성
-    // ================================================================================
-    VkFenceCreateInfo fenceCreateInfo{
-        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO
-    }; // 생성할 Fence의 정보를 해당 구조체에서 정의
-
-    VK_CHECK_ERROR(vkCreateFence(mDevice, &fenceCreateInfo, nullptr, &mFence)); // mFence 생성. flag에 아무것도 넣어주지 않았기 때문에 생성된 Fence의 초기 상태는 Unsignal 상태다.
+void VkRenderer::createOffscreenImages(VkExtent2D extent, uint32_t imageCount) {
+    // ================================================================================
+    // 6. 오프스크린 VkImage 생성
+    // ================================================================================
+    // 스왑체인 이미지 대신 렌더링 결과가 쓰여질 이미지를 프레임 슬롯 개수만큼 만든다.
+    // 프레임 슬롯과 이미지가 1:1로 대응되므로 슬롯의 제출만 기다리면 이미지를 안전하게 다시 쓸 수 있다.
+    mSwapchainImageExtent = extent;
+    mColorFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    mColorFinalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL; // 렌더링이 끝나면 읽어갈 수 있도록 설정
+
+    mSwapchainImages.resize(imageCount);
+    mOffscreenAllocations.resize(imageCount);
+    mSwapchainImageViews.resize(imageCount);
+    for (auto i = 0; i != imageCount; ++i) {
+        VkImageCreateInfo imageCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                .imageType = VK_IMAGE_TYPE_2D,
+                .format = mColorFormat,
+                .extent = {extent.width, extent.height, 1},
+                .mipLevels = 1,
+                .arrayLayers = 1,
+                .samples = VK_SAMPLE_COUNT_1_BIT,
+                .tiling = VK_IMAGE_TILING_OPTIMAL,
+                .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+        };
 
+        VkAllocationCreateInfo allocationCreateInfo{
+                .memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        };
 
-    // ================================================================================
-    // 11. VkSemaphore 생성
-    // ================================================================================
-    VkSemaphoreCreateInfo semaphoreCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-    };
+        VK_CHECK_ERROR(mMemoryAllocator->createImage(imageCreateInfo,
+                                                     allocationCreateInfo,
+                                                     &mSwapchainImages[i],
+                                                     &mOffscreenAllocations[i]));
 
-    VK_CHECK_ERROR(vkCreateSemaphore(mDevice, &semaphoreCreateInfo, nullptr, &mSemaphore));
+        // ================================================================================
+        // 7. VkImageView 생성
+        // ================================================================================
+        VkImageViewCreateInfo imageViewCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+                .image = mSwapchainImages[i],
+                .viewType = VK_IMAGE_VIEW_TYPE_2D,
+                .format = mColorFormat,
+                .subresourceRange = {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .baseMipLevel = 0,
+                        .levelCount = 1,
+                        .baseArrayLayer = 0,
+                        .layerCount = 1
+                }
+        };
 
+        VK_CHECK_ERROR(vkCreateImageView(mDevice,
+                                         &imageViewCreateInfo,
+                                         nullptr,
+                                         &mSwapchainImageViews[i]));
+    }
+}
 
-    // ================================================================================
-    // 12. VkRenderPass 생성
-    // ================================================================================
+void VkRenderer::createRenderPass() {
     VkAttachmentDescription attachmentDescription{
-            .format = surfaceFormats[surfaceFormatIndex].format,
+            .format = mColorFormat,
             .samples = VK_SAMPLE_COUNT_1_BIT,
             .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
             .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
             .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-            .finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+            .finalLayout = mColorFinalLayout
     };
 
     VkAttachmentReference attachmentReference{
@@ -425,21 +654,37 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
             .pColorAttachments = &attachmentReference
     };
 
+    // 스왑체인 이미지를 얻기 전에 레이아웃 변환이 일어나지 않도록
+    // acquireSemaphore를 기다리는 단계(COLOR_ATTACHMENT_OUTPUT)와 맞춰준다.
+    VkSubpassDependency subpassDependency{
+            .srcSubpass = VK_SUBPASS_EXTERNAL,
+            .dstSubpass = 0,
+            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+    };
+
     VkRenderPassCreateInfo renderPassCreateInfo{
             .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
             .attachmentCount = 1,
             .pAttachments = &attachmentDescription,
             .subpassCount = 1,
-            .pSubpasses = &subpassDescription
+            .pSubpasses = &subpassDescription,
+            .dependencyCount = 1,
+            .pDependencies = &subpassDependency
     };
 
     VK_CHECK_ERROR(vkCreateRenderPass(mDevice, &renderPassCreateInfo, nullptr, &mRenderPass)); // mRenderPass 생성.
+}
 
-    mFramebuffers.resize(swapchainImageCount);
-    for (auto i = 0; i != swapchainImageCount; ++i) {
-        // ================================================================================
-        // 13. VkFramebuffer 생성
-        // ================================================================================
+void VkRenderer::createFramebuffers() {
+    if (mRenderPass == VK_NULL_HANDLE) {
+        return;
+    }
+
+    mFramebuffers.resize(mSwapchainImageViews.size());
+    for (auto i = 0; i != mFramebuffers.size(); ++i) {
         VkFramebufferCreateInfo framebufferCreateInfo{
                 .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
                 .renderPass = mRenderPass,
@@ -452,100 +697,153 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
 
         VK_CHECK_ERROR(vkCreateFramebuffer(mDevice, &framebufferCreateInfo, nullptr, &mFramebuffers[i]));// mFramebuffers[i] 생성
     }
+}
 
+void VkRenderer::createRenderResources(const VkRendererConfig &config) {
+    // 셰이더, 파이프라인 생성과 프레임 기록을 작업으로 나눠서 실행한다.
+    mJobSystem = make_unique<VkJobSystem>(config.jobThreadCount);
+    aout << "Job Threads: " << mJobSystem->threadCount() << endl;
 
     // ================================================================================
-    // 14. Vertex VkShaderModule 생성
+    // 8. VkCommandPool 생성
     // ================================================================================
-    string_view vertexShaderCode = {
-            "#version 310 es                                        \n"
-            "                                                       \n"
-            "layout(location = 0) in vec3 inPosition;               \n"
-            "layout(location = 1) in vec3 inColor;                  \n"
-            "                                                       \n"
-            "layout(location = 0) out vec3 outColor;                \n"
-            "                                                       \n"
-            "void main() {                                          \n"
-            "    gl_Position = vec4(inPosition, 1.0);               \n"
-            "    outColor = inColor;                                \n"
-            "}                                                      \n"
+    // 프레임 밖에서 한 번만 기록하는 command buffer에 사용한다. 프레임의 command buffer는 프레임 슬롯마다 따로 둔다.
+    VkCommandPoolCreateInfo commandPoolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, // command buffer가 자주 변경될 것임을 알려줌
+            .queueFamilyIndex = mQueueFamilyIndex
     };
 
-    std::vector<uint32_t> vertexShaderBinary;
-    // VKSL을 SPIR-V로 변환.
-    VK_CHECK_ERROR(vkCompileShader(vertexShaderCode,
-                                   VK_SHADER_TYPE_VERTEX,
-                                   &vertexShaderBinary));
+    VK_CHECK_ERROR(vkCreateCommandPool(mDevice, &commandPoolCreateInfo, nullptr, &mCommandPool)); // mCommandPool 생성
 
-    VkShaderModuleCreateInfo vertexShaderModuleCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-            .codeSize = vertexShaderBinary.size() * sizeof(uint32_t), // 바이트 단위.
-            .pCode = vertexShaderBinary.data()
-    };
+    // ================================================================================
+    // 9. 프레임 링 생성
+    // ================================================================================
+    // 프레임마다 VkCommandPool, VkSemaphore, 제출의 ticket을 따로 두어서
+    // GPU가 이전 프레임을 처리하는 동안 CPU가 다음 프레임을 기록할 수 있게 한다.
+    mFrameRing = make_unique<VkFrameRing>(mDevice, mDeviceQueues.get(), mQueueFamilyIndex, config.maxFramesInFlight);
+
+    // 그리기를 여러 스레드에서 secondary command buffer에 나눠서 기록한다.
+    // 스레드마다 프레임 슬롯별 VkCommandPool을 두므로 스레드 사이에 동기화 없이 기록할 수 있다.
+    if (mJobSystem->threadCount() > 1) {
+        mCommandRecorder = make_unique<VkCommandRecorder>(mDevice,
+                                                          mJobSystem.get(),
+                                                          mQueueFamilyIndex,
+                                                          config.maxFramesInFlight);
+    }
+    mMaxInstancesPerDraw = max(config.maxInstancesPerDraw, 1u);
+
+    // 프레임마다 바뀌는 상수는 프레임 슬롯별 구간에 선형으로 할당하고 dynamic offset으로 넘긴다.
+    mFrameAllocator = make_unique<VkFrameAllocator>(mDevice,
+                                                    mPhysicalDeviceProperties,
+                                                    mMemoryAllocator.get(),
+                                                    config.maxFramesInFlight,
+                                                    config.frameAllocatorSize);
 
-    VK_CHECK_ERROR(vkCreateShaderModule(mDevice,
-                                        &vertexShaderModuleCreateInfo,
-                                        nullptr,
-                                        &mVertexShaderModule)); // mVertexShaderModule 생성.
+    // 프레임 슬롯마다 타임스탬프 쿼리를 두어서 결과를 기다리지 않고 슬롯을 다시 사용할 때 읽는다.
+    mGpuProfiler = make_unique<VkGpuProfiler>(mDevice,
+                                              mPhysicalDeviceProperties,
+                                              mTimestampValidBits,
+                                              config.maxFramesInFlight);
+    mTracePath = config.tracePath;
 
     // ================================================================================
-    // 15. Fragment VkShaderModule 생성
+    // 10. VkRenderPass 생성
     // ================================================================================
-    string_view fragmentShaderCode = {
-            "#version 310 es                                        \n"
-            "precision mediump float;                               \n"
-            "                                                       \n"
-            "layout(location = 0) in vec3 inColor;                  \n"
-            "                                                       \n"
-            "layout(location = 0) out vec4 outColor;                \n"
-            "                                                       \n"
-            "void main() {                                          \n"
-            "    outColor = vec4(inColor, 1.0);                     \n"
-            "}                                                      \n"
-    };
+    // dynamic rendering을 사용하면 이미지 뷰에 직접 렌더링하므로 VkRenderPass와 VkFramebuffer를 만들지 않는다.
+    // 레이아웃 변환은 recordCommandBuffer에서 배리어로 기록한다.
+    if (!mPipelineFeatures.dynamicRendering) {
+        createRenderPass();
+    }
+
+    // ================================================================================
+    // 11. VkFramebuffer 생성
+    // ================================================================================
+    createFramebuffers();
 
-    std::vector<uint32_t> fragmentShaderBinary;
-    VK_CHECK_ERROR(vkCompileShader(fragmentShaderCode,
-                                   VK_SHADER_TYPE_FRAGMENT,
-                                   &fragmentShaderBinary));
+    // ================================================================================
+    // 12. 셰이더와 파이프라인을 만들 준비
+    // ================================================================================
+    // 이전 실행에서 저장된 캐시가 있으면 드라이버가 컴파일 결과를 재사용한다.
+    // 파이프라인을 만드는 스레드는 각자 워커 캐시를 사용하고, 저장할 때 워커 캐시가 모두 합쳐진다.
+    mPipelineCacheStore = make_unique<VkPipelineCacheStore>(mDevice,
+                                                            mPhysicalDeviceProperties,
+                                                            config.pipelineCachePath);
 
-    VkShaderModuleCreateInfo fragmentShaderModuleCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-            .codeSize = fragmentShaderBinary.size() * sizeof(uint32_t),
-            .pCode = fragmentShaderBinary.data()
-    };
+    // 셰이더 컴파일과 파이프라인 생성을 작업 시스템의 스레드에 나눠서 실행한다.
+    VkPipelineBuilder pipelineBuilder(mDevice, mJobSystem.get(), mPipelineCacheStore.get());
 
-    VK_CHECK_ERROR(vkCreateShaderModule(mDevice,
-                                        &fragmentShaderModuleCreateInfo,
-                                        nullptr,
-                                        &mFragmentShaderModule));
+#ifdef VK_RUNTIME_SHADER_COMPILE
+    // 개발 모드에서는 셰이더를 실행 중에 컴파일한다.
+    // 이전에 컴파일한 적이 있는 셰이더는 shaderc를 거치지 않고 캐시에서 가져온다.
+    mShaderCache = make_unique<VkShaderCache>(config.shaderCacheDirectory);
+#endif
 
     // ================================================================================
-    // 16. VkDescriptorSetLayout 생성
+    // 13. Vertex, Fragment 셰이더 추가
     // ================================================================================
-    VkDescriptorSetLayoutBinding descriptorSetLayoutBinding{
-            .binding = 0,
-            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = 1,
-            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT
-    };
+    // 그리기 데이터를 uniform buffer로 넘기면 push constant 대신 set 2에서 읽는 변형을 사용한다.
+    mDrawDataPath = config.drawDataPath;
+    auto drawDataUniformBuffer = mDrawDataPath == VK_DRAW_DATA_PATH_UNIFORM_BUFFER;
+    auto vertexShaderName = drawDataUniformBuffer ? "triangle.ubo.vert" : "triangle.vert";
+    auto vertexShader = pipelineBuilder.addShader(vertexShaderName, [this, drawDataUniformBuffer] {
+#ifdef VK_RUNTIME_SHADER_COMPILE
+        // VKSL을 SPIR-V로 변환.
+        VkShaderCompileOptions shaderCompileOptions;
+        if (drawDataUniformBuffer) {
+            shaderCompileOptions.macroDefinitions.emplace_back("DRAW_DATA_UNIFORM_BUFFER", "");
+        }
 
-    VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-            .bindingCount = 1,
-            .pBindings = &descriptorSetLayoutBinding
-    };
+        vector<uint32_t> binary;
+        VK_CHECK_ERROR(mShaderCache->compile(kTriangleVertShader, VK_SHADER_TYPE_VERTEX, shaderCompileOptions, &binary));
+        return binary;
+#else
+        // 빌드할 때 SPIR-V로 컴파일되고 최적화된 셰이더를 사용한다.
+        if (drawDataUniformBuffer) {
+            return vector<uint32_t>(begin(kTriangleVertUboShader), end(kTriangleVertUboShader));
+        }
+        return vector<uint32_t>(begin(kTriangleVertShader), end(kTriangleVertShader));
+#endif
+    });
 
-    VK_CHECK_ERROR(vkCreateDescriptorSetLayout(mDevice,
-                                               &descriptorSetLayoutCreateInfo,
-                                               nullptr,
-                                               &mDescriptorSetLayout)); // mDescriptorSetLayout 생성
+    auto fragmentShader = pipelineBuilder.addShader("triangle.frag", [this] {
+#ifdef VK_RUNTIME_SHADER_COMPILE
+        vector<uint32_t> binary;
+        VK_CHECK_ERROR(mShaderCache->compile(kTriangleFragShader, VK_SHADER_TYPE_FRAGMENT, {}, &binary));
+        return binary;
+#else
+        return vector<uint32_t>(begin(kTriangleFragShader), end(kTriangleFragShader));
+#endif
+    });
 
     // ================================================================================
-    // 17. VkPipelineLayout 생성
+    // 14. Bindless VkDescriptorSet 생성
+    // ================================================================================
+    // 모든 파이프라인이 같은 VkDescriptorSetLayout을 set 0으로 사용하고, 리소스는 인덱스로 구분한다.
+    mBindlessHeap = make_unique<VkBindlessHeap>(mDevice, mPhysicalDevice, mDeletionQueue.get());
+
     // ================================================================================
+    // 15. VkPipelineLayout 생성
+    // ================================================================================
+    // 그리기마다 바뀌는 작은 데이터는 push constant로 넘긴다.
+    mDrawConstants.emplace(mPhysicalDeviceProperties.limits, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+    auto pushConstantRange = mDrawConstants->range();
+
+    // set 0은 bindless 리소스, set 1은 프레임 상수, set 2는 그리기 데이터다.
+    // set 1과 set 2는 같은 프레임 할당기의 VkDescriptorSet을 서로 다른 dynamic offset으로 바인드한다.
+    // 그리기 데이터의 offset을 바꿔도 프레임 상수의 바인드는 유지된다.
+    array<VkDescriptorSetLayout, 3> descriptorSetLayouts{
+            mBindlessHeap->layout(),
+            mFrameAllocator->layout(),
+            mFrameAllocator->layout()
+    };
+
     VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size()),
+            .pSetLayouts = descriptorSetLayouts.data(),
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges = &pushConstantRange
     };
 
     VK_CHECK_ERROR(vkCreatePipelineLayout(mDevice,
@@ -554,30 +852,30 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
                                           &mPipelineLayout));
 
     // ================================================================================
-    // 18. Graphics VkPipeline 생성
+    // 16. Graphics VkPipeline 생성
     // ================================================================================
-    array<VkPipelineShaderStageCreateInfo, 2> pipelineShaderStageCreateInfos{
-            VkPipelineShaderStageCreateInfo{
-                    .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-                    .stage = VK_SHADER_STAGE_VERTEX_BIT,
-                    .module = mVertexShaderModule,
-                    .pName = "main"
+    // 파이프라인은 상태를 키로 해서 관리한다. 실행 중에 처음 보는 상태가 요청되면 백그라운드에서 만든다.
+    // extended dynamic state를 사용하면 동적 상태만 다른 키는 같은 파이프라인을 사용한다.
+    mPipelineManager = make_unique<VkPipelineManager>(mDevice,
+                                                      mPipelineLayout,
+                                                      mPipelineCacheStore->createWorkerCache(),
+                                                      mPipelineFeatures);
+
+    // binding 0은 정점마다, binding 1은 인스턴스마다 데이터를 읽는다.
+    vector<VkVertexInputBindingDescription> vertexInputBindingDescriptions{
+            VkVertexInputBindingDescription{
+                    .binding = 0,
+                    .stride = sizeof(Vertex),
+                    .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
             },
-            VkPipelineShaderStageCreateInfo{
-                    .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-                    .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-                    .module = mFragmentShaderModule,
-                    .pName = "main"
+            VkVertexInputBindingDescription{
+                    .binding = 1,
+                    .stride = sizeof(MeshInstance),
+                    .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE
             }
     };
 
-    VkVertexInputBindingDescription vertexInputBindingDescription{
-            .binding = 0,
-            .stride = sizeof(Vertex),
-            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
-    };
-
-    array<VkVertexInputAttributeDescription, 2> vertexInputAttributeDescriptions{
+    vector<VkVertexInputAttributeDescription> vertexInputAttributeDescriptions{
             VkVertexInputAttributeDescription{
                     .location = 0,
                     .binding = 0,
@@ -589,329 +887,1003 @@ VkRenderer::VkRenderer(ANativeWindow *window) {
                     .binding = 0,
                     .format = VK_FORMAT_R32G32B32_SFLOAT,
                     .offset = offsetof(Vertex, color)
+            },
+            VkVertexInputAttributeDescription{
+                    .location = 2,
+                    .binding = 1,
+                    .format = VK_FORMAT_R32G32B32_SFLOAT,
+                    .offset = offsetof(MeshInstance, offset)
+            },
+            VkVertexInputAttributeDescription{
+                    .location = 3,
+                    .binding = 1,
+                    .format = VK_FORMAT_R32_SFLOAT,
+                    .offset = offsetof(MeshInstance, scale)
             }
     };
 
-    VkPipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-            .vertexBindingDescriptionCount = 1,
-            .pVertexBindingDescriptions = &vertexInputBindingDescription,
-            .vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexInputAttributeDescriptions.size()),
-            .pVertexAttributeDescriptions = vertexInputAttributeDescriptions.data()
-    };
+    mVertexLayout = mPipelineManager->addVertexLayout(std::move(vertexInputBindingDescriptions),
+                                                      std::move(vertexInputAttributeDescriptions));
+
+    // 기본 상태의 파이프라인은 시작할 때 만들고, 다른 상태가 만들어지는 동안 fallback으로 사용한다.
+    // 셰이더가 준비되는 대로 파이프라인을 만든다. 재질이 늘어나도 파이프라인마다 다른 스레드에서 만들어진다.
+    auto pipeline = pipelineBuilder.addPipeline("triangle",
+                                                {vertexShader, fragmentShader},
+                                                [this](const vector<VkShaderModule> &shaderModules,
+                                                       VkPipelineCache pipelineCache,
+                                                       VkPipeline *pipeline) {
+        auto pipelineKey = makePipelineKey(shaderModules[0], shaderModules[1], mPipelineState);
+        return mPipelineManager->createPipeline(pipelineKey, pipelineCache, pipeline);
+    });
+
+    pipelineBuilder.build();
+
+    mVertexShaderModule = pipelineBuilder.shaderModule(vertexShader);
+    mFragmentShaderModule = pipelineBuilder.shaderModule(fragmentShader);
+
+    auto fallbackPipelineKey = makePipelineKey(mVertexShaderModule, mFragmentShaderModule, mPipelineState);
+    mPipelineManager->insert(fallbackPipelineKey, pipelineBuilder.pipeline(pipeline));
+    mPipelineManager->setFallback(fallbackPipelineKey);
+
+    mPipelineCreationTime = pipelineBuilder.serialTime(true);
+
+#ifdef VK_RUNTIME_SHADER_COMPILE
+    auto shaderCacheStats = mShaderCache->stats();
+    aout << "Shader Cache: " << shaderCacheStats.memoryHits << " memory hits, "
+         << shaderCacheStats.diskHits << " disk hits, "
+         << shaderCacheStats.misses << " misses, "
+         << chrono::duration<double, milli>(shaderCacheStats.compileTime).count()
+         << " ms compiling" << endl;
+#endif
+
+    aout << "Pipeline Creation: "
+         << chrono::duration<double, milli>(mPipelineCreationTime).count() << " ms ("
+         << (mPipelineCacheStore->isWarm() ? "warm" : "cold") << " cache)" << endl;
+
+    // 스레드 수만큼 빨라졌는지 확인할 수 있도록 걸린 시간과 한 스레드에서 순서대로 만들었을 때의 시간을 비교한다.
+    mStartupTimeline = pipelineBuilder.timeline();
+    aout << "Pipeline Build: "
+         << chrono::duration<double, milli>(pipelineBuilder.buildTime()).count() << " ms elapsed, "
+         << chrono::duration<double, milli>(pipelineBuilder.serialTime(false) +
+                                            pipelineBuilder.serialTime(true)).count() << " ms serial ("
+         << mJobSystem->threadCount() << " threads)" << endl;
+    pipelineBuilder.logTimeline();
+
+    // ================================================================================
+    // 17. 업로드 큐 생성
+    // ================================================================================
+    mUploadQueue = make_unique<VkUploadQueue>(mDevice,
+                                              mMemoryAllocator.get(),
+                                              mDeviceQueues.get());
+
+    // ================================================================================
+    // 18. 삼각형 메시 생성
+    // ================================================================================
+    setMesh({
+            .vertices{
+                    Vertex{
+                            .position{0.0, -0.5, 0.0},
+                            .color{1.0, 0.0, 0.0}
+                    },
+                    Vertex{
+                            .position{0.5, 0.5, 0.0},
+                            .color{0.0, 1.0, 0.0}
+                    },
+                    Vertex{
+                            .position{-0.5, 0.5, 0.0},
+                            .color{0.0, 0.0, 1.0}
+                    }
+            },
+            .indices{0, 1, 2}
+    });
 
-    VkPipelineInputAssemblyStateCreateInfo pipelineInputAssemblyStateCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-            .topology =VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
-    };
+    // ================================================================================
+    // 19. 인스턴스 VkBuffer 생성
+    // ================================================================================
+    setInstances({
+            MeshInstance{
+                    .offset{0.0, 0.0, 0.0},
+                    .scale = 1.0
+            }
+    });
 
-    VkViewport viewport{
-            .width = static_cast<float>(mSwapchainImageExtent.width),
-            .height = static_cast<float>(mSwapchainImageExtent.height),
-            .maxDepth = 1.0f
-    };
+    // ================================================================================
+    // 20. 기본 텍스처 생성
+    // ================================================================================
+    // 텍스처를 지정하지 않은 그리기도 bindless 배열에서 읽을 수 있도록 정점 색상을 바꾸지 않는 흰색 텍스처를 등록한다.
+    const array<uint8_t, 4> white{255, 255, 255, 255};
+    mDefaultMaterialIndex = createTexture(1, 1, white.data());
+    mMaterialIndex = mDefaultMaterialIndex;
+}
 
-    VkRect2D scissor{
-            .extent = mSwapchainImageExtent
+VkPipelineKey VkRenderer::makePipelineKey(VkShaderModule vertexShader,
+                                          VkShaderModule fragmentShader,
+                                          const VkPipelineState &state) const {
+    return {
+            .vertexShader = vertexShader,
+            .fragmentShader = fragmentShader,
+            .renderPass = mRenderPass,
+            .subpass = 0,
+            .colorFormat = mColorFormat,
+            .vertexLayout = mVertexLayout,
+            .state = state
     };
+}
 
-    VkPipelineViewportStateCreateInfo pipelineViewportStateCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-            .viewportCount = 1,
-            .pViewports = &viewport,
-            .scissorCount = 1,
-            .pScissors = &scissor
-    };
+VkRenderer::~VkRenderer() {
+    // 아직 GPU에서 처리중인 프레임이 있을 수 있으므로 모두 끝날 때까지 기다린다.
+    mDeviceQueues->waitIdle();
+    mDeletionQueue->flush();
 
-    VkPipelineRasterizationStateCreateInfo pipelineRasterizationStateCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-            .polygonMode = VK_POLYGON_MODE_FILL,
-            .cullMode = VK_CULL_MODE_NONE,
-            .lineWidth = 1.0f
-    };
+    for (auto &texture : mTextures) {
+        vkDestroyImageView(mDevice, texture.imageView, nullptr);
+        mMemoryAllocator->destroyImage(texture.image, &texture.allocation);
+    }
+    mTextures.clear();
+    mBindlessHeap.reset();
+    mFrameAllocator.reset();
+    mMemoryAllocator->destroyBuffer(mInstanceBuffer, &mInstanceAllocation);
+    mMesh.reset();
+    mUploadQueue.reset();
+    mPipelineManager.reset(); // 백그라운드에서 만들고 있는 파이프라인이 끝날 때까지 기다린다.
+    vkDestroyPipelineLayout(mDevice, mPipelineLayout, nullptr);
+    mPipelineCacheStore.reset(); // 파이프라인 캐시를 파일에 저장한다.
+    vkDestroyShaderModule(mDevice, mVertexShaderModule, nullptr);
+    vkDestroyShaderModule(mDevice, mFragmentShaderModule, nullptr);
+    for (auto framebuffer : mFramebuffers) {
+        vkDestroyFramebuffer(mDevice, framebuffer, nullptr);
+    }
+    mFramebuffers.clear();
+    vkDestroyRenderPass(mDevice, mRenderPass, nullptr);
+    for (auto imageView : mSwapchainImageViews) {
+        vkDestroyImageView(mDevice, imageView, nullptr);
+    }
+    mSwapchainImageViews.clear();
+    if (!mTracePath.empty()) {
+        writeTrace(mTracePath);
+    }
+    mGpuProfiler.reset();
+    mCommandRecorder.reset();
+    mJobSystem.reset();
+    mFrameRing.reset();
+    vkDestroyCommandPool(mDevice, mCommandPool, nullptr);
+    for (auto &retiredSwapchain : mRetiredSwapchains) {
+        for (auto semaphore : retiredSwapchain.renderFinishedSemaphores) {
+            vkDestroySemaphore(mDevice, semaphore, nullptr);
+        }
+        vkDestroySwapchainKHR(mDevice, retiredSwapchain.swapchain, nullptr);
+    }
+    mRetiredSwapchains.clear();
+    for (auto semaphore : mRenderFinishedSemaphores) {
+        vkDestroySemaphore(mDevice, semaphore, nullptr);
+    }
+    mRenderFinishedSemaphores.clear();
+    if (mSwapchain != VK_NULL_HANDLE) {
+        vkDestroySwapchainKHR(mDevice, mSwapchain, nullptr);
+        vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
+    } else { // 헤드리스 모드에서는 오프스크린 이미지를 직접 파괴한다.
+        for (auto i = 0; i != mSwapchainImages.size(); ++i) {
+            mMemoryAllocator->destroyImage(mSwapchainImages[i], &mOffscreenAllocations[i]);
+        }
+    }
+    mSwapchainImages.clear();
+    mOffscreenAllocations.clear();
+    mDeletionQueue.reset();
+    mDeviceQueues.reset();
+    mMemoryAllocator.reset();
+    vkDestroyDevice(mDevice, nullptr); // Device 파괴. queue의 경우 Device를 생성하면서 생겼기 때문에 따로 파괴하는 API가 존재하지 않는다.
+    vkDestroyInstance(mInstance, nullptr);
+}
 
-    VkPipelineMultisampleStateCreateInfo pipelineMultisampleStateCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
-    };
+void VkRenderer::render() {
+    VK_TRACE_SCOPE("Render");
 
-    VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilStateCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO
-    };
+    // 창의 크기나 방향이 바뀌었으면 스왑체인을 다시 만든다. 창이 최소화되어 크기가 0이면 그리지 않는다.
+    if (mSwapchainOutOfDate && !recreateSwapchain()) {
+        return;
+    }
 
-    VkPipelineColorBlendAttachmentState pipelineColorBlendAttachmentState{
-            .colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
-                              VK_COLOR_COMPONENT_G_BIT |
-                              VK_COLOR_COMPONENT_B_BIT |
-                              VK_COLOR_COMPONENT_A_BIT
-    };
+    // 지연을 줄이는 모드에서는 이전 프레임이 끝난 후에 시작해서 입력을 최대한 늦게 읽는다.
+    if (mPresentConfig.lowLatency && !isHeadless()) {
+        VK_TRACE_SCOPE("WaitPreviousFrame");
+        mFrameRing->waitIdle();
+    }
+    auto frameStartTime = vkTraceNow();
 
-    VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-            .attachmentCount = 1,
-            .pAttachments = &pipelineColorBlendAttachmentState
-    };
-
-    VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-            .stageCount = pipelineShaderStageCreateInfos.size(),
-            .pStages = pipelineShaderStageCreateInfos.data(),
-            .pVertexInputState = &pipelineVertexInputStateCreateInfo,
-            .pInputAssemblyState = &pipelineInputAssemblyStateCreateInfo,
-            .pViewportState = &pipelineViewportStateCreateInfo,
-            .pRasterizationState = &pipelineRasterizationStateCreateInfo,
-            .pMultisampleState = &pipelineMultisampleStateCreateInfo,
-            .pDepthStencilState = &pipelineDepthStencilStateCreateInfo,
-            .pColorBlendState = &pipelineColorBlendStateCreateInfo,
-            .layout = mPipelineLayout,
-            .renderPass = mRenderPass
-    };
-
-    VK_CHECK_ERROR(vkCreateGraphicsPipelines(mDevice,
-                                             VK_NULL_HANDLE,
-                                             1,
-                                             &graphicsPipelineCreateInfo,
-                                             nullptr,
-                                             &mPipeline));
-
-    // ================================================================================
-    // 19. Vertex VkBuffer 생성
-    // ================================================================================
-    constexpr array<Vertex, 3> vertices{
-            Vertex{
-                    .position{0.0, -0.5, 0.0},
-                    .color{1.0, 0.0, 0.0}
-            },
-            Vertex{
-                    .position{0.5, 0.5, 0.0},
-                    .color{0.0, 1.0, 0.0}
-            },
-            Vertex{
-                    .position{-0.5, 0.5, 0.0},
-                    .color{0.0, 0.0, 1.0}
-            },
-    };
-    constexpr VkDeviceSize vertexDataSize{vertices.size() * sizeof(Vertex)};
+    // ================================================================================
+    // 1. 사용 가능한 프레임 슬롯 얻기
+    // ================================================================================
+    // 이 슬롯을 사용했던 이전 프레임의 실행이 끝날 때까지만 기다린다.
+    // 나머지 슬롯의 프레임은 GPU에서 계속 처리되므로 CPU와 GPU가 동시에 일할 수 있다.
+    auto &frame = mFrameRing->beginFrame();
+    auto commandBuffer = frame.commandBuffer;
+    if (mCommandRecorder) {
+        mCommandRecorder->beginFrame(mFrameRing->frameIndex());
+    }
+    mFrameAllocator->beginFrame(mFrameRing->frameIndex());
+
+    // 이전 프레임에서 공간이 부족했으면 빠진 그리기가 있으므로 알린다.
+    // 부족한 상태가 이어질 때 매 프레임 출력하지 않도록 최대값이 갱신될 때만 출력한다.
+    auto frameAllocatorStats = mFrameAllocator->stats();
+    if (frameAllocatorStats.highWaterMark > frameAllocatorStats.frameSize &&
+        frameAllocatorStats.highWaterMark > mReportedFrameAllocatorHighWaterMark) {
+        mReportedFrameAllocatorHighWaterMark = frameAllocatorStats.highWaterMark;
+        aout << "Frame Allocator: out of space, " << frameAllocatorStats.highWaterMark << " / "
+             << frameAllocatorStats.frameSize << " bytes requested, "
+             << frameAllocatorStats.overflowCount << " allocations failed" << endl;
+    }
+
+    // 실행이 끝난 제출에서 사용하던 리소스를 파괴한다.
+    mDeletionQueue->collect();
+
+    // ================================================================================
+    // 2. 화면에 출력할 수 있는 VkImage 얻기
+    // ================================================================================
+    uint32_t swapchainImageIndex;
+    if (isHeadless()) {
+        // 오프스크린 이미지는 프레임 슬롯과 1:1로 대응되므로 기다릴 필요가 없다.
+        swapchainImageIndex = mFrameRing->frameIndex();
+    } else {
+        VK_TRACE_SCOPE("Acquire");
+
+        auto result = vkAcquireNextImageKHR(mDevice,
+                                            mSwapchain,
+                                            UINT64_MAX,
+                                            frame.acquireSemaphore, // 이미지를 사용할 수 있을 때 Signal
+                                            VK_NULL_HANDLE,
+                                            &swapchainImageIndex); // 사용 가능한 이미지 변수에 담기
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            // 이미지를 얻지 못했으므로 acquireSemaphore도 Signal 되지 않는다. 이번 프레임은 건너뛴다.
+            mSwapchainOutOfDate = true;
+            return;
+        } else if (result == VK_SUBOPTIMAL_KHR) {
+            // 이미지는 얻었으므로 이번 프레임은 출력하고 다음 프레임에서 다시 만든다.
+            mSwapchainOutOfDate = true;
+        } else {
+            VK_CHECK_ERROR(result);
+        }
 
-    VkBufferCreateInfo vertexBufferCreateInfo{
-            .sType =VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-            .size = vertexDataSize,
-            .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+        // 새 스왑체인에서 이미지를 얻었으면 이전 스왑체인의 출력은 모두 큐에 들어간 것이다.
+        // 이전 이미지에 그리던 프레임이 남아있을 수 있으므로 지금까지 제출된 작업이 끝난 후에 파괴한다.
+        for (auto &retiredSwapchain : mRetiredSwapchains) {
+            for (auto semaphore : retiredSwapchain.renderFinishedSemaphores) {
+                mDeletionQueue->destroySemaphore(semaphore);
+            }
+            mDeletionQueue->destroySwapchain(retiredSwapchain.swapchain);
+        }
+        mRetiredSwapchains.clear();
+    }
+
+    // ================================================================================
+    // 3. VkCommandBuffer 기록
+    // ================================================================================
+    auto uploadWait = recordCommandBuffer(commandBuffer, swapchainImageIndex);
+
+    // ================================================================================
+    // 4. VkCommandBuffer 제출
+    // ================================================================================
+    // 스왑체인 이미지에 색을 쓰기 전에 이미지를 사용할 수 있을 때까지 기다린다.
+    VkPipelineStageFlags waitDstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    // 헤드리스 모드에서는 스왑체인과 동기화 할 필요가 없으므로 Semaphore를 사용하지 않는다.
+    VkSubmitInfo submitInfo{
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .waitSemaphoreCount = isHeadless() ? 0u : 1u,
+            .pWaitSemaphores = &frame.acquireSemaphore,
+            .pWaitDstStageMask = &waitDstStageMask,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &commandBuffer,
+            .signalSemaphoreCount = isHeadless() ? 0u : 1u,
+            .pSignalSemaphores = isHeadless() ? nullptr : &mRenderFinishedSemaphores[swapchainImageIndex]
     };
 
-    VK_CHECK_ERROR(vkCreateBuffer(mDevice, &vertexBufferCreateInfo, nullptr, &mVertexBuffer));
+    {
+        VK_TRACE_SCOPE("Submit");
+
+        // ticket의 제출이 끝나면 다음에 이 슬롯을 사용할 수 있다.
+        // acquire 배리어를 기록했으면 그 업로드를 제출한 transfer 큐의 timeline semaphore도 함께 기다린다.
+        frame.ticket = mDeviceQueues->submit(VK_QUEUE_TYPE_GRAPHICS, submitInfo, uploadWait);
+    }
 
     // ================================================================================
-    // 20. Vertex VkBuffer의 VkMemoryRequirements 얻기
+    // 5. VkImage 화면에 출력
     // ================================================================================
-    VkMemoryRequirements vertexMemoryRequirements;
-    vkGetBufferMemoryRequirements(mDevice, mVertexBuffer, &vertexMemoryRequirements);
+    if (!isHeadless()) {
+        VK_TRACE_SCOPE("Present");
+
+        // 화면에 출력된 시간을 나중에 찾을 수 있도록 프레임 번호를 presentID로 넘긴다.
+        auto presentID = static_cast<uint32_t>(mFrameRing->frameNumber());
+        mFrameStartTimes[presentID % mFrameStartTimes.size()] = {presentID, frameStartTime};
+
+        VkPresentTimeGOOGLE presentTiming{
+                .presentID = presentID
+        };
+
+        VkPresentTimesInfoGOOGLE presentTimesInfo{
+                .sType = VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE,
+                .swapchainCount = 1,
+                .pTimes = &presentTiming
+        };
+
+        VkPresentInfoKHR presentInfo{
+                .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+                .pNext = mGetPastPresentationTiming ? &presentTimesInfo : nullptr,
+                .waitSemaphoreCount = 1,
+                .pWaitSemaphores = &mRenderFinishedSemaphores[swapchainImageIndex],
+                .swapchainCount = 1,
+                .pSwapchains = &mSwapchain,
+                .pImageIndices = &swapchainImageIndex
+        };
+
+        auto result = mDeviceQueues->present(presentInfo); // 화면에 출력.
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+            mSwapchainOutOfDate = true;
+        } else {
+            VK_CHECK_ERROR(result);
+        }
+
+        // present 간격으로 처리량을 측정한다.
+        auto presentTime = vkTraceNow();
+        if (mLastPresentTime != 0) {
+            auto frameTime = static_cast<double>(presentTime - mLastPresentTime) / 1e6;
+            mPresentStats.frameTime += (frameTime - mPresentStats.frameTime) / static_cast<double>(++mPresentStats.frameCount);
+        }
+        mLastPresentTime = presentTime;
+
+        // 스왑체인을 다시 만들어야 하면 시간을 조회해도 VK_ERROR_OUT_OF_DATE_KHR가 반환된다.
+        if (mGetPastPresentationTiming && !mSwapchainOutOfDate) {
+            collectPresentTimings();
+        }
+    }
+
+    // vkQueueWaitIdle로 기다리지 않고 바로 다음 프레임 슬롯으로 넘어간다.
+    mFrameRing->endFrame();
+}
+
+optional<VkQueueWait> VkRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+    VK_TRACE_SCOPE("Record");
 
     // ================================================================================
-    // 21. Vertex VkDeviceMemory를 할당 할 수 있는 메모리 타입 인덱스 얻기
+    // 1. VkCommandBuffer 기록 시작
     // ================================================================================
-    uint32_t vertexMemoryTypeIndex;
-    VK_CHECK_ERROR(vkGetMemoryTypeIndex(mPhysicalDeviceMemoryProperties,
-                                        vertexMemoryRequirements,
-                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                                        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                                        &vertexMemoryTypeIndex));
+    // 프레임 슬롯의 VkCommandPool이 초기화되었으므로 commandBuffer를 따로 초기화하지 않는다.
+    VkCommandBufferBeginInfo commandBufferBeginInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT // 한 번만 기록되고 다시 리셋 될 것이라는 의미
+    };
+
+    // commandBuffer를 기록중인 상태로 변경.
+    VK_CHECK_ERROR(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+
+    // 이 슬롯에서 이전에 측정한 GPU 시간을 읽고 새로 측정을 시작한다.
+    mGpuProfiler->beginFrame(commandBuffer, mFrameRing->frameIndex());
+    auto frameScope = mGpuProfiler->beginScope(commandBuffer, "Frame");
+
+    // 업로드가 끝난 버퍼를 정점 입력 단계에서 읽을 수 있도록 배리어를 기록한다.
+    // 이 command buffer를 제출할 때 업로드의 제출을 기다려야 하므로 반환한다.
+    auto uploadWait = mUploadQueue->recordAcquireBarriers(commandBuffer);
+
+    // 프레임 상수는 매핑된 메모리에 쓰기만 하고, 모든 그리기가 같은 dynamic offset으로 읽는다.
+    FrameConstants frameConstants{
+            .preRotation{{{mPreRotation[0], mPreRotation[1]}, {mPreRotation[2], mPreRotation[3]}}}
+    };
+
+    VkFrameAllocation frameConstantsAllocation;
+    auto allocated = mFrameAllocator->push(&frameConstants, sizeof(frameConstants), &frameConstantsAllocation);
+    assert(allocated); // 프레임 상수는 프레임의 첫 번째 할당이므로 실패하지 않는다.
+    mFrameConstantsOffset = frameConstantsAllocation.offset;
 
     // ================================================================================
-    // 22. Vertex VkDeviceMemory 할당
+    // 2. VkRenderPass 시작
     // ================================================================================
-    VkMemoryAllocateInfo vertexMemoryAllocateInfo{
-            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-            .allocationSize = vertexMemoryRequirements.size,
-            .memoryTypeIndex = vertexMemoryTypeIndex
+    // 그리기가 적으면 스레드에 나누는 비용이 더 크므로 primary command buffer에 직접 기록한다.
+    auto drawCount = (mInstanceCount + mMaxInstancesPerDraw - 1) / mMaxInstancesPerDraw;
+    auto parallel = mCommandRecorder && drawCount >= kMinParallelDrawCount;
+    auto framebuffer = mRenderPass != VK_NULL_HANDLE ? mFramebuffers[imageIndex] : VK_NULL_HANDLE;
+
+    VkImageSubresourceRange colorSubresourceRange{
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .levelCount = 1,
+            .layerCount = 1
     };
 
-    VK_CHECK_ERROR(vkAllocateMemory(mDevice, &vertexMemoryAllocateInfo, nullptr, &mVertexMemory));
+    auto renderPassScope = mGpuProfiler->beginScope(commandBuffer, "RenderPass");
+    if (mRenderPass != VK_NULL_HANDLE) {
+        VkRenderPassBeginInfo renderPassBeginInfo{
+                .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+                .renderPass = mRenderPass,
+                .framebuffer = framebuffer,
+                .renderArea{
+                        .extent = mSwapchainImageExtent
+                },
+                .clearValueCount = 1,
+                .pClearValues = &mClearValue
+        };
+
+        vkCmdBeginRenderPass(commandBuffer,
+                             &renderPassBeginInfo,
+                             parallel ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+    } else {
+        // VkRenderPass의 initialLayout과 subpass dependency가 하던 일을 배리어로 기록한다.
+        // 이전 내용은 지우므로 UNDEFINED에서 변환하고, acquireSemaphore를 기다리는 단계와 맞춰준다.
+        VkImageMemoryBarrier imageMemoryBarrier{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .srcAccessMask = 0,
+                .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                .newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = mSwapchainImages[imageIndex],
+                .subresourceRange = colorSubresourceRange
+        };
+
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             0,
+                             0, nullptr,
+                             0, nullptr,
+                             1, &imageMemoryBarrier);
+
+        VkRenderingAttachmentInfo renderingAttachmentInfo{
+                .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+                .imageView = mSwapchainImageViews[imageIndex],
+                .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+                .clearValue = mClearValue
+        };
 
+        VkRenderingInfo renderingInfo{
+                .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+                .flags = parallel ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0u,
+                .renderArea{
+                        .extent = mSwapchainImageExtent
+                },
+                .layerCount = 1,
+                .colorAttachmentCount = 1,
+                .pColorAttachments = &renderingAttachmentInfo
+        };
+
+        mCmdBeginRendering(commandBuffer, &renderingInfo);
+    }
+
+    // ================================================================================
+    // 3. 그리기 기록
     // ================================================================================
-    // 23. Vertex VkBuffer와 Vertex VkDeviceMemory 바인드
+    if (parallel) {
+        // secondary command buffer는 VkRenderPass 안의 어느 subpass에서 실행될지 알아야 한다.
+        // dynamic rendering에서는 VkRenderPass 대신 attachment의 포맷을 알려준다.
+        VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+                .colorAttachmentCount = 1,
+                .pColorAttachmentFormats = &mColorFormat,
+                .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+        };
+
+        VkCommandBufferInheritanceInfo inheritanceInfo{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+                .pNext = mRenderPass == VK_NULL_HANDLE ? &inheritanceRenderingInfo : nullptr,
+                .renderPass = mRenderPass,
+                .subpass = 0,
+                .framebuffer = framebuffer
+        };
+
+        auto &secondaryCommandBuffers = mCommandRecorder->record(
+                inheritanceInfo,
+                drawCount,
+                [this](VkCommandBuffer secondaryCommandBuffer, uint32_t beginDraw, uint32_t endDraw) {
+                    recordDraws(secondaryCommandBuffer, beginDraw, endDraw);
+                });
+
+        // 범위 순서대로 실행되므로 한 스레드에서 기록한 것과 결과가 같다.
+        vkCmdExecuteCommands(commandBuffer,
+                             static_cast<uint32_t>(secondaryCommandBuffers.size()),
+                             secondaryCommandBuffers.data());
+    } else {
+        recordDraws(commandBuffer, 0, drawCount);
+    }
+
     // ================================================================================
-    VK_CHECK_ERROR(vkBindBufferMemory(mDevice, mVertexBuffer, mVertexMemory, 0));
+    // 4. VkRenderPass 종료
+    // ================================================================================
+    if (mRenderPass != VK_NULL_HANDLE) {
+        vkCmdEndRenderPass(commandBuffer);
+    } else {
+        mCmdEndRendering(commandBuffer);
+
+        // VkRenderPass의 finalLayout처럼 화면에 출력하거나 읽어갈 수 있는 레이아웃으로 변환한다.
+        VkImageMemoryBarrier imageMemoryBarrier{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                .dstAccessMask = 0,
+                .oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                .newLayout = mColorFinalLayout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = mSwapchainImages[imageIndex],
+                .subresourceRange = colorSubresourceRange
+        };
+
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0,
+                             0, nullptr,
+                             0, nullptr,
+                             1, &imageMemoryBarrier);
+    }
+    mGpuProfiler->endScope(commandBuffer, renderPassScope);
 
     // ================================================================================
-    // 24. Vertex 데이터 복사
+    // 5. VkCommandBuffer 기록 종료
     // ================================================================================
-    void* vertexData;
-    VK_CHECK_ERROR(vkMapMemory(mDevice, mVertexMemory, 0, vertexDataSize, 0, &vertexData));
-    memcpy(vertexData, vertices.data(), vertexDataSize);
-    vkUnmapMemory(mDevice, mVertexMemory);
+    mGpuProfiler->endScope(commandBuffer, frameScope);
+    VK_CHECK_ERROR(vkEndCommandBuffer(commandBuffer)); // commandBuffer는 Executable 상태가 된다.
+
+    return uploadWait;
+}
+
+void VkRenderer::recordDraws(VkCommandBuffer commandBuffer, uint32_t beginDraw, uint32_t endDraw) {
+    // secondary command buffer는 primary의 상태를 물려받지 않으므로 범위마다 처음부터 상태를 설정한다.
 
     // ================================================================================
-    // 25. VkDescriptorPool 생성
+    // 1. Graphics VkPipeline 바인드
     // ================================================================================
-    VkDescriptorPoolSize descriptorPoolSize{
-            .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = 1
+    // 요청한 상태의 파이프라인이 아직 없으면 만들어지는 동안 기본 상태의 파이프라인으로 그린다.
+    auto pipeline = mPipelineManager->request(makePipelineKey(mVertexShaderModule,
+                                                              mFragmentShaderModule,
+                                                              mPipelineState));
+    // 기본 상태와 topology의 종류가 다르면 대신 그릴 수 없으므로 만들어질 때까지 그리지 않는다.
+    if (pipeline == VK_NULL_HANDLE) {
+        return;
+    }
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    // extended dynamic state를 사용하면 파이프라인에서 빠진 상태를 여기서 기록한다.
+    mPipelineManager->setDynamicState(commandBuffer, mPipelineState);
+    // 그리기마다 바꾸지 않고 범위마다 한 번만 바인드한다.
+    mBindlessHeap->bind(commandBuffer, mPipelineLayout, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    mFrameAllocator->bind(commandBuffer, mPipelineLayout, 1, mFrameConstantsOffset);
+
+    VkViewport viewport{
+            .width = static_cast<float>(mSwapchainImageExtent.width),
+            .height = static_cast<float>(mSwapchainImageExtent.height),
+            .maxDepth = 1.0f
     };
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
-    VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-            .flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
-            .maxSets = 1,
-            .poolSizeCount = 1,
-            .pPoolSizes = &descriptorPoolSize
+    VkRect2D scissor{
+            .extent = mSwapchainImageExtent
     };
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    VK_CHECK_ERROR(vkCreateDescriptorPool(mDevice,
-                                          &descriptorPoolCreateInfo,
-                                          nullptr,
-                                          &mDescriptorPool));
+    // ================================================================================
+    // 2. 메시, Instance VkBuffer 바인드
+    // ================================================================================
+    mMesh->bind(commandBuffer);
+
+    VkDeviceSize instanceBufferOffset{0};
+    vkCmdBindVertexBuffers(commandBuffer, 1, 1, &mInstanceBuffer, &instanceBufferOffset);
 
     // ================================================================================
-    // 25. VkDescriptorSet 할당
+    // 3. 메시 그리기
     // ================================================================================
-    VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{
-            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-            .descriptorPool = mDescriptorPool,
-            .descriptorSetCount = 1,
-            .pSetLayouts = &mDescriptorSetLayout
+    // 모든 그리기가 같은 텍스처를 사용하고, 그리기마다 변환하지 않는다.
+    VkDrawConstants drawConstants{
+            .transform{1.0f, 0.0f, 0.0f, 1.0f},
+            .materialIndex = mMaterialIndex
     };
 
-    VK_CHECK_ERROR(vkAllocateDescriptorSets(mDevice, &descriptorSetAllocateInfo, &mDescriptorSet));
+    // 그리기마다 mMaxInstancesPerDraw개의 인스턴스를 그린다.
+    for (auto draw = beginDraw; draw != endDraw; ++draw) {
+        auto firstInstance = draw * mMaxInstancesPerDraw;
+        auto instanceCount = min(mMaxInstancesPerDraw, mInstanceCount - firstInstance);
+
+        drawConstants.firstInstance = firstInstance;
+        if (mDrawDataPath == VK_DRAW_DATA_PATH_PUSH_CONSTANTS) {
+            mDrawConstants->push(commandBuffer, mPipelineLayout, drawConstants);
+        } else {
+            // 공간이 부족하면 그리지 않는다. 프레임 할당기의 overflowCount로 알 수 있다.
+            VkFrameAllocation drawConstantsAllocation;
+            if (!mFrameAllocator->push(&drawConstants, sizeof(drawConstants), &drawConstantsAllocation)) {
+                continue;
+            }
+            mFrameAllocator->bind(commandBuffer, mPipelineLayout, 2, drawConstantsAllocation.offset);
+        }
+
+        mMesh->drawInstances(commandBuffer, instanceCount, firstInstance);
+    }
 }
 
-VkRenderer::~VkRenderer() {
-    vkFreeDescriptorSets(mDevice, mDescriptorPool, 1, &mDescriptorSet);
-    vkDestroyDescriptorPool(mDevice, mDescriptorPool, nullptr);
-    vkFreeMemory(mDevice, mVertexMemory, nullptr);
-    vkDestroyBuffer(mDevice, mVertexBuffer, nullptr);
-    vkDestroyDescriptorSetLayout(mDevice, mDescriptorSetLayout, nullptr);
-    vkDestroyPipelineLayout(mDevice, mPipelineLayout, nullptr);
-    vkDestroyPipeline(mDevice, mPipeline, nullptr);
-    vkDestroyShaderModule(mDevice, mVertexShaderModule, nullptr);
-    vkDestroyShaderModule(mDevice, mFragmentShaderModule, nullptr);
+bool VkRenderer::writeTrace(const std::string &path) const {
+    vector<VkTraceEvent> events;
+    vector<VkTraceThread> threads;
+
+    // CPU 구간과 GPU 구간을 같은 시간축에 놓고 하나의 파일로 저장한다.
+    vkTraceCollect(&events, &threads);
+    mGpuProfiler->collectTrace(&events, &threads);
+
+    return vkWriteChromeTrace(path, events, threads);
+}
+
+void VkRenderer::collectPresentTimings() {
+    // 화면에 출력이 끝난 프레임의 시간만 반환되고 한 번 반환된 결과는 다시 반환되지 않는다.
+    // 회전이나 크기 변경으로 스왑체인이나 surface를 사용할 수 없게 되면 이번에는 시간을 얻지 못한 것으로 처리한다.
+    auto unavailable = [](VkResult result) {
+        return result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_ERROR_SURFACE_LOST_KHR;
+    };
+
+    // 주사율은 실행 중에도 바뀔 수 있으므로 매번 조회한다. 프레임 간격을 맞추는데 사용된다.
+    VkRefreshCycleDurationGOOGLE refreshCycleDuration;
+    auto result = mGetRefreshCycleDuration(mDevice, mSwapchain, &refreshCycleDuration);
+    if (unavailable(result)) {
+        return;
+    }
+    VK_CHECK_ERROR(result);
+    mPresentStats.refreshDuration = refreshCycleDuration.refreshDuration;
+
+    uint32_t timingCount;
+    result = mGetPastPresentationTiming(mDevice, mSwapchain, &timingCount, nullptr);
+    if (unavailable(result)) {
+        return;
+    }
+    VK_CHECK_ERROR(result);
+    if (timingCount == 0) {
+        return;
+    }
+
+    vector<VkPastPresentationTimingGOOGLE> timings(timingCount);
+    result = mGetPastPresentationTiming(mDevice, mSwapchain, &timingCount, timings.data());
+    if (unavailable(result)) {
+        return;
+    }
+    if (result != VK_INCOMPLETE) {
+        VK_CHECK_ERROR(result);
+    }
+
+    for (uint32_t i = 0; i != timingCount; ++i) {
+        const auto &[presentID, frameStartTime] = mFrameStartTimes[timings[i].presentID % mFrameStartTimes.size()];
+        // 너무 오래되어 시작 시간이 덮어써진 프레임은 건너뛴다.
+        if (presentID != timings[i].presentID || timings[i].actualPresentTime < frameStartTime) {
+            continue;
+        }
+
+        // actualPresentTime은 CLOCK_MONOTONIC 기준이고 Android의 steady_clock도 같은 시계를 사용한다.
+        auto latency = static_cast<double>(timings[i].actualPresentTime - frameStartTime) / 1e6;
+        mPresentStats.latency += (latency - mPresentStats.latency) / static_cast<double>(++mPresentStats.latencySampleCount);
+    }
+}
+
+void VkRenderer::setPresentConfig(const VkPresentConfig &presentConfig) {
+    mPresentConfig = presentConfig;
+    invalidateSwapchain();
+    resetPresentStats();
+}
+
+void VkRenderer::resetPresentStats() {
+    mPresentStats.frameCount = 0;
+    mPresentStats.frameTime = 0.0;
+    mPresentStats.latencySampleCount = 0;
+    mPresentStats.latency = 0.0;
+    mLastPresentTime = 0;
+}
+
+bool VkRenderer::recreateSwapchain() {
+    VK_TRACE_SCOPE("RecreateSwapchain");
+
+    VkSurfaceCapabilitiesKHR surfaceCapabilities;
+    VK_CHECK_ERROR(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(mPhysicalDevice,
+                                                             mSurface,
+                                                             &surfaceCapabilities));
+    if (surfaceCapabilities.currentExtent.width == 0 || surfaceCapabilities.currentExtent.height == 0) {
+        return false;
+    }
+
+    // 크기에 따라 달라지는 객체만 다시 만든다. VkRenderPass와 VkPipeline은 그대로 사용한다.
+    // 이전 스왑체인의 이미지를 사용하는 프레임을 기다리지 않고, 그 프레임이 끝난 후에 파괴한다.
     for (auto framebuffer : mFramebuffers) {
-        vkDestroyFramebuffer(mDevice, framebuffer, nullptr);
+        mDeletionQueue->destroyFramebuffer(framebuffer);
     }
-    mFramebuffers.clear();
-    vkDestroyRenderPass(mDevice, mRenderPass, nullptr);
     for (auto imageView : mSwapchainImageViews) {
-        vkDestroyImageView(mDevice, imageView, nullptr);
+        mDeletionQueue->destroyImageView(imageView);
     }
-    mSwapchainImageViews.clear();
-    vkDestroySemaphore(mDevice, mSemaphore, nullptr);
-    vkDestroyFence(mDevice, mFence, nullptr);
-    vkFreeCommandBuffers(mDevice, mCommandPool, 1, &mCommandBuffer);
-    vkDestroyCommandPool(mDevice, mCommandPool, nullptr);
-    vkDestroySwapchainKHR(mDevice, mSwapchain, nullptr);
-    vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
-    vkDestroyDevice(mDevice, nullptr); // Device 파괴. queue의 경우 Device를 생성하면서 생겼기 때문에 따로 파괴하는 API가 존재하지 않는다.
-    vkDestroyInstance(mInstance, nullptr);
+
+    createSwapchain();
+    createFramebuffers();
+    mSwapchainOutOfDate = false;
+
+    aout << "Swapchain Recreation: " << mSwapchainImageExtent.width << "x" << mSwapchainImageExtent.height
+         << ", transform " << mPreTransform << endl;
+
+    return true;
 }
 
-void VkRenderer::render() {
-    // ================================================================================
-    // 1. 화면에 출력할 수 있는 VkImage 얻기
-    // ================================================================================
-    uint32_t swapchainImageIndex;
-    VK_CHECK_ERROR(vkAcquireNextImageKHR(mDevice,
-                                         mSwapchain,
-                                         UINT64_MAX,
-                                         VK_NULL_HANDLE,
-                                         mFence,                 // Fence 설정
-                                         &swapchainImageIndex)); // 사용 가능한 이미지 변수에 담기
-    //auto swapchainImage = mSwapchainImages[swapchainImageIndex]; // swapchainImage에 더 이상 직접 접근하지 않으므로 이제 사용X
-    auto framebuffer = mFramebuffers[swapchainImageIndex];
+void VkRenderer::waitIdle() {
+    mFrameRing->waitIdle();
+}
 
-    // ================================================================================
-    // 2. VkFence 기다린 후 초기화
-    // ================================================================================
-    // mFence가 Signal 될 때까지 기다린다.
-    VK_CHECK_ERROR(vkWaitForFences(mDevice, 1, &mFence, VK_TRUE, UINT64_MAX));
-    // mFence가 Siganl이 되면 vkResetFences를 호출해서 Fence의 상태를 다시 초기화한다.
-    // 초기화하는 이유: vkAcquireNextImageKHR을 호출할 때 이 Fence의 상태는 항상 Unsignal 상태여야 하기 때문이다.
-    VK_CHECK_ERROR(vkResetFences(mDevice, 1, &mFence));
+void VkRenderer::setMesh(const MeshData &meshData) {
+    // 이전 메시를 사용하는 프레임이 있을 수 있으므로 기다리지 않고 그 프레임이 끝난 후에 파괴한다.
+    if (mMesh) {
+        mDeletionQueue->push([mesh = shared_ptr<VkMesh>(std::move(mMesh))]() mutable { mesh.reset(); });
+    }
 
-    // ================================================================================
-    // 3. VkCommandBuffer 초기화
-    // ================================================================================
-    vkResetCommandBuffer(mCommandBuffer, 0);
+    mMesh = make_unique<VkMesh>(mMemoryAllocator.get(), mUploadQueue.get(), meshData);
+
+    // 업로드가 끝나기를 기다리지 않고 제출만 한다. 다음 프레임의 제출이 transfer 큐의 semaphore를 기다리고
+    // 소유권을 가져오는 배리어는 다음 프레임의 command buffer에 기록된다.
+    mUploadQueue->flush();
+}
+
+void VkRenderer::setInstances(const vector<MeshInstance> &instances) {
+    assert(!instances.empty());
+
+    VkDeviceSize instanceDataSize{instances.size() * sizeof(MeshInstance)};
+
+    // 이전 VkBuffer를 사용하는 프레임이 있을 수 있으므로 덮어쓰지 않고 항상 새로 만든다.
+    // 이전 VkBuffer는 그 프레임이 끝난 후에 파괴한다.
+    if (mInstanceBuffer != VK_NULL_HANDLE) {
+        mDeletionQueue->destroyBuffer(mInstanceBuffer, mInstanceAllocation);
+        mInstanceBuffer = VK_NULL_HANDLE;
+    }
+
+    VkBufferCreateInfo instanceBufferCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size = instanceDataSize,
+            .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+    };
+
+    VkAllocationCreateInfo allocationCreateInfo{
+            .memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    };
+
+    VK_CHECK_ERROR(mMemoryAllocator->createBuffer(instanceBufferCreateInfo,
+                                                  allocationCreateInfo,
+                                                  &mInstanceBuffer,
+                                                  &mInstanceAllocation));
+
+    mUploadQueue->upload(mInstanceBuffer,
+                         0,
+                         instances.data(),
+                         instanceDataSize,
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                         VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+    mUploadQueue->flush();
+    mInstanceCount = static_cast<uint32_t>(instances.size());
+}
+
+void VkRenderer::readPixels(vector<uint8_t> *pixels) {
+    assert(isHeadless());
+    assert(mFrameRing->frameNumber() > 0); // 적어도 한 번은 render()를 호출해야 한다.
+
+    // 마지막으로 제출된 프레임이 쓴 이미지를 읽어야 하므로 모든 작업이 끝날 때까지 기다린다.
+    mDeviceQueues->waitIdle();
+
+    auto frameCount = mFrameRing->frameCount();
+    auto image = mSwapchainImages[(mFrameRing->frameIndex() + frameCount - 1) % frameCount];
+    VkDeviceSize dataSize = mSwapchainImageExtent.width * mSwapchainImageExtent.height * 4;
 
     // ================================================================================
-    // 4. VkCommandBuffer 기록 시작
+    // 1. 이미지를 복사할 Host에서 접근 가능한 VkBuffer 생성
     // ================================================================================
-    VkCommandBufferBeginInfo commandBufferBeginInfo{
-            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT // 한 번만 기록되고 다시 리셋 될 것이라는 의미
+    VkBufferCreateInfo bufferCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size = dataSize,
+            .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT
     };
 
-    // mCommandBuffer를 기록중인 상태로 변경.
-    VK_CHECK_ERROR(vkBeginCommandBuffer(mCommandBuffer, &commandBufferBeginInfo));
+    VkAllocationCreateInfo allocationCreateInfo{
+            .memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                   VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    };
 
+    VkBuffer buffer;
+    VkAllocation allocation;
+    VK_CHECK_ERROR(mMemoryAllocator->createBuffer(bufferCreateInfo, allocationCreateInfo, &buffer, &allocation));
 
     // ================================================================================
-    // 5. VkRenderPass 시작
+    // 2. VkImage를 VkBuffer로 복사
     // ================================================================================
-    VkRenderPassBeginInfo renderPassBeginInfo{
-            .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-            .renderPass = mRenderPass,
-            .framebuffer = framebuffer,
-            .renderArea{
-                    .extent = mSwapchainImageExtent
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = mCommandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+    };
+
+    VkCommandBuffer commandBuffer;
+    VK_CHECK_ERROR(vkAllocateCommandBuffers(mDevice, &commandBufferAllocateInfo, &commandBuffer));
+
+    VkCommandBufferBeginInfo commandBufferBeginInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+    };
+    VK_CHECK_ERROR(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+
+    // 렌더링이 끝나면서 이미지는 이미 TRANSFER_SRC_OPTIMAL 레이아웃이다.
+    VkBufferImageCopy bufferImageCopy{
+            .imageSubresource = {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .layerCount = 1
             },
-            .clearValueCount = 1,
-            .pClearValues = &mClearValue
+            .imageExtent = {mSwapchainImageExtent.width, mSwapchainImageExtent.height, 1}
     };
+    vkCmdCopyImageToBuffer(commandBuffer,
+                           image,
+                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           buffer,
+                           1,
+                           &bufferImageCopy);
 
-    vkCmdBeginRenderPass(mCommandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    VK_CHECK_ERROR(vkEndCommandBuffer(commandBuffer));
 
-    // ================================================================================
-    // 6. Graphics VkPipeline 바인드
-    // ================================================================================
-    vkCmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline);
+    VkSubmitInfo submitInfo{
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &commandBuffer
+    };
+    mDeviceQueues->wait(mDeviceQueues->submit(VK_QUEUE_TYPE_GRAPHICS, submitInfo));
 
     // ================================================================================
-    // 7. Vertex VkBuffer 바인드
+    // 3. 픽셀 데이터 복사
     // ================================================================================
-    VkDeviceSize vertexBufferOffset{0};
-    vkCmdBindVertexBuffers(mCommandBuffer, 0, 1, &mVertexBuffer, &vertexBufferOffset);
+    pixels->resize(dataSize);
+    memcpy(pixels->data(), allocation.mappedData, dataSize);
 
-    // ================================================================================
-    // 8. 삼각형 그리기
-    // ================================================================================
-    vkCmdDraw(mCommandBuffer, 3, 1, 0, 0);
+    vkFreeCommandBuffers(mDevice, mCommandPool, 1, &commandBuffer);
+    mMemoryAllocator->destroyBuffer(buffer, &allocation);
+}
+
+uint32_t VkRenderer::createTexture(uint32_t width, uint32_t height, const void *rgba) {
+    VkDeviceSize dataSize = width * height * 4;
 
     // ================================================================================
-    // 9. VkRenderPass 종료
+    // 1. VkImage 생성
     // ================================================================================
-    vkCmdEndRenderPass(mCommandBuffer);
+    Texture texture;
+
+    VkImageCreateInfo imageCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType = VK_IMAGE_TYPE_2D,
+            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .extent = {width, height, 1},
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+    };
+
+    VkAllocationCreateInfo imageAllocationCreateInfo{
+            .memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    };
+
+    VK_CHECK_ERROR(mMemoryAllocator->createImage(imageCreateInfo,
+                                                 imageAllocationCreateInfo,
+                                                 &texture.image,
+                                                 &texture.allocation));
 
     // ================================================================================
-    // 10. VkCommandBuffer 기록 종료
+    // 2. 픽셀 데이터를 Host에서 접근 가능한 VkBuffer에 복사
     // ================================================================================
-    VK_CHECK_ERROR(vkEndCommandBuffer(mCommandBuffer)); // mCommandBuffer는 Executable 상태가 된다.
+    VkBufferCreateInfo bufferCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size = dataSize,
+            .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+    };
+
+    VkAllocationCreateInfo bufferAllocationCreateInfo{
+            .memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                   VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    };
+
+    VkBuffer buffer;
+    VkAllocation allocation;
+    VK_CHECK_ERROR(mMemoryAllocator->createBuffer(bufferCreateInfo, bufferAllocationCreateInfo, &buffer, &allocation));
+    memcpy(allocation.mappedData, rgba, dataSize);
 
     // ================================================================================
-    // 11. VkCommandBuffer 제출
+    // 3. VkBuffer를 VkImage로 복사
     // ================================================================================
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = mCommandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+    };
+
+    VkCommandBuffer commandBuffer;
+    VK_CHECK_ERROR(vkAllocateCommandBuffers(mDevice, &commandBufferAllocateInfo, &commandBuffer));
+
+    VkCommandBufferBeginInfo commandBufferBeginInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+    };
+    VK_CHECK_ERROR(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+
+    VkImageMemoryBarrier imageMemoryBarrier{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = texture.image,
+            .subresourceRange = {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .levelCount = 1,
+                    .layerCount = 1
+            }
+    };
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &imageMemoryBarrier);
+
+    VkBufferImageCopy bufferImageCopy{
+            .imageSubresource = {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .layerCount = 1
+            },
+            .imageExtent = {width, height, 1}
+    };
+    vkCmdCopyBufferToImage(commandBuffer,
+                           buffer,
+                           texture.image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           1,
+                           &bufferImageCopy);
+
+    // 모든 셰이더 단계에서 읽을 수 있도록 레이아웃을 바꾼다.
+    imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &imageMemoryBarrier);
+
+    VK_CHECK_ERROR(vkEndCommandBuffer(commandBuffer));
+
     VkSubmitInfo submitInfo{
             .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
             .commandBufferCount = 1,
-            .pCommandBuffers = &mCommandBuffer,
-            .signalSemaphoreCount = 1,
-            .pSignalSemaphores = &mSemaphore
+            .pCommandBuffers = &commandBuffer
     };
+    mDeviceQueues->wait(mDeviceQueues->submit(VK_QUEUE_TYPE_GRAPHICS, submitInfo));
 
-    // submitInfo 구조체를 넘김으로써 commandBuffer 정보를 queue에 제출
-    VK_CHECK_ERROR(vkQueueSubmit(mQueue, 1, &submitInfo, VK_NULL_HANDLE));
+    vkFreeCommandBuffers(mDevice, mCommandPool, 1, &commandBuffer);
+    mMemoryAllocator->destroyBuffer(buffer, &allocation);
 
     // ================================================================================
-    // 12. VkImage 화면에 출력
+    // 4. VkImageView 생성, bindless 배열에 등록
     // ================================================================================
-    VkPresentInfoKHR presentInfo{
-            .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-            .waitSemaphoreCount = 1,
-            .pWaitSemaphores = &mSemaphore,
-            .swapchainCount = 1,
-            .pSwapchains = &mSwapchain,
-            .pImageIndices = &swapchainImageIndex
+    VkImageViewCreateInfo imageViewCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = texture.image,
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = imageCreateInfo.format,
+            .subresourceRange = {
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .levelCount = 1,
+                    .layerCount = 1
+            }
     };
+    VK_CHECK_ERROR(vkCreateImageView(mDevice, &imageViewCreateInfo, nullptr, &texture.imageView));
+
+    mTextures.push_back(texture);
 
-    VK_CHECK_ERROR(vkQueuePresentKHR(mQueue, &presentInfo)); // 화면에 출력.
-    VK_CHECK_ERROR(vkQueueWaitIdle(mQueue));
+    // 배열이 가득 차면 kInvalidBindlessIndex가 반환된다. 텍스처는 렌더러가 파괴될 때 함께 파괴된다.
+    return mBindlessHeap->addSampledImage(texture.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 }
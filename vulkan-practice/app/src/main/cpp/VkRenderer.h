@@ -20,26 +20,255 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#ifndef PRACTICE_VULKAN_VKRENDERER_H
+#define PRACTICE_VULKAN_VKRENDERER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+#include <android/native_window.h>
+#endif
 #include <vulkan/vulkan.h>
 
+#include "VkBindlessHeap.h"
+#include "VkCommandRecorder.h"
+#include "VkDeletionQueue.h"
+#include "VkDeviceQueues.h"
+#include "VkFrameAllocator.h"
+#include "VkFrameRing.h"
+#include "VkGpuProfiler.h"
+#include "VkJobSystem.h"
+#include "VkMemoryAllocator.h"
+#include "VkMesh.h"
+#include "VkPipelineBuilder.h"
+#include "VkPipelineCacheStore.h"
+#include "VkPipelineManager.h"
+#include "VkPresentConfig.h"
+#include "VkPushConstants.h"
+#include "VkUploadQueue.h"
+#ifdef VK_RUNTIME_SHADER_COMPILE
+#include "VkShaderCache.h"
+#endif
+
+// 그리기마다 바뀌는 데이터를 셰이더에 넘기는 방법.
+enum VkDrawDataPath {
+    VK_DRAW_DATA_PATH_PUSH_CONSTANTS, // vkCmdPushConstants로 command buffer에 직접 기록한다.
+    VK_DRAW_DATA_PATH_UNIFORM_BUFFER  // 프레임 할당기에 쓰고 set 2의 dynamic offset을 바꿔서 바인드한다. 비교용.
+};
+
+// 그리기마다 넘기는 데이터. triangle.vert의 DrawConstants 블록과 같은 레이아웃이다.
+struct VkDrawConstants {
+    std::array<float, 4> transform;   // mat2. 그리기마다 적용하는 변환. 화면 회전은 FrameConstants로 넘긴다.
+    uint32_t materialIndex;           // bindless 배열에서 사용할 텍스처의 인덱스
+    uint32_t firstInstance;
+};
+
+struct VkRendererConfig {
+    uint32_t maxFramesInFlight = 2; // CPU가 GPU보다 앞서 기록할 수 있는 프레임의 최대 개수
+    std::string pipelineCachePath;  // 비어있으면 파이프라인 캐시를 파일에 저장하지 않는다.
+    std::string shaderCacheDirectory; // 개발 모드 전용. 비어있으면 컴파일된 셰이더를 메모리에만 캐시한다.
+    std::string tracePath;            // 비어있지 않으면 렌더러가 파괴될 때 CPU/GPU 구간 시간을 Chrome Trace 파일로 저장한다.
+    VkPresentConfig present;          // 헤드리스 모드에서는 사용하지 않는다.
+    std::string physicalDevice;       // 사용할 장치의 인덱스나 이름. 비어있으면 점수가 가장 높은 장치를 사용한다.
+                                      // 환경 변수 PRACTICE_VULKAN_DEVICE가 있으면 그 값을 우선한다.
+    uint32_t jobThreadCount = 0;      // 작업 시스템의 스레드 수. 0이면 하드웨어 스레드 수, 1이면 작업 스레드를 만들지 않는다.
+    uint32_t maxInstancesPerDraw = UINT32_MAX; // 인스턴스를 이 개수씩 나눠서 그린다. 1이면 인스턴스마다 그리기를 기록한다.
+    VkDeviceSize frameAllocatorSize = 1024 * 1024; // 프레임마다 uniform, storage 데이터에 사용할 수 있는 크기
+    VkDrawDataPath drawDataPath = VK_DRAW_DATA_PATH_PUSH_CONSTANTS;
+    bool dynamicRendering = true;     // 장치가 지원하면 VkRenderPass와 VkFramebuffer 없이 렌더링한다.
+    bool extendedDynamicState = true; // 장치가 지원하면 래스터화와 깊이 상태를 동적 상태로 기록해서 파이프라인 수를 줄인다.
+};
+
 class VkRenderer {
 public:
-    explicit VkRenderer(ANativeWindow* window);
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+    explicit VkRenderer(ANativeWindow *window, const VkRendererConfig &config = {});
+#endif
+    // 헤드리스 모드. surface 없이 extent 크기의 오프스크린 이미지에 렌더링한다.
+    explicit VkRenderer(VkExtent2D extent, const VkRendererConfig &config = {});
     ~VkRenderer();
 
     void render();
 
+    // 창의 크기나 방향이 바뀌었을 때 호출한다. 다음 프레임을 그리기 전에 스왑체인을 다시 만든다.
+    void invalidateSwapchain() { mSwapchainOutOfDate = !isHeadless(); }
+
+    // 출력 방식을 바꾼다. 다음 프레임을 그리기 전에 스왑체인을 다시 만들고 측정 결과를 초기화한다.
+    void setPresentConfig(const VkPresentConfig &presentConfig);
+
+    VkPresentStats presentStats() const { return mPresentStats; }
+
+    void resetPresentStats();
+
+    // 제출된 모든 프레임의 실행이 끝날 때까지 기다린다.
+    void waitIdle();
+
+    // 헤드리스 모드에서 마지막으로 렌더링된 이미지를 RGBA8 형식으로 읽어온다.
+    void readPixels(std::vector<uint8_t> *pixels);
+
+    // 그릴 메시를 교체한다. 진행중인 프레임을 기다리지 않고 이전 메시는 그 프레임이 끝난 후에 파괴된다.
+    void setMesh(const MeshData &meshData);
+
+    // 인스턴스마다 메시의 위치와 크기를 지정한다. instances의 개수만큼 메시를 그린다.
+    void setInstances(const std::vector<MeshInstance> &instances);
+
+    bool isHeadless() const { return mSwapchain == VK_NULL_HANDLE; }
+
+    std::chrono::nanoseconds pipelineCreationTime() const { return mPipelineCreationTime; }
+
+    // 메시를 그릴 파이프라인의 상태를 바꾼다. 처음 사용하는 상태이면 백그라운드에서 파이프라인을 만들고
+    // 만들어질 때까지는 기본 상태로 그린다.
+    void setPipelineState(const VkPipelineState &state) { mPipelineState = state; }
+
+    // 백그라운드에서 만들고 있는 파이프라인이 모두 만들어질 때까지 기다린다.
+    void waitPipelines() { mPipelineManager->waitIdle(); }
+
+    VkPipelineManagerStats pipelineManagerStats() const { return mPipelineManager->stats(); }
+
+    // 장치가 지원하고 설정에서 켠 기능만 true이다.
+    const VkPipelineFeatures &pipelineFeatures() const { return mPipelineFeatures; }
+
+    // 생성자에서 셰이더와 파이프라인을 만든 단계들과 각 단계를 실행한 스레드.
+    const std::vector<VkBuildStep> &startupTimeline() const { return mStartupTimeline; }
+
+    // 구간별 GPU 시간. frames-in-flight만큼 늦게 반영된다.
+    std::vector<VkGpuTiming> gpuTimings() const { return mGpuProfiler->timings(); }
+
+    bool gpuProfilingEnabled() const { return mGpuProfiler->enabled(); }
+
+    bool writeTrace(const std::string &path) const;
+
+    VkMemoryAllocatorStats memoryAllocatorStats() const { return mMemoryAllocator->stats(); }
+
+    // 한 프레임에서 사용한 크기의 최대값과 공간이 부족해서 실패한 할당의 수.
+    VkFrameAllocatorStats frameAllocatorStats() const { return mFrameAllocator->stats(); }
+
+    // 텍스처와 스토리지 버퍼를 등록하고 셰이더에서 사용할 인덱스를 얻는다.
+    VkBindlessHeap *bindlessHeap() const { return mBindlessHeap.get(); }
+
+    // width x height 크기의 RGBA8 텍스처를 만들어서 bindless 배열에 등록하고 인덱스를 반환한다.
+    // 업로드가 끝날 때까지 기다리며, 텍스처는 렌더러가 파괴될 때 함께 파괴된다.
+    uint32_t createTexture(uint32_t width, uint32_t height, const void *rgba);
+
+    // 메시를 그릴 때 사용할 텍스처의 인덱스. 처음에는 흰색 기본 텍스처를 사용한다.
+    void setMaterialIndex(uint32_t materialIndex) { mMaterialIndex = materialIndex; }
+
+    uint32_t defaultMaterialIndex() const { return mDefaultMaterialIndex; }
+
+#ifdef VK_RUNTIME_SHADER_COMPILE
+    VkShaderCacheStats shaderCacheStats() const { return mShaderCache->stats(); }
+#endif
+
 private:
+    void createInstance(bool presentable);
+    void createDevice(bool presentable, const VkRendererConfig &config);
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+    void createSurface(ANativeWindow *window);
+#endif
+    void createSwapchain();
+    void createOffscreenImages(VkExtent2D extent, uint32_t imageCount);
+    void createRenderPass();
+    void createFramebuffers();
+    void createRenderResources(const VkRendererConfig &config);
+    bool recreateSwapchain();
+    void collectPresentTimings();
+    // 기록한 업로드의 acquire 배리어가 기다려야 할 제출을 반환한다.
+    std::optional<VkQueueWait> recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+    void recordDraws(VkCommandBuffer commandBuffer, uint32_t beginDraw, uint32_t endDraw);
+    VkPipelineKey makePipelineKey(VkShaderModule vertexShader,
+                                  VkShaderModule fragmentShader,
+                                  const VkPipelineState &state) const;
+
     VkInstance mInstance;
     VkPhysicalDevice mPhysicalDevice;
+    VkPhysicalDeviceProperties mPhysicalDeviceProperties;
+    VkPhysicalDeviceMemoryProperties mPhysicalDeviceMemoryProperties;
     uint32_t mQueueFamilyIndex;
+    uint32_t mTimestampValidBits;
     VkDevice mDevice;
     VkQueue mQueue;
-    VkSurfaceKHR mSurface;
-    VkSwapchainKHR mSwapchain;
-    std::vector<VkImage> mSwapchainImages;
+    std::unique_ptr<VkDeviceQueues> mDeviceQueues; // graphics, compute, transfer 큐. 모든 제출은 이것을 통해서 한다.
+    std::unique_ptr<VkMemoryAllocator> mMemoryAllocator;
+    std::unique_ptr<VkDeletionQueue> mDeletionQueue; // GPU가 사용을 끝낸 후에 리소스를 파괴한다.
+    VkPipelineFeatures mPipelineFeatures{};
+    // Vulkan 1.2 장치에서는 VK_KHR_dynamic_rendering의 함수를 사용하므로 직접 얻어온다.
+    PFN_vkCmdBeginRenderingKHR mCmdBeginRendering{nullptr};
+    PFN_vkCmdEndRenderingKHR mCmdEndRendering{nullptr};
+    ANativeWindow *mWindow{nullptr};
+    VkSurfaceKHR mSurface{VK_NULL_HANDLE};
+    VkSwapchainKHR mSwapchain{VK_NULL_HANDLE};
+    std::vector<VkImage> mSwapchainImages;              // 헤드리스 모드에서는 오프스크린 이미지
+    // 렌더링이 끝나 화면에 출력할 수 있을 때 Signal. 얻은 이미지의 인덱스로 사용한다. 헤드리스 모드에서는 비어있다.
+    std::vector<VkSemaphore> mRenderFinishedSemaphores;
+    // 다시 만들기 전의 스왑체인과 그 스왑체인의 출력이 기다리는 semaphore.
+    // 출력이 끝났는지는 timeline으로 알 수 없으므로 새 스왑체인에서 이미지를 얻은 후에 파괴한다.
+    struct RetiredSwapchain {
+        VkSwapchainKHR swapchain;
+        std::vector<VkSemaphore> renderFinishedSemaphores;
+    };
+    std::vector<RetiredSwapchain> mRetiredSwapchains;
+    std::vector<VkAllocation> mOffscreenAllocations;    // 헤드리스 모드에서만 사용
+    bool mSwapchainOutOfDate{false};
+    VkPresentConfig mPresentConfig;
+    VkPresentStats mPresentStats;
+    uint64_t mLastPresentTime{0};
+    // VK_GOOGLE_display_timing으로 프레임이 실제로 화면에 출력된 시간을 얻는다.
+    PFN_vkGetPastPresentationTimingGOOGLE mGetPastPresentationTiming{nullptr};
+    PFN_vkGetRefreshCycleDurationGOOGLE mGetRefreshCycleDuration{nullptr};
+    std::array<std::pair<uint32_t, uint64_t>, 16> mFrameStartTimes{}; // presentID와 프레임을 시작한 시간
+    VkExtent2D mSwapchainImageExtent;
+    VkSurfaceTransformFlagBitsKHR mPreTransform{VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR};
+    std::array<float, 4> mPreRotation{1.0f, 0.0f, 0.0f, 1.0f}; // mPreTransform을 적용하는 2x2 행렬
+    VkFormat mColorFormat;
+    VkImageLayout mColorFinalLayout;
+    std::vector<VkImageView> mSwapchainImageViews;
     VkCommandPool mCommandPool;
-    VkCommandBuffer mCommandBuffer;
-    VkFence mFence;
-    VkClearColorValue mClearColorValue{.float32{0.6431, 0.7765, 0.2235, 1.0}};
-};
\ No newline at end of file
+    std::unique_ptr<VkFrameRing> mFrameRing;
+    std::unique_ptr<VkJobSystem> mJobSystem; // 렌더러의 CPU 작업을 여러 스레드에 나눠서 실행한다.
+    std::unique_ptr<VkCommandRecorder> mCommandRecorder; // 작업 스레드가 없으면 nullptr
+    std::unique_ptr<VkFrameAllocator> mFrameAllocator;
+    uint32_t mFrameConstantsOffset{0}; // 현재 프레임의 FrameConstants의 dynamic offset
+    VkDeviceSize mReportedFrameAllocatorHighWaterMark{0}; // 공간 부족을 마지막으로 출력했을 때의 highWaterMark
+    std::unique_ptr<VkGpuProfiler> mGpuProfiler;
+    std::string mTracePath;
+    VkRenderPass mRenderPass{VK_NULL_HANDLE}; // dynamic rendering을 사용하면 만들지 않는다.
+    std::vector<VkFramebuffer> mFramebuffers;
+#ifdef VK_RUNTIME_SHADER_COMPILE
+    std::unique_ptr<VkShaderCache> mShaderCache;
+#endif
+    VkShaderModule mVertexShaderModule;
+    VkShaderModule mFragmentShaderModule;
+    std::unique_ptr<VkBindlessHeap> mBindlessHeap; // 모든 텍스처와 스토리지 버퍼의 descriptor
+    struct Texture {
+        VkImage image;
+        VkImageView imageView;
+        VkAllocation allocation;
+    };
+    std::vector<Texture> mTextures; // createTexture로 만든 텍스처. 렌더러가 파괴될 때 파괴한다.
+    uint32_t mDefaultMaterialIndex{0};
+    uint32_t mMaterialIndex{0};     // DrawConstants로 넘기는 텍스처의 인덱스
+    std::optional<VkPushConstants<VkDrawConstants>> mDrawConstants; // mPipelineLayout의 push constant 범위
+    VkPipelineLayout mPipelineLayout;
+    VkDrawDataPath mDrawDataPath{VK_DRAW_DATA_PATH_PUSH_CONSTANTS};
+    std::unique_ptr<VkPipelineCacheStore> mPipelineCacheStore;
+    std::unique_ptr<VkPipelineManager> mPipelineManager;
+    uint32_t mVertexLayout;
+    VkPipelineState mPipelineState; // 메시를 그릴 때 사용할 파이프라인의 상태
+    std::chrono::nanoseconds mPipelineCreationTime{0};
+    std::vector<VkBuildStep> mStartupTimeline;
+    std::unique_ptr<VkUploadQueue> mUploadQueue;
+    std::unique_ptr<VkMesh> mMesh;
+    VkBuffer mInstanceBuffer{VK_NULL_HANDLE};
+    VkAllocation mInstanceAllocation;
+    uint32_t mInstanceCount{0};
+    uint32_t mMaxInstancesPerDraw{UINT32_MAX};
+    VkClearValue mClearValue{.color{.float32{0.6431, 0.7765, 0.2235, 1.0}}};
+};
+
+#endif //PRACTICE_VULKAN_VKRENDERER_H
@@ -0,0 +1,247 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "VkShaderCache.h"
+#include "AndroidOut.h"
+
+using namespace std;
+
+namespace {
+
+// 캐시 파일의 형식이 바뀌면 값을 올려서 이전 파일들을 무효화한다.
+constexpr uint32_t kShaderCacheVersion = 1;
+constexpr uint32_t kShaderCacheMagic = 0x43565053; // "SPVC"
+
+struct ShaderCacheFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint64_t codeCount; // uint32_t 단위의 SPIR-V 길이
+};
+
+// FNV-1a 64비트 해시.
+class Hasher {
+public:
+    void update(const void *data, size_t size) {
+        auto bytes = static_cast<const uint8_t *>(data);
+        for (auto i = 0; i != size; ++i) {
+            mHash = (mHash ^ bytes[i]) * 0x100000001b3ull;
+        }
+    }
+
+    void update(string_view value) {
+        uint64_t size = value.size(); // 길이도 넣어야 "ab"+"c"와 "a"+"bc"가 구분된다.
+        update(&size, sizeof(size));
+        update(value.data(), value.size());
+    }
+
+    uint64_t hash() const { return mHash; }
+
+private:
+    uint64_t mHash{0xcbf29ce484222325ull};
+};
+
+} // namespace
+
+VkShaderCache::VkShaderCache(string directory)
+        : mDirectory(std::move(directory)) {
+    if (!mDirectory.empty()) {
+        mkdir(mDirectory.c_str(), 0700); // 이미 존재하는 경우는 무시한다.
+    }
+}
+
+VkResult VkShaderCache::compile(string_view shaderCode,
+                                VkShaderType shaderType,
+                                const VkShaderCompileOptions &shaderCompileOptions,
+                                vector<uint32_t> *shaderBinary) {
+    auto key = makeKey(shaderCode, shaderType, shaderCompileOptions);
+
+    // ================================================================================
+    // 1. 메모리 캐시 확인
+    // ================================================================================
+    {
+        lock_guard<mutex> lock(mMutex);
+        if (auto iter = mShaderBinaries.find(key); iter != mShaderBinaries.end()) {
+            *shaderBinary = iter->second;
+            ++mMemoryHits;
+            return VK_SUCCESS;
+        }
+    }
+
+    // ================================================================================
+    // 2. 디스크 캐시 확인
+    // ================================================================================
+    if (load(key, shaderBinary)) {
+        lock_guard<mutex> lock(mMutex);
+        mShaderBinaries.emplace(key, *shaderBinary);
+        ++mDiskHits;
+        return VK_SUCCESS;
+    }
+
+    // ================================================================================
+    // 3. shaderc로 컴파일
+    // ================================================================================
+    ++mMisses;
+
+    auto compileBegin = chrono::steady_clock::now();
+    auto result = vkCompileShader(shaderCode, shaderType, shaderCompileOptions, shaderBinary);
+    mCompileTime += chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - compileBegin).count();
+
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    store(key, *shaderBinary);
+
+    lock_guard<mutex> lock(mMutex);
+    mShaderBinaries.emplace(key, *shaderBinary);
+    return VK_SUCCESS;
+}
+
+VkShaderCacheStats VkShaderCache::stats() const {
+    return {
+            .memoryHits = mMemoryHits,
+            .diskHits = mDiskHits,
+            .misses = mMisses,
+            .compileTime = chrono::nanoseconds(mCompileTime)
+    };
+}
+
+uint64_t VkShaderCache::makeKey(string_view shaderCode,
+                                VkShaderType shaderType,
+                                const VkShaderCompileOptions &shaderCompileOptions) {
+    Hasher hasher;
+
+    hasher.update(&kShaderCacheVersion, sizeof(kShaderCacheVersion));
+
+    // 컴파일러가 바뀌면 같은 코드에서도 다른 SPIR-V가 나올 수 있으므로 이전 결과를 사용하지 않는다.
+    // VK_SHADERC_ID는 빌드할 때 링크한 shaderc 라이브러리의 해시다.
+    hasher.update(VK_SHADERC_ID);
+
+    // 컴파일러가 같아도 생성하는 SPIR-V 버전이 바뀌면 이전 결과를 사용하지 않는다.
+    unsigned int spirvVersion, spirvRevision;
+    shaderc_get_spv_version(&spirvVersion, &spirvRevision);
+    hasher.update(&spirvVersion, sizeof(spirvVersion));
+    hasher.update(&spirvRevision, sizeof(spirvRevision));
+
+    hasher.update(shaderCode);
+    hasher.update(&shaderType, sizeof(shaderType));
+
+    uint8_t optimize = shaderCompileOptions.optimize;
+    hasher.update(&optimize, sizeof(optimize));
+    for (const auto &[name, value] : shaderCompileOptions.macroDefinitions) {
+        hasher.update(name);
+        hasher.update(value);
+    }
+
+    return hasher.hash();
+}
+
+string VkShaderCache::makePath(uint64_t key) const {
+    ostringstream path;
+    path << mDirectory << "/" << hex << setw(16) << setfill('0') << key << ".spv";
+    return path.str();
+}
+
+bool VkShaderCache::load(uint64_t key, vector<uint32_t> *shaderBinary) const {
+    if (mDirectory.empty()) {
+        return false;
+    }
+
+    auto fd = open(makePath(key).c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat fileStat{};
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < sizeof(ShaderCacheFileHeader)) {
+        close(fd);
+        return false;
+    }
+
+    // 파일 전체를 읽지 않고 mmap으로 매핑해서 필요한 페이지만 읽는다.
+    auto fileSize = static_cast<size_t>(fileStat.st_size);
+    auto data = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    ShaderCacheFileHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    // 해시 충돌이나 쓰다 만 파일을 사용하지 않도록 헤더를 검증한다.
+    auto valid = header.magic == kShaderCacheMagic &&
+                 header.version == kShaderCacheVersion &&
+                 header.key == key &&
+                 header.codeCount > 0 &&
+                 sizeof(header) + header.codeCount * sizeof(uint32_t) == fileSize;
+    if (valid) {
+        auto code = reinterpret_cast<const uint32_t *>(static_cast<const uint8_t *>(data) + sizeof(header));
+        shaderBinary->assign(code, code + header.codeCount);
+    }
+
+    munmap(data, fileSize);
+    return valid;
+}
+
+void VkShaderCache::store(uint64_t key, const vector<uint32_t> &shaderBinary) const {
+    if (mDirectory.empty()) {
+        return;
+    }
+
+    ShaderCacheFileHeader header{
+            .magic = kShaderCacheMagic,
+            .version = kShaderCacheVersion,
+            .key = key,
+            .codeCount = shaderBinary.size()
+    };
+
+    // 다른 프로세스나 스레드가 쓰다 만 파일을 읽지 않도록 임시 파일에 쓴 후 교체한다.
+    auto path = makePath(key);
+    static atomic<uint32_t> sequence{0};
+    auto temporaryPath = path + "." + to_string(getpid()) + "." + to_string(sequence++) + ".tmp";
+    auto fd = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        return;
+    }
+
+    auto codeSize = static_cast<ssize_t>(shaderBinary.size() * sizeof(uint32_t));
+    auto written = write(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header)) &&
+                   write(fd, shaderBinary.data(), codeSize) == codeSize;
+    close(fd);
+
+    if (!written || rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        aout << "Failed to write shader cache to " << path << "." << endl;
+        unlink(temporaryPath.c_str());
+    }
+}
@@ -0,0 +1,82 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKSHADERCACHE_H
+#define PRACTICE_VULKAN_VKSHADERCACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "VkUtil.h"
+
+struct VkShaderCacheStats {
+    uint64_t memoryHits;
+    uint64_t diskHits;
+    uint64_t misses;
+    std::chrono::nanoseconds compileTime; // shaderc로 컴파일하는데 사용한 시간의 합
+};
+
+// vkCompileShader 앞에 놓이는 컴파일된 SPIR-V 캐시.
+// 셰이더 코드, 셰이더 타입, 컴파일 옵션, shaderc 버전의 해시를 키로 사용하므로
+// 이 중 하나라도 바뀌면 자연스럽게 다른 항목이 된다.
+// 메모리 캐시에 없으면 디렉토리의 파일을 mmap으로 읽고, 그래도 없을 때만 shaderc로 컴파일한다.
+class VkShaderCache {
+public:
+    // directory가 비어있으면 메모리 캐시만 사용한다.
+    explicit VkShaderCache(std::string directory = {});
+
+    VkShaderCache(const VkShaderCache &) = delete;
+    VkShaderCache &operator=(const VkShaderCache &) = delete;
+
+    VkResult compile(std::string_view shaderCode,
+                     VkShaderType shaderType,
+                     const VkShaderCompileOptions &shaderCompileOptions,
+                     std::vector<uint32_t> *shaderBinary);
+
+    VkShaderCacheStats stats() const;
+
+    static uint64_t makeKey(std::string_view shaderCode,
+                            VkShaderType shaderType,
+                            const VkShaderCompileOptions &shaderCompileOptions);
+
+private:
+    std::string makePath(uint64_t key) const;
+    bool load(uint64_t key, std::vector<uint32_t> *shaderBinary) const;
+    void store(uint64_t key, const std::vector<uint32_t> &shaderBinary) const;
+
+    std::string mDirectory;
+    mutable std::mutex mMutex;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> mShaderBinaries;
+    std::atomic<uint64_t> mMemoryHits{0};
+    std::atomic<uint64_t> mDiskHits{0};
+    std::atomic<uint64_t> mMisses{0};
+    std::atomic<int64_t> mCompileTime{0};
+};
+
+#endif //PRACTICE_VULKAN_VKSHADERCACHE_H
@@ -0,0 +1,246 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cassert>
+
+#include "VkSubAllocator.h"
+
+using namespace std;
+
+namespace {
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    alignment = max<VkDeviceSize>(alignment, 1);
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+unique_ptr<VkSubAllocator> VkSubAllocator::create(VkSubAllocatorType type, VkDeviceSize size) {
+    switch (type) {
+        case VK_SUB_ALLOCATOR_TYPE_LINEAR:
+            return make_unique<VkLinearSubAllocator>(size);
+        case VK_SUB_ALLOCATOR_TYPE_BUDDY:
+            return make_unique<VkBuddySubAllocator>(size);
+        case VK_SUB_ALLOCATOR_TYPE_FREE_LIST:
+            return make_unique<VkFreeListSubAllocator>(size);
+        default:
+            assert(false);
+            return nullptr;
+    }
+}
+
+// ================================================================================
+// VkLinearSubAllocator
+// ================================================================================
+bool VkLinearSubAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize *offset) {
+    auto alignedOffset = alignUp(mHead, alignment);
+    if (alignedOffset + size > mSize) {
+        return false;
+    }
+
+    *offset = alignedOffset;
+    mUsedSize += alignedOffset + size - mHead;
+    mHead = alignedOffset + size;
+    ++mAllocationCount;
+    return true;
+}
+
+void VkLinearSubAllocator::free(VkDeviceSize offset) {
+    assert(mAllocationCount > 0);
+
+    // 중간의 할당은 따로 재사용하지 않고, 모두 해제되면 처음부터 다시 사용한다.
+    if (--mAllocationCount == 0) {
+        mHead = 0;
+        mUsedSize = 0;
+    }
+}
+
+// ================================================================================
+// VkBuddySubAllocator
+// ================================================================================
+VkBuddySubAllocator::VkBuddySubAllocator(VkDeviceSize size)
+        : VkSubAllocator(size),
+          mMaxOrder(0) {
+    assert(size >= kMinBlockSize);
+
+    while (blockSize(mMaxOrder + 1) <= size) {
+        ++mMaxOrder;
+    }
+    mSize = blockSize(mMaxOrder);
+
+    mFreeBlocks.resize(mMaxOrder + 1);
+    mFreeBlocks[mMaxOrder].push_back(0);
+}
+
+bool VkBuddySubAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize *offset) {
+    // 블록의 오프셋은 항상 블록 크기의 배수이므로 블록이 alignment보다 크면 정렬도 맞는다.
+    auto requiredSize = max({size, alignment, kMinBlockSize});
+
+    uint32_t order = 0;
+    while (blockSize(order) < requiredSize) {
+        if (++order > mMaxOrder) {
+            return false;
+        }
+    }
+
+    // 요청한 크기 이상의 빈 블록 중 가장 작은 블록을 찾는다.
+    auto freeOrder = order;
+    while (freeOrder <= mMaxOrder && mFreeBlocks[freeOrder].empty()) {
+        ++freeOrder;
+    }
+    if (freeOrder > mMaxOrder) {
+        return false;
+    }
+
+    auto blockOffset = mFreeBlocks[freeOrder].back();
+    mFreeBlocks[freeOrder].pop_back();
+
+    // 필요한 크기가 될 때까지 반으로 나누고 나머지 반(buddy)은 빈 블록으로 돌려놓는다.
+    while (freeOrder > order) {
+        --freeOrder;
+        mFreeBlocks[freeOrder].push_back(blockOffset + blockSize(freeOrder));
+    }
+
+    mAllocatedOrders[blockOffset] = order;
+    mUsedSize += blockSize(order);
+    ++mAllocationCount;
+    *offset = blockOffset;
+    return true;
+}
+
+void VkBuddySubAllocator::free(VkDeviceSize offset) {
+    auto iter = mAllocatedOrders.find(offset);
+    assert(iter != mAllocatedOrders.end());
+
+    auto order = iter->second;
+    mAllocatedOrders.erase(iter);
+    mUsedSize -= blockSize(order);
+    --mAllocationCount;
+
+    // buddy도 비어있으면 합쳐서 한 단계 큰 블록으로 만든다.
+    while (order < mMaxOrder) {
+        auto buddyOffset = offset ^ blockSize(order);
+        auto &freeBlocks = mFreeBlocks[order];
+        auto buddy = find(freeBlocks.begin(), freeBlocks.end(), buddyOffset);
+        if (buddy == freeBlocks.end()) {
+            break;
+        }
+
+        freeBlocks.erase(buddy);
+        offset = min(offset, buddyOffset);
+        ++order;
+    }
+
+    mFreeBlocks[order].push_back(offset);
+}
+
+VkDeviceSize VkBuddySubAllocator::largestFreeRange() const {
+    for (auto order = static_cast<int32_t>(mMaxOrder); order >= 0; --order) {
+        if (!mFreeBlocks[order].empty()) {
+            return blockSize(order);
+        }
+    }
+    return 0;
+}
+
+// ================================================================================
+// VkFreeListSubAllocator
+// ================================================================================
+VkFreeListSubAllocator::VkFreeListSubAllocator(VkDeviceSize size)
+        : VkSubAllocator(size) {
+    mFreeRanges.emplace(0, size);
+}
+
+bool VkFreeListSubAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize *offset) {
+    // 들어갈 수 있는 빈 공간 중 가장 작은 공간을 사용해서 큰 공간이 쪼개지지 않도록 한다.
+    auto bestRange = mFreeRanges.end();
+    VkDeviceSize bestOffset = 0;
+    for (auto iter = mFreeRanges.begin(); iter != mFreeRanges.end(); ++iter) {
+        auto [begin, end] = *iter;
+        auto alignedOffset = alignUp(begin, alignment);
+        if (alignedOffset + size > end) {
+            continue;
+        }
+
+        if (bestRange == mFreeRanges.end() ||
+            end - begin < bestRange->second - bestRange->first) {
+            bestRange = iter;
+            bestOffset = alignedOffset;
+        }
+    }
+
+    if (bestRange == mFreeRanges.end()) {
+        return false;
+    }
+
+    // 정렬 때문에 생긴 앞쪽 여백도 할당에 포함시켜서 해제할 때 같이 돌려받는다.
+    Range range{bestRange->first, bestOffset + size};
+    auto freeEnd = bestRange->second;
+    mFreeRanges.erase(bestRange);
+    if (range.end != freeEnd) {
+        mFreeRanges.emplace(range.end, freeEnd);
+    }
+
+    mAllocatedRanges[bestOffset] = range;
+    mUsedSize += range.end - range.begin;
+    ++mAllocationCount;
+    *offset = bestOffset;
+    return true;
+}
+
+void VkFreeListSubAllocator::free(VkDeviceSize offset) {
+    auto iter = mAllocatedRanges.find(offset);
+    assert(iter != mAllocatedRanges.end());
+
+    auto range = iter->second;
+    mAllocatedRanges.erase(iter);
+    mUsedSize -= range.end - range.begin;
+    --mAllocationCount;
+
+    // 뒤쪽의 빈 공간과 합친다.
+    auto next = mFreeRanges.lower_bound(range.begin);
+    if (next != mFreeRanges.end() && next->first == range.end) {
+        range.end = next->second;
+        next = mFreeRanges.erase(next);
+    }
+
+    // 앞쪽의 빈 공간과 합친다.
+    if (next != mFreeRanges.begin()) {
+        auto prev = std::prev(next);
+        if (prev->second == range.begin) {
+            prev->second = range.end;
+            return;
+        }
+    }
+
+    mFreeRanges.emplace(range.begin, range.end);
+}
+
+VkDeviceSize VkFreeListSubAllocator::largestFreeRange() const {
+    VkDeviceSize largest = 0;
+    for (const auto &[begin, end] : mFreeRanges) {
+        largest = max(largest, end - begin);
+    }
+    return largest;
+}
@@ -0,0 +1,122 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKSUBALLOCATOR_H
+#define PRACTICE_VULKAN_VKSUBALLOCATOR_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// 하나의 VkDeviceMemory 블록 안에서 [offset, offset + size) 범위를 나눠주는 방법.
+typedef enum VkSubAllocatorType {
+    VK_SUB_ALLOCATOR_TYPE_LINEAR,    // 앞에서부터 차례대로 할당. 모두 해제되어야 다시 사용할 수 있다.
+    VK_SUB_ALLOCATOR_TYPE_BUDDY,     // 2의 거듭제곱 크기로 나누고 합친다. 빠르지만 내부 단편화가 있다.
+    VK_SUB_ALLOCATOR_TYPE_FREE_LIST  // 빈 공간 중 가장 잘 맞는 곳을 사용하고 해제되면 이웃과 합친다.
+} VkSubAllocatorType;
+
+// 블록 안의 오프셋만 관리하고 Vulkan 객체는 다루지 않는다.
+class VkSubAllocator {
+public:
+    explicit VkSubAllocator(VkDeviceSize size) : mSize(size) {}
+    virtual ~VkSubAllocator() = default;
+
+    // 성공하면 alignment에 맞춰진 오프셋을 offset에 쓴다.
+    virtual bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize *offset) = 0;
+
+    // allocate가 반환한 오프셋을 해제한다.
+    virtual void free(VkDeviceSize offset) = 0;
+
+    // 현재 사용할 수 있는 가장 큰 연속된 빈 공간의 크기.
+    virtual VkDeviceSize largestFreeRange() const = 0;
+
+    VkDeviceSize size() const { return mSize; }
+
+    // 정렬을 위한 여백 등을 포함해서 할당에 사용중인 크기.
+    VkDeviceSize usedSize() const { return mUsedSize; }
+
+    uint32_t allocationCount() const { return mAllocationCount; }
+
+    bool empty() const { return mAllocationCount == 0; }
+
+    static std::unique_ptr<VkSubAllocator> create(VkSubAllocatorType type, VkDeviceSize size);
+
+protected:
+    VkDeviceSize mSize;
+    VkDeviceSize mUsedSize{0};
+    uint32_t mAllocationCount{0};
+};
+
+class VkLinearSubAllocator : public VkSubAllocator {
+public:
+    explicit VkLinearSubAllocator(VkDeviceSize size) : VkSubAllocator(size) {}
+
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize *offset) override;
+    void free(VkDeviceSize offset) override;
+    VkDeviceSize largestFreeRange() const override { return mSize - mHead; }
+
+private:
+    VkDeviceSize mHead{0};
+};
+
+class VkBuddySubAllocator : public VkSubAllocator {
+public:
+    static constexpr VkDeviceSize kMinBlockSize = 256;
+
+    // size는 2의 거듭제곱이 아니면 내림해서 사용하고 size()도 내림한 크기다.
+    // VkMemoryAllocator는 buddy 블록을 2의 거듭제곱 크기로 할당하므로 버려지는 메모리가 없다.
+    explicit VkBuddySubAllocator(VkDeviceSize size);
+
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize *offset) override;
+    void free(VkDeviceSize offset) override;
+    VkDeviceSize largestFreeRange() const override;
+
+private:
+    VkDeviceSize blockSize(uint32_t order) const { return kMinBlockSize << order; }
+
+    uint32_t mMaxOrder;
+    std::vector<std::vector<VkDeviceSize>> mFreeBlocks; // order별 빈 블록의 오프셋
+    std::unordered_map<VkDeviceSize, uint32_t> mAllocatedOrders; // 오프셋 -> order
+};
+
+class VkFreeListSubAllocator : public VkSubAllocator {
+public:
+    explicit VkFreeListSubAllocator(VkDeviceSize size);
+
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize *offset) override;
+    void free(VkDeviceSize offset) override;
+    VkDeviceSize largestFreeRange() const override;
+
+private:
+    struct Range {
+        VkDeviceSize begin; // 정렬 여백을 포함한 시작 위치
+        VkDeviceSize end;
+    };
+
+    std::map<VkDeviceSize, VkDeviceSize> mFreeRanges;         // 시작 -> 끝, 시작 순으로 정렬
+    std::unordered_map<VkDeviceSize, Range> mAllocatedRanges; // 반환한 오프셋 -> 사용중인 범위
+};
+
+#endif //PRACTICE_VULKAN_VKSUBALLOCATOR_H
@@ -0,0 +1,175 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+#include "VkTrace.h"
+#include "AndroidOut.h"
+
+using namespace std;
+
+namespace {
+
+struct Entry {
+    const char *name;
+    uint64_t beginTime;
+    uint64_t endTime;
+};
+
+// 한 스레드만 쓰고 vkTraceCollect가 읽는 링 버퍼. 쓰는 쪽은 잠금 없이 head만 증가시킨다.
+struct Ring {
+    static constexpr uint64_t kCapacity = 4096;
+
+    array<Entry, kCapacity> entries;
+    atomic<uint64_t> head{0};
+    uint32_t tid;
+    string name;
+};
+
+// 스레드가 끝나도 기록된 구간을 읽을 수 있도록 링 버퍼는 프로세스가 끝날 때까지 유지한다.
+// 잠금은 스레드가 처음 기록할 때와 모을 때만 사용한다.
+mutex gRingMutex;
+vector<shared_ptr<Ring>> gRings;
+
+Ring &threadRing() {
+    thread_local shared_ptr<Ring> ring = [] {
+        auto ring = make_shared<Ring>();
+
+        lock_guard<mutex> lock(gRingMutex);
+        ring->tid = static_cast<uint32_t>(gRings.size());
+        ring->name = "Thread " + to_string(ring->tid);
+        gRings.push_back(ring);
+        return ring;
+    }();
+    return *ring;
+}
+
+} // namespace
+
+uint64_t vkTraceNow() {
+    return chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void vkTraceSetThreadName(const char *name) {
+    auto &ring = threadRing();
+
+    lock_guard<mutex> lock(gRingMutex);
+    ring.name = name;
+}
+
+void vkTraceCollect(vector<VkTraceEvent> *events, vector<VkTraceThread> *threads) {
+    lock_guard<mutex> lock(gRingMutex);
+
+    for (const auto &ring: gRings) {
+        threads->push_back({kVkTraceCpuPid, ring->tid, ring->name});
+
+        // ================================================================================
+        // 1. head 이전의 구간 복사
+        // ================================================================================
+        // head를 acquire로 읽으면 그 이전에 쓰여진 항목이 모두 보인다.
+        auto head = ring->head.load(memory_order_acquire);
+        auto begin = head > Ring::kCapacity ? head - Ring::kCapacity : 0;
+
+        vector<Entry> entries;
+        entries.reserve(head - begin);
+        for (auto i = begin; i != head; ++i) {
+            entries.push_back(ring->entries[i % Ring::kCapacity]);
+        }
+
+        // ================================================================================
+        // 2. 복사하는 동안 덮어써졌을 수 있는 항목은 버림
+        // ================================================================================
+        auto newHead = ring->head.load(memory_order_acquire);
+        auto validBegin = newHead > Ring::kCapacity ? newHead - Ring::kCapacity : 0;
+
+        for (auto i = max(begin, validBegin); i != head; ++i) {
+            const auto &entry = entries[i - begin];
+            events->push_back({
+                    .name = entry.name,
+                    .pid = kVkTraceCpuPid,
+                    .tid = ring->tid,
+                    .beginTime = entry.beginTime,
+                    .duration = entry.endTime - entry.beginTime
+            });
+        }
+    }
+}
+
+bool vkWriteChromeTrace(const string &path,
+                        const vector<VkTraceEvent> &events,
+                        const vector<VkTraceThread> &threads) {
+    ofstream file(path, ios::trunc);
+    if (!file) {
+        aout << "Failed to open " << path << " for writing." << endl;
+        return false;
+    }
+
+    // Trace Event Format의 ts, dur는 마이크로초 단위다.
+    file << fixed << setprecision(3);
+    file << "{\"traceEvents\":[";
+    file << "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << kVkTraceCpuPid
+         << ",\"args\":{\"name\":\"CPU\"}}";
+    file << ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << kVkTraceGpuPid
+         << ",\"args\":{\"name\":\"GPU\"}}";
+
+    for (const auto &thread: threads) {
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << thread.pid
+             << ",\"tid\":" << thread.tid << ",\"args\":{\"name\":\"" << thread.name << "\"}}";
+    }
+
+    for (const auto &event: events) {
+        file << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":" << event.pid
+             << ",\"tid\":" << event.tid
+             << ",\"ts\":" << event.beginTime / 1000.0
+             << ",\"dur\":" << event.duration / 1000.0;
+        if (event.frameNumber != UINT64_MAX) {
+            file << ",\"args\":{\"frame\":" << event.frameNumber << "}";
+        }
+        file << "}";
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return file.good();
+}
+
+VkTraceScope::VkTraceScope(const char *name)
+        : mName(name),
+          mBeginTime(vkTraceNow()) {
+}
+
+VkTraceScope::~VkTraceScope() {
+    auto endTime = vkTraceNow();
+    auto &ring = threadRing();
+
+    // 링 버퍼의 주인 스레드만 head를 바꾸므로 relaxed로 읽어도 된다.
+    auto head = ring.head.load(memory_order_relaxed);
+    ring.entries[head % Ring::kCapacity] = {mName, mBeginTime, endTime};
+    ring.head.store(head + 1, memory_order_release);
+}
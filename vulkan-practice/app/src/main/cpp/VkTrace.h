@@ -0,0 +1,89 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKTRACE_H
+#define PRACTICE_VULKAN_VKTRACE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Chrome Trace로 내보낼 하나의 구간. 시간의 단위는 나노초.
+struct VkTraceEvent {
+    std::string name;
+    uint32_t pid; // 0: CPU, 1: GPU
+    uint32_t tid;
+    uint64_t beginTime;
+    uint64_t duration;
+    uint64_t frameNumber{UINT64_MAX}; // 알 수 없으면 UINT64_MAX
+};
+
+struct VkTraceThread {
+    uint32_t pid;
+    uint32_t tid;
+    std::string name;
+};
+
+constexpr uint32_t kVkTraceCpuPid = 0;
+constexpr uint32_t kVkTraceGpuPid = 1;
+
+// CPU 구간에 사용하는 시계(steady_clock)의 현재 시간. 나노초.
+uint64_t vkTraceNow();
+
+// 현재 스레드의 이름을 지정한다. 트레이스에서 스레드를 구분할 때 사용된다.
+void vkTraceSetThreadName(const char *name);
+
+// 모든 스레드의 링 버퍼에 남아있는 CPU 구간을 모은다. 기록중인 스레드를 멈추지 않는다.
+void vkTraceCollect(std::vector<VkTraceEvent> *events, std::vector<VkTraceThread> *threads);
+
+// Trace Event Format의 JSON 파일로 저장한다. chrome://tracing이나 Perfetto에서 열 수 있다.
+bool vkWriteChromeTrace(const std::string &path,
+                        const std::vector<VkTraceEvent> &events,
+                        const std::vector<VkTraceThread> &threads);
+
+// 생성될 때부터 파괴될 때까지를 하나의 구간으로 현재 스레드의 링 버퍼에 기록한다.
+// name은 복사하지 않으므로 문자열 리터럴이어야 한다.
+class VkTraceScope {
+public:
+    explicit VkTraceScope(const char *name);
+    ~VkTraceScope();
+
+    VkTraceScope(const VkTraceScope &) = delete;
+    VkTraceScope &operator=(const VkTraceScope &) = delete;
+
+private:
+    const char *mName;
+    uint64_t mBeginTime;
+};
+
+// VK_CPU_TRACE가 정의되지 않으면 아무 코드도 생성되지 않는다.
+#ifdef VK_CPU_TRACE
+#define VK_TRACE_CONCAT_IMPL(a, b) a##b
+#define VK_TRACE_CONCAT(a, b) VK_TRACE_CONCAT_IMPL(a, b)
+#define VK_TRACE_SCOPE(name) VkTraceScope VK_TRACE_CONCAT(vkTraceScope, __LINE__)(name)
+#define VK_TRACE_THREAD_NAME(name) vkTraceSetThreadName(name)
+#else
+#define VK_TRACE_SCOPE(name) do {} while (0)
+#define VK_TRACE_THREAD_NAME(name) do {} while (0)
+#endif
+
+#endif //PRACTICE_VULKAN_VKTRACE_H
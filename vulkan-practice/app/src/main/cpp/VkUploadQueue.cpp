@@ -0,0 +1,366 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "VkUploadQueue.h"
+#include "VkUtil.h"
+
+using namespace std;
+
+namespace {
+
+// vkCmdCopyBuffer의 srcOffset은 정렬이 필요 없지만 정렬되어 있으면 더 빠르게 복사하는 GPU가 있다.
+constexpr VkDeviceSize kStagingAlignment = 16;
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+VkUploadQueue::VkUploadQueue(VkDevice device,
+                             VkMemoryAllocator *memoryAllocator,
+                             VkDeviceQueues *deviceQueues,
+                             VkDeviceSize stagingSize)
+        : mDevice(device),
+          mMemoryAllocator(memoryAllocator),
+          mDeviceQueues(deviceQueues),
+          mTransferQueueFamilyIndex(deviceQueues->familyIndex(VK_QUEUE_TYPE_TRANSFER)),
+          mGraphicsQueueFamilyIndex(deviceQueues->familyIndex(VK_QUEUE_TYPE_GRAPHICS)),
+          mStagingSize(alignUp(stagingSize, kStagingAlignment)) {
+    // ================================================================================
+    // 1. transfer 큐 패밀리의 VkCommandPool 생성
+    // ================================================================================
+    VkCommandPoolCreateInfo commandPoolCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+                     VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+            .queueFamilyIndex = mTransferQueueFamilyIndex
+    };
+
+    VK_CHECK_ERROR(vkCreateCommandPool(mDevice, &commandPoolCreateInfo, nullptr, &mCommandPool));
+
+    // ================================================================================
+    // 2. 스테이징 VkBuffer 생성
+    // ================================================================================
+    VkBufferCreateInfo bufferCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size = mStagingSize,
+            .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+    };
+
+    VkAllocationCreateInfo allocationCreateInfo{
+            .memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                   VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    };
+
+    VK_CHECK_ERROR(mMemoryAllocator->createBuffer(bufferCreateInfo,
+                                                  allocationCreateInfo,
+                                                  &mStagingBuffer,
+                                                  &mStagingAllocation));
+}
+
+VkUploadQueue::~VkUploadQueue() {
+    {
+        lock_guard<mutex> lock(mMutex);
+
+        if (mRecording) {
+            submitBatch();
+        }
+        retireBatches(true, mLastTicket);
+    }
+
+    vkDestroyCommandPool(mDevice, mCommandPool, nullptr);
+    mMemoryAllocator->destroyBuffer(mStagingBuffer, &mStagingAllocation);
+}
+
+VkUploadTicket VkUploadQueue::upload(VkBuffer buffer,
+                                     VkDeviceSize offset,
+                                     const void *data,
+                                     VkDeviceSize size,
+                                     VkPipelineStageFlags dstStageMask,
+                                     VkAccessFlags dstAccessMask) {
+    lock_guard<mutex> lock(mMutex);
+
+    auto bytes = static_cast<const uint8_t *>(data);
+    for (VkDeviceSize copied = 0; copied != size;) {
+        auto chunkSize = min(size - copied, mStagingSize);
+
+        // ================================================================================
+        // 1. 스테이징 버퍼의 공간 확보
+        // ================================================================================
+        // 공간이 부족하면 기록중인 배치를 제출하고 가장 오래된 배치가 끝날 때까지 기다린다.
+        if (!mRecording) {
+            beginBatch();
+        }
+
+        VkDeviceSize stagingOffset;
+        while (!reserve(chunkSize, &stagingOffset)) {
+            submitBatch();
+            assert(!mSubmittedBatches.empty());
+            retireBatches(true, mSubmittedBatches.front().ticket);
+            beginBatch();
+        }
+
+        // ================================================================================
+        // 2. 스테이징 버퍼에 데이터 복사
+        // ================================================================================
+        memcpy(static_cast<uint8_t *>(mStagingAllocation.mappedData) + stagingOffset,
+               bytes + copied,
+               chunkSize);
+
+        // ================================================================================
+        // 3. VkBuffer로 복사하는 명령 기록
+        // ================================================================================
+        VkBufferCopy bufferCopy{
+                .srcOffset = stagingOffset,
+                .dstOffset = offset + copied,
+                .size = chunkSize
+        };
+        vkCmdCopyBuffer(mBatch.commandBuffer, mStagingBuffer, buffer, 1, &bufferCopy);
+
+        mBatch.barriers.push_back({
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                .dstAccessMask = dstAccessMask,
+                .buffer = buffer,
+                .offset = offset + copied,
+                .size = chunkSize
+        });
+        mBatch.dstStageMask |= dstStageMask;
+
+        copied += chunkSize;
+    }
+
+    return mBatch.ticket;
+}
+
+void VkUploadQueue::flush() {
+    lock_guard<mutex> lock(mMutex);
+
+    if (mRecording) {
+        submitBatch();
+    }
+}
+
+bool VkUploadQueue::isComplete(VkUploadTicket ticket) {
+    lock_guard<mutex> lock(mMutex);
+
+    retireBatches(false, 0);
+    return ticket <= mCompletedTicket;
+}
+
+void VkUploadQueue::wait(VkUploadTicket ticket) {
+    lock_guard<mutex> lock(mMutex);
+
+    if (mRecording && ticket >= mBatch.ticket) {
+        submitBatch();
+    }
+    retireBatches(true, ticket);
+}
+
+optional<VkQueueWait> VkUploadQueue::recordAcquireBarriers(VkCommandBuffer commandBuffer) {
+    lock_guard<mutex> lock(mMutex);
+
+    if (mAcquireBarriers.empty()) {
+        return nullopt;
+    }
+
+    // graphics 큐가 transfer 단계에서 배치의 semaphore를 기다리므로 배리어의 srcStageMask도 transfer 단계로 해야
+    // semaphore의 기다림과 배리어가 이어진다. 같은 큐에서 복사했으면 transfer 단계의 쓰기를 기다린다.
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         mAcquireStageMask,
+                         0,
+                         0, nullptr,
+                         static_cast<uint32_t>(mAcquireBarriers.size()), mAcquireBarriers.data(),
+                         0, nullptr);
+
+    mAcquireBarriers.clear();
+    mAcquireStageMask = 0;
+
+    // timeline semaphore의 값은 이전 배치도 포함하므로 마지막 배치만 기다리면 된다.
+    return VkQueueWait{mAcquireTicket, VK_PIPELINE_STAGE_TRANSFER_BIT};
+}
+
+bool VkUploadQueue::reserve(VkDeviceSize size, VkDeviceSize *offset) {
+    size = alignUp(size, kStagingAlignment);
+
+    if (mStagingUsed == 0) {
+        mStagingHead = mStagingTail = 0;
+    }
+
+    VkDeviceSize wasted = 0;
+    if (mStagingHead >= mStagingTail && !(mStagingHead == mStagingTail && mStagingUsed != 0)) {
+        // 빈 공간이 [head, end)와 [0, tail) 두 곳에 있다.
+        if (mStagingHead + size <= mStagingSize) {
+            *offset = mStagingHead;
+        } else if (size <= mStagingTail) {
+            wasted = mStagingSize - mStagingHead; // 끝에 남은 공간은 버리고 처음부터 사용한다.
+            *offset = 0;
+        } else {
+            return false;
+        }
+    } else {
+        // 빈 공간이 [head, tail) 한 곳에 있다.
+        if (mStagingHead + size <= mStagingTail) {
+            *offset = mStagingHead;
+        } else {
+            return false;
+        }
+    }
+
+    mStagingHead = *offset + size;
+    mStagingUsed += wasted + size;
+    mBatch.stagingEnd = mStagingHead;
+    mBatch.stagingSize += wasted + size;
+
+    return true;
+}
+
+void VkUploadQueue::beginBatch() {
+    assert(!mRecording);
+
+    // ================================================================================
+    // 1. 재사용할 배치가 없으면 VkCommandBuffer 할당
+    // ================================================================================
+    if (mFreeBatches.empty()) {
+        Batch batch{};
+
+        VkCommandBufferAllocateInfo commandBufferAllocateInfo{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .commandPool = mCommandPool,
+                .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                .commandBufferCount = 1
+        };
+        VK_CHECK_ERROR(vkAllocateCommandBuffers(mDevice, &commandBufferAllocateInfo, &batch.commandBuffer));
+
+        mFreeBatches.push_back(std::move(batch));
+    }
+
+    mBatch = std::move(mFreeBatches.back());
+    mFreeBatches.pop_back();
+    mBatch.ticket = ++mLastTicket;
+    mBatch.stagingEnd = mStagingHead;
+    mBatch.stagingSize = 0;
+    mBatch.barriers.clear();
+    mBatch.dstStageMask = 0;
+
+    // ================================================================================
+    // 2. VkCommandBuffer 기록 시작
+    // ================================================================================
+    VkCommandBufferBeginInfo commandBufferBeginInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+    };
+    VK_CHECK_ERROR(vkBeginCommandBuffer(mBatch.commandBuffer, &commandBufferBeginInfo));
+
+    mRecording = true;
+}
+
+void VkUploadQueue::submitBatch() {
+    assert(mRecording);
+
+    // ================================================================================
+    // 1. 소유권을 graphics 큐 패밀리로 넘기는 release 배리어 기록
+    // ================================================================================
+    if (dedicatedTransferQueue() && !mBatch.barriers.empty()) {
+        auto releaseBarriers = mBatch.barriers;
+        for (auto &barrier: releaseBarriers) {
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = 0; // release에서는 무시된다.
+            barrier.srcQueueFamilyIndex = mTransferQueueFamilyIndex;
+            barrier.dstQueueFamilyIndex = mGraphicsQueueFamilyIndex;
+        }
+
+        vkCmdPipelineBarrier(mBatch.commandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0,
+                             0, nullptr,
+                             static_cast<uint32_t>(releaseBarriers.size()), releaseBarriers.data(),
+                             0, nullptr);
+    }
+
+    VK_CHECK_ERROR(vkEndCommandBuffer(mBatch.commandBuffer));
+
+    // ================================================================================
+    // 2. transfer 큐에 제출
+    // ================================================================================
+    VkSubmitInfo submitInfo{
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &mBatch.commandBuffer
+    };
+    mBatch.queueTicket = mDeviceQueues->submit(VK_QUEUE_TYPE_TRANSFER, submitInfo);
+
+    // ================================================================================
+    // 3. graphics 큐에서 기록할 acquire 배리어 준비
+    // ================================================================================
+    // 배리어를 기록한 graphics 큐의 제출이 이 배치를 기다리므로 배치가 끝나기 전에 기록해도 된다.
+    for (auto barrier: mBatch.barriers) {
+        if (dedicatedTransferQueue()) {
+            barrier.srcAccessMask = 0; // acquire에서는 무시된다.
+            barrier.srcQueueFamilyIndex = mTransferQueueFamilyIndex;
+            barrier.dstQueueFamilyIndex = mGraphicsQueueFamilyIndex;
+        } else {
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        }
+        mAcquireBarriers.push_back(barrier);
+    }
+    mAcquireStageMask |= mBatch.dstStageMask;
+    mAcquireTicket = mBatch.queueTicket;
+
+    mSubmittedBatches.push_back(std::move(mBatch));
+    mBatch = {};
+    mRecording = false;
+}
+
+void VkUploadQueue::retireBatches(bool wait, VkUploadTicket ticket) {
+    while (!mSubmittedBatches.empty()) {
+        auto &batch = mSubmittedBatches.front();
+
+        if (wait && batch.ticket <= ticket) {
+            mDeviceQueues->wait(batch.queueTicket);
+        } else if (!mDeviceQueues->isComplete(batch.queueTicket)) {
+            break;
+        }
+
+        // ================================================================================
+        // 1. 스테이징 버퍼 공간 반환
+        // ================================================================================
+        mStagingTail = batch.stagingEnd;
+        mStagingUsed -= batch.stagingSize;
+        mCompletedTicket = batch.ticket;
+
+        // ================================================================================
+        // 2. 배치 재사용
+        // ================================================================================
+        VK_CHECK_ERROR(vkResetCommandBuffer(batch.commandBuffer, 0));
+        mFreeBatches.push_back(std::move(batch));
+        mSubmittedBatches.pop_front();
+    }
+}
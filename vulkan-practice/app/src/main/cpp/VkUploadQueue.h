@@ -0,0 +1,122 @@
+// MIT License
+//
+// Copyright (c) 2024 Daemyung Jang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PRACTICE_VULKAN_VKUPLOADQUEUE_H
+#define PRACTICE_VULKAN_VKUPLOADQUEUE_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "VkDeviceQueues.h"
+#include "VkMemoryAllocator.h"
+
+// 업로드가 끝났는지 확인할 때 사용하는 번호. 제출된 순서대로 증가한다.
+typedef uint64_t VkUploadTicket;
+
+// 링 형태의 스테이징 버퍼에 데이터를 복사해두고 vkCmdCopyBuffer를 모아서 DEVICE_LOCAL 버퍼로 업로드한다.
+// 전용 transfer 큐 패밀리가 있으면 그 큐에서 복사하고, 버퍼의 소유권을 graphics 큐 패밀리로 넘긴다.
+// acquire 배리어를 기록한 graphics 큐의 제출이 배치를 semaphore로 기다리므로 CPU에서 업로드가 끝나기를 기다리지 않아도 된다.
+class VkUploadQueue {
+public:
+    static constexpr VkDeviceSize kDefaultStagingSize = 8 * 1024 * 1024;
+
+    VkUploadQueue(VkDevice device,
+                  VkMemoryAllocator *memoryAllocator,
+                  VkDeviceQueues *deviceQueues,
+                  VkDeviceSize stagingSize = kDefaultStagingSize);
+    ~VkUploadQueue();
+
+    VkUploadQueue(const VkUploadQueue &) = delete;
+    VkUploadQueue &operator=(const VkUploadQueue &) = delete;
+
+    // data를 스테이징 버퍼에 복사하고 buffer로의 복사를 현재 배치에 기록한다.
+    // 복사된 데이터는 dstStageMask, dstAccessMask에서 사용된다. buffer는 EXCLUSIVE로 생성되어야 한다.
+    // 스테이징 버퍼보다 큰 데이터는 나눠서 복사하며, 공간이 부족하면 이전 배치가 끝날 때까지 기다린다.
+    VkUploadTicket upload(VkBuffer buffer,
+                          VkDeviceSize offset,
+                          const void *data,
+                          VkDeviceSize size,
+                          VkPipelineStageFlags dstStageMask,
+                          VkAccessFlags dstAccessMask);
+
+    // 현재 배치를 transfer 큐에 제출한다. 기록된 복사가 없으면 아무것도 하지 않는다.
+    // 복사된 데이터는 recordAcquireBarriers로 배리어를 기록한 graphics 큐의 제출에서 사용한다.
+    void flush();
+
+    // 기다리지 않고 업로드가 끝났는지 확인한다.
+    bool isComplete(VkUploadTicket ticket);
+
+    // 업로드가 끝날 때까지 기다린다. 아직 제출되지 않은 배치이면 먼저 제출한다.
+    void wait(VkUploadTicket ticket);
+
+    // 제출된 업로드의 데이터를 graphics 큐에서 사용할 수 있도록 배리어를 기록한다.
+    // 큐 패밀리가 다르면 소유권을 가져오는 acquire 배리어가 된다. 업로드한 버퍼를 사용하는 command buffer의 앞에서 호출한다.
+    // 배리어를 기록했으면 기다려야 할 배치를 반환한다. command buffer를 graphics 큐에 제출할 때 VkDeviceQueues::submit에 넘긴다.
+    std::optional<VkQueueWait> recordAcquireBarriers(VkCommandBuffer commandBuffer);
+
+    bool dedicatedTransferQueue() const { return mDeviceQueues->dedicated(VK_QUEUE_TYPE_TRANSFER); }
+
+private:
+    struct Batch {
+        VkCommandBuffer commandBuffer;
+        VkQueueTicket queueTicket; // transfer 큐에 제출한 ticket
+        VkUploadTicket ticket;
+        VkDeviceSize stagingEnd;  // 이 배치가 끝나면 스테이징 버퍼의 tail이 이동할 위치
+        VkDeviceSize stagingSize; // 이 배치가 사용한 스테이징 버퍼의 크기. 링을 돌면서 버린 공간을 포함한다.
+        std::vector<VkBufferMemoryBarrier> barriers;
+        VkPipelineStageFlags dstStageMask;
+    };
+
+    bool reserve(VkDeviceSize size, VkDeviceSize *offset);
+    void beginBatch();
+    void submitBatch();
+    void retireBatches(bool wait, VkUploadTicket ticket);
+
+    VkDevice mDevice;
+    VkMemoryAllocator *mMemoryAllocator;
+    VkDeviceQueues *mDeviceQueues;
+    uint32_t mTransferQueueFamilyIndex;
+    uint32_t mGraphicsQueueFamilyIndex;
+    VkCommandPool mCommandPool;
+    VkBuffer mStagingBuffer;
+    VkAllocation mStagingAllocation;
+    VkDeviceSize mStagingSize;
+    VkDeviceSize mStagingHead{0};
+    VkDeviceSize mStagingTail{0};
+    VkDeviceSize mStagingUsed{0};
+    std::mutex mMutex;
+    Batch mBatch{};                    // 기록중인 배치
+    bool mRecording{false};
+    std::deque<Batch> mSubmittedBatches; // 제출된 순서대로 정렬
+    std::vector<Batch> mFreeBatches;
+    std::vector<VkBufferMemoryBarrier> mAcquireBarriers;
+    VkPipelineStageFlags mAcquireStageMask{0};
+    VkQueueTicket mAcquireTicket{}; // mAcquireBarriers를 release한 배치 중 마지막 배치의 ticket
+    VkUploadTicket mLastTicket{0};
+    VkUploadTicket mCompletedTicket{0};
+};
+
+#endif //PRACTICE_VULKAN_VKUPLOADQUEUE_H
@@ -25,15 +25,16 @@
 
 #include <string_view>
 #include <string>
+#include <utility>
 #include <vector>
 #include <random>
 #include <vulkan/vulkan.h>
+#ifdef VK_RUNTIME_SHADER_COMPILE
 #include <shaderc/shaderc.hpp>
+#endif
 
 #include "AndroidOut.h"
 
-#ifndef NDEBUG
-
 inline std::string vkToString(VkResult vkResult) {
     switch (vkResult) {
         case VK_SUCCESS:
@@ -117,6 +118,7 @@ inline std::string vkToString(VkResult vkResult) {
     }
 }
 
+#ifndef NDEBUG
 #define VK_CHECK_ERROR(vkFunction)                                                     \
     do {                                                                               \
         if (auto vkResult = vkFunction; vkResult != VK_SUCCESS) {                      \
@@ -127,10 +129,25 @@ inline std::string vkToString(VkResult vkResult) {
 #else
 #define VK_CHECK_ERROR(vkFunction)                                                     \
     do {                                                                               \
-        vkFunction                                                                     \
+        vkFunction;                                                                    \
     } while (0)
 #endif
 
+inline std::string_view vkToString(VkPresentModeKHR presentMode) {
+    switch (presentMode) {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR:
+            return "Immediate";
+        case VK_PRESENT_MODE_MAILBOX_KHR:
+            return "Mailbox";
+        case VK_PRESENT_MODE_FIFO_KHR:
+            return "FIFO";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+            return "FIFO Relaxed";
+        default:
+            return "Unknown";
+    }
+}
+
 inline std::string_view vkToString(VkPhysicalDeviceType physicalDeviceType) {
     switch (physicalDeviceType) {
         case VK_PHYSICAL_DEVICE_TYPE_OTHER:
@@ -148,13 +165,23 @@ inline std::string_view vkToString(VkPhysicalDeviceType physicalDeviceType) {
     }
 }
 
+#ifdef VK_RUNTIME_SHADER_COMPILE
+// 실행 중에 셰이더를 컴파일하는 개발 모드에서만 사용한다.
+// 배포 빌드에서는 셰이더가 빌드할 때 SPIR-V로 컴파일되어 들어가므로 shaderc가 필요 없다.
 typedef enum VkShaderType {
     VK_SHADER_TYPE_VERTEX = shaderc_vertex_shader,
     VK_SHADER_TYPE_FRAGMENT = shaderc_fragment_shader
 } VkShaderType;
 
+// 셰이더 컴파일 옵션. 컴파일된 SPIR-V 캐시의 키에도 포함된다.
+struct VkShaderCompileOptions {
+    bool optimize = false; // shaderc의 성능 최적화 사용 여부
+    std::vector<std::pair<std::string, std::string>> macroDefinitions;
+};
+
 inline VkResult
 vkCompileShader(std::string_view shaderCode, VkShaderType shaderType,
+                const VkShaderCompileOptions &shaderCompileOptions,
                 std::vector<uint32_t> *shaderBinary) {
     std::random_device device;
     std::mt19937 generator(device());
@@ -165,11 +192,20 @@ vkCompileShader(std::string_view shaderCode, VkShaderType shaderType,
         tag[i] = static_cast<char>(distribution(generator));
     }
 
+    shaderc::CompileOptions options;
+    if (shaderCompileOptions.optimize) {
+        options.SetOptimizationLevel(shaderc_optimization_level_performance);
+    }
+    for (const auto &[name, value] : shaderCompileOptions.macroDefinitions) {
+        options.AddMacroDefinition(name, value);
+    }
+
     shaderc::Compiler compiler;
     auto result = compiler.CompileGlslToSpv(shaderCode.data(),
                                             shaderCode.size(),
                                             static_cast<shaderc_shader_kind>(shaderType),
-                                            tag.c_str());
+                                            tag.c_str(),
+                                            options);
 
     if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
         aout << result.GetErrorMessage() << std::endl;
@@ -180,6 +216,13 @@ vkCompileShader(std::string_view shaderCode, VkShaderType shaderType,
     return VK_SUCCESS;
 }
 
+inline VkResult
+vkCompileShader(std::string_view shaderCode, VkShaderType shaderType,
+                std::vector<uint32_t> *shaderBinary) {
+    return vkCompileShader(shaderCode, shaderType, {}, shaderBinary);
+}
+#endif
+
 inline VkResult
 vkGetMemoryTypeIndex(const VkPhysicalDeviceMemoryProperties &physicalDeviceMemoryProperties,
                      const VkMemoryRequirements &memoryRequirements,
@@ -0,0 +1,48 @@
+####################################################################################################
+# 셰이더를 C++ 헤더로 변환한다.
+#
+# cmake -DINPUT=<파일> -DOUTPUT=<헤더> -DNAME=<변수 이름> -DMODE=<SPIRV|GLSL> -P EmbedShader.cmake
+#
+# SPIRV: SPIR-V 바이너리를 constexpr uint32_t 배열로 만든다.
+# GLSL:  GLSL 코드를 constexpr std::string_view로 만든다. 실행 중에 컴파일하는 개발 모드에서 사용한다.
+####################################################################################################
+get_filename_component(SOURCE_NAME ${INPUT} NAME)
+
+if (MODE STREQUAL "SPIRV")
+    file(READ ${INPUT} CONTENTS HEX)
+
+    string(LENGTH "${CONTENTS}" CONTENTS_LENGTH)
+    math(EXPR REMAINDER "${CONTENTS_LENGTH} % 8")
+    if (CONTENTS_LENGTH EQUAL 0 OR NOT REMAINDER EQUAL 0)
+        message(FATAL_ERROR "${INPUT} is not a valid SPIR-V binary.")
+    endif ()
+
+    # SPIR-V는 리틀 엔디안 32비트 워드의 배열이다.
+    string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1, " WORDS "${CONTENTS}")
+    # CMake 정규식은 {n} 반복을 지원하지 않으므로 한 줄에 8개의 워드를 직접 나열한다.
+    set(LINE_PATTERN "(0x[0-9a-f]+, 0x[0-9a-f]+, 0x[0-9a-f]+, 0x[0-9a-f]+, 0x[0-9a-f]+, 0x[0-9a-f]+, 0x[0-9a-f]+, 0x[0-9a-f]+,) ")
+    string(REGEX REPLACE "${LINE_PATTERN}" "\\1\n        " WORDS "${WORDS}")
+    string(STRIP "${WORDS}" WORDS)
+
+    file(WRITE ${OUTPUT}
+            "// ${SOURCE_NAME}에서 생성된 파일입니다. 직접 수정하지 마세요.\n"
+            "#pragma once\n"
+            "\n"
+            "#include <cstdint>\n"
+            "\n"
+            "constexpr uint32_t ${NAME}[] = {\n"
+            "        ${WORDS}\n"
+            "};\n")
+elseif (MODE STREQUAL "GLSL")
+    file(READ ${INPUT} CONTENTS)
+
+    file(WRITE ${OUTPUT}
+            "// ${SOURCE_NAME}에서 생성된 파일입니다. 직접 수정하지 마세요.\n"
+            "#pragma once\n"
+            "\n"
+            "#include <string_view>\n"
+            "\n"
+            "constexpr std::string_view ${NAME}{R\"glsl(${CONTENTS})glsl\"};\n")
+else ()
+    message(FATAL_ERROR "Unknown MODE: ${MODE}")
+endif ()
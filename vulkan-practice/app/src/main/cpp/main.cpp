@@ -1,13 +1,21 @@
 #include <game-activity/GameActivity.cpp>
 #include <game-text-input/gametextinput.cpp>
 
+#include "VkFramePacer.h"
 #include "VkRenderer.h"
+#include "VkTrace.h"
+#include "VkUtil.h"
 #include "AndroidOut.h"
 
+using namespace std;
+
 extern "C" {
 
 #include <game-activity/native_app_glue/android_native_app_glue.c>
 
+// 일시정지 중에는 창이 남아있어도 그리지 않는다.
+static bool gPaused = false;
+
 /*!
  * Handles commands sent to this Android application
  * @param pApp the app the commands are coming from
@@ -16,7 +24,24 @@ extern "C" {
 void handle_cmd(android_app *pApp, int32_t cmd) {
     switch (cmd) {
         case APP_CMD_INIT_WINDOW:
-            pApp->userData = new VkRenderer();
+            pApp->userData = new VkRenderer(pApp->window, {
+                    .pipelineCachePath = string(pApp->activity->internalDataPath) + "/pipeline_cache.bin",
+                    .shaderCacheDirectory = string(pApp->activity->internalDataPath) + "/shader_cache",
+                    .tracePath = string(pApp->activity->internalDataPath) + "/trace.json"
+            });
+            break;
+        case APP_CMD_WINDOW_RESIZED:
+        case APP_CMD_CONFIG_CHANGED:
+            // 창의 크기나 화면 방향이 바뀌면 다음 프레임에서 스왑체인을 다시 만든다.
+            if (pApp->userData) {
+                static_cast<VkRenderer *>(pApp->userData)->invalidateSwapchain();
+            }
+            break;
+        case APP_CMD_PAUSE:
+            gPaused = true;
+            break;
+        case APP_CMD_RESUME:
+            gPaused = false;
             break;
         case APP_CMD_TERM_WINDOW:
             if (pApp->userData) {
@@ -44,6 +69,57 @@ bool motion_event_filter_func(const GameActivityMotionEvent *motionEvent) {
             sourceClass == AINPUT_SOURCE_CLASS_JOYSTICK);
 }
 
+#ifdef VK_PRESENT_BENCHMARK
+/*!
+ * 출력 방식을 하나씩 바꿔가며 프레임 시간과 지연 시간을 측정한다.
+ * 각 방식마다 스왑체인이 안정될 때까지 기다린 후 측정하고 결과를 로그로 출력한다.
+ */
+class PresentBenchmark {
+public:
+    void update(VkRenderer *renderer) {
+        if (mCaseIndex == kCases.size()) {
+            return;
+        }
+
+        if (mFrameCount == 0) {
+            renderer->setPresentConfig(kCases[mCaseIndex]);
+        } else if (mFrameCount == kWarmUpFrameCount) {
+            renderer->resetPresentStats();
+        } else if (mFrameCount == kWarmUpFrameCount + kMeasureFrameCount) {
+            auto stats = renderer->presentStats();
+            aout << "PresentBenchmark: " << vkToString(stats.presentMode)
+                 << (kCases[mCaseIndex].lowLatency ? " (low latency)" : "")
+                 << ", images: " << stats.imageCount
+                 << ", frame time: " << stats.frameTime << "ms"
+                 << ", latency: " << stats.latency << "ms (" << stats.latencySampleCount << " samples)" << endl;
+
+            ++mCaseIndex;
+            mFrameCount = 0;
+            return;
+        }
+
+        ++mFrameCount;
+    }
+
+private:
+    static constexpr uint32_t kWarmUpFrameCount = 60;
+    static constexpr uint32_t kMeasureFrameCount = 300;
+    static constexpr std::array<VkPresentConfig, 8> kCases{{
+            {.presentMode = VK_PRESENT_MODE_FIFO_KHR},
+            {.presentMode = VK_PRESENT_MODE_FIFO_KHR, .lowLatency = true},
+            {.presentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR},
+            {.presentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR, .lowLatency = true},
+            {.presentMode = VK_PRESENT_MODE_MAILBOX_KHR},
+            {.presentMode = VK_PRESENT_MODE_MAILBOX_KHR, .lowLatency = true},
+            {.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR},
+            {.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR, .lowLatency = true}
+    }};
+
+    size_t mCaseIndex{0};
+    uint32_t mFrameCount{0};
+};
+#endif
+
 /*!
  * This the main entry point for a native activity
  */
@@ -56,19 +132,53 @@ void android_main(struct android_app *pApp) {
     // implemented in android_native_app_glue.c.
     android_app_set_motion_event_filter(pApp, motion_event_filter_func);
 
+    VK_TRACE_THREAD_NAME("Main");
+
+    // 디스플레이 주기에 맞춰 프레임을 시작한다.
+    VkSteadyFrameClock frameClock;
+    VkFramePacer framePacer(&frameClock);
+
+#ifdef VK_PRESENT_BENCHMARK
+    PresentBenchmark presentBenchmark;
+#endif
+
     // This sets up a typical game/event loop. It will run until the app is destroyed.
     int events;
     android_poll_source *pSource;
     do {
+        VK_TRACE_SCOPE("Loop");
+
         // Process all pending events before running game logic.
-        if (ALooper_pollAll(0, nullptr, &events, (void **) &pSource) >= 0) {
-            if (pSource) {
-                pSource->process(pApp, pSource);
+        {
+            VK_TRACE_SCOPE("PollEvents");
+
+            // 창이 없거나 일시정지 중이면 그릴 것이 없으므로 다음 이벤트가 올 때까지 루퍼에서 잠든다.
+            while (ALooper_pollAll(pApp->userData && !gPaused ? 0 : -1, nullptr, &events, (void **) &pSource) >= 0) {
+                if (pSource) {
+                    pSource->process(pApp, pSource);
+                }
+                if (pApp->destroyRequested) {
+                    break;
+                }
             }
         }
 
         // Check if any user data is associated. This is assigned in handle_cmd
-        if (pApp->userData) {
+        auto renderer = static_cast<VkRenderer *>(pApp->userData);
+        if (renderer && !gPaused) {
+#ifdef VK_PRESENT_BENCHMARK
+            // 출력 방식 자체의 처리량을 측정해야 하므로 프레임 간격을 조절하지 않는다.
+            presentBenchmark.update(renderer);
+            renderer->render();
+#else
+            framePacer.beginFrame();
+            renderer->render();
+            framePacer.endFrame();
+            // 디스플레이가 알려준 주기가 있으면 present 간격으로 추정한 값 대신 사용한다.
+            framePacer.setRefreshDuration(renderer->presentStats().refreshDuration);
+#endif
+        } else {
+            framePacer.reset();
         }
     } while (!pApp->destroyRequested);
 }
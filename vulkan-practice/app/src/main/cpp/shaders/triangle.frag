@@ -0,0 +1,21 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec3 inColor;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) flat in uint inMaterialIndex;
+
+layout(location = 0) out vec4 outColor;
+
+// VkBindlessHeap의 set 0. 모든 텍스처와 스토리지 버퍼가 하나의 배열에 있고 인덱스로 접근한다.
+layout(set = 0, binding = 0) uniform texture2D textures[];
+layout(set = 0, binding = 1) readonly buffer StorageBuffer {
+    uint data[];
+} storageBuffers[];
+layout(set = 0, binding = 2) uniform sampler textureSampler;
+
+void main() {
+    // 인스턴스마다 다른 텍스처를 사용할 수 있으므로 인덱스가 균일하지 않다고 알려준다.
+    vec4 texel = texture(sampler2D(textures[nonuniformEXT(inMaterialIndex)], textureSampler), inTexCoord);
+    outColor = vec4(inColor, 1.0) * texel;
+}
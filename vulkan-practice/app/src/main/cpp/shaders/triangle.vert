@@ -0,0 +1,48 @@
+#version 310 es
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inInstanceOffset;
+layout(location = 3) in float inInstanceScale;
+
+layout(location = 0) out vec3 outColor;
+layout(location = 1) out vec2 outTexCoord;
+layout(location = 2) flat out uint outMaterialIndex;
+
+// 프레임마다 한 번 쓰고 모든 그리기가 같은 dynamic offset으로 읽는다.
+layout(set = 1, binding = 0) uniform FrameConstants {
+    mat2 preRotation; // 화면 회전
+} frameConstants;
+
+#ifdef DRAW_DATA_UNIFORM_BUFFER
+// VK_DRAW_DATA_PATH_UNIFORM_BUFFER에서 사용하는 변형. 그리기마다 set 2의 dynamic offset을 바꿔서 읽는다.
+// C++의 VkDrawConstants와 같은 레이아웃이 되도록 std140에서 열마다 16바이트를 차지하는 mat2 대신 vec4를 사용한다.
+layout(set = 2, binding = 0) uniform DrawConstants {
+    vec4 transform;
+    uint materialIndex;
+    uint firstInstance;
+} drawConstants;
+
+mat2 drawTransform() {
+    return mat2(drawConstants.transform.xy, drawConstants.transform.zw);
+}
+#else
+layout(push_constant) uniform DrawConstants {
+    mat2 transform;     // 그리기마다 적용하는 변환
+    uint materialIndex; // bindless 배열에서 사용할 텍스처의 인덱스
+    uint firstInstance;
+} drawConstants;
+
+mat2 drawTransform() {
+    return drawConstants.transform;
+}
+#endif
+
+void main() {
+    vec3 position = inPosition * inInstanceScale + inInstanceOffset;
+    gl_Position = vec4(frameConstants.preRotation * (drawTransform() * position.xy), position.z, 1.0);
+    outColor = inColor;
+    // 메시의 [-0.5, 0.5] 범위를 텍스처 좌표로 사용한다.
+    outTexCoord = inPosition.xy + 0.5;
+    outMaterialIndex = drawConstants.materialIndex;
+}